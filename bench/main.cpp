@@ -1,7 +1,9 @@
 #include "bench.h"
+#include <algorithm>
 #include <cstdio>
 #include <hop/hop.h>
 #include <memory>
+#include <vector>
 
 using namespace hop;
 
@@ -209,10 +211,13 @@ template <typename T> static void bench_stress(const char * label) {
 			std::snprintf(name, sizeof(name), "N=%d linear", c.n);
 			bench::go(name, c.iters, [&] { sim->update(tr::from_milli(10)); });
 		}
-		// BVH broad-phase.
-		{
+		// BVH broad-phase: the refit BVH, the incremental dynamic tree, then the
+		// refit BVH with the per-tick pair pass.
+		for (int variant = 0; variant < 3; ++variant) {
 			auto sim = std::make_shared<simulator<T>>();
 			bvh_manager<T> mgr;
+			mgr.set_incremental_dynamic(variant == 1);
+			mgr.set_pair_pass(variant == 2);
 			sim->set_manager(&mgr);
 			setup_stress_scene(*sim, c.n);
 			// Register only the walls as static; dynamic spheres stay in the flat
@@ -222,7 +227,35 @@ template <typename T> static void bench_stress(const char * label) {
 			for (size_t i = 0; i < solids.size(); ++i)
 				mgr.add_solid(solids[i].get(), i < 6);
 			char name[64];
-			std::snprintf(name, sizeof(name), "N=%d bvh", c.n);
+			const char * suffix[] = { "", " incremental", " pairs" };
+			std::snprintf(name, sizeof(name), "N=%d bvh%s", c.n, suffix[variant]);
+			bench::go(name, c.iters, [&] { sim->update(tr::from_milli(10)); });
+		}
+		// Sweep and prune.
+		{
+			auto sim = std::make_shared<simulator<T>>();
+			sap_manager<T> mgr;
+			sim->set_manager(&mgr);
+			setup_stress_scene(*sim, c.n);
+			const auto & solids = sim->get_solids();
+			for (size_t i = 0; i < solids.size(); ++i)
+				mgr.add_solid(solids[i].get(), i < 6);
+			char name[64];
+			std::snprintf(name, sizeof(name), "N=%d sap", c.n);
+			bench::go(name, c.iters, [&] { sim->update(tr::from_milli(10)); });
+		}
+		// Hashed grid, one cell per sphere diameter.
+		{
+			auto sim = std::make_shared<simulator<T>>();
+			grid_manager<T> mgr;
+			mgr.set_cell_size(tr::from_milli(600));
+			sim->set_manager(&mgr);
+			setup_stress_scene(*sim, c.n);
+			const auto & solids = sim->get_solids();
+			for (size_t i = 0; i < solids.size(); ++i)
+				mgr.add_solid(solids[i].get(), i < 6);
+			char name[64];
+			std::snprintf(name, sizeof(name), "N=%d grid", c.n);
 			bench::go(name, c.iters, [&] { sim->update(tr::from_milli(10)); });
 		}
 	}
@@ -271,6 +304,349 @@ template <typename T> static void bench_compound_narrow(const char * label) {
 	}
 }
 
+// ----------------------------------------------------------------------------
+// Scenario 5: BVH builders.
+// A mixed-size world — 20x20 terrain slabs under thousands of small props and
+// a few mid-size crates — built by median split and by binned SAH. Reports the
+// node visits per query (counted by a mirror traversal of the flattened nodes)
+// and the query cost for both, plus the build itself, then the same queries
+// on the tree collapsed into a wide_bvh.
+// ----------------------------------------------------------------------------
+
+template <typename T> static void bench_bvh_build(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("[bvh_build %s]\n", label);
+
+	unsigned seed = 7;
+	auto rnd = [&](int lo, int hi) {
+		seed = seed * 1103515245u + 12345u;
+		return lo + static_cast<int>((seed >> 8) % static_cast<unsigned>(hi - lo));
+	};
+	auto cube = [](vec3<T> c, T h) { return aa_box<T>(vec3<T>(c.x - h, c.y - h, c.z - h), vec3<T>(c.x + h, c.y + h, c.z + h)); };
+	std::vector<std::pair<aa_box<T>, int>> entries;
+	for (int i = 0; i < 64; ++i) {
+		T x = tr::from_int(20 * (i % 8) - 80), y = tr::from_int(20 * (i / 8) - 80);
+		entries.push_back({ aa_box<T>(vec3<T>(x, y, -tr::two()), vec3<T>(x + tr::from_int(20), y + tr::from_int(20), T {})), i });
+	}
+	for (int i = 0; i < 4000; ++i) {
+		vec3<T> c(tr::from_milli(rnd(-80000, 80000)), tr::from_milli(rnd(-80000, 80000)), tr::from_milli(rnd(0, 3000)));
+		entries.push_back({ cube(c, tr::from_milli(rnd(100, 600))), 64 + i });
+	}
+	for (int i = 0; i < 200; ++i) {
+		vec3<T> c(tr::from_milli(rnd(-80000, 80000)), tr::from_milli(rnd(-80000, 80000)), tr::from_milli(rnd(1000, 4000)));
+		entries.push_back({ cube(c, tr::from_milli(rnd(1000, 4000))), 4064 + i });
+	}
+
+	std::vector<aa_box<T>> boxes;
+	std::vector<std::pair<vec3<T>, vec3<T>>> rays;
+	for (int q = 0; q < 1024; ++q) {
+		vec3<T> c(tr::from_milli(rnd(-80000, 80000)), tr::from_milli(rnd(-80000, 80000)), tr::from_milli(rnd(0, 3000)));
+		boxes.push_back(cube(c, tr::one()));
+		rays.push_back({ c, vec3<T>(tr::from_milli(rnd(-20000, 20000)), tr::from_milli(rnd(-20000, 20000)), -tr::from_int(4)) });
+	}
+
+	// Visits as query_aabb / query_ray make them (with no pruning callback).
+	auto f = [](T v) { return tr::to_float(v); };
+	auto aabb_visits = [&](const bvh<T, int> & tree, const aa_box<T> & q) {
+		const auto & nodes = tree.get_nodes();
+		long long visits = 0;
+		for (int i = 0; i < static_cast<int>(nodes.size());) {
+			const auto & n = nodes[i];
+			++visits;
+			i = !test_intersection(n.box, q) || n.is_leaf() ? n.escape : i + 1;
+		}
+		return visits;
+	};
+	auto ray_visits = [&](const bvh<T, int> & tree, const vec3<T> & o, const vec3<T> & d) {
+		const auto & nodes = tree.get_nodes();
+		long long visits = 0;
+		for (int i = 0; i < static_cast<int>(nodes.size());) {
+			const auto & n = nodes[i];
+			++visits;
+			float tmin = 0, tmax = 1;
+			bool hit = true;
+			for (int a = 0; a < 3 && hit; ++a) {
+				const float oa = f(o[a]), da = f(d[a]), lo = f(n.box.mins[a]), hi = f(n.box.maxs[a]);
+				if (da == 0) {
+					hit = oa >= lo && oa <= hi;
+				} else {
+					float t1 = (lo - oa) / da, t2 = (hi - oa) / da;
+					tmin = std::max(tmin, std::min(t1, t2));
+					tmax = std::min(tmax, std::max(t1, t2));
+				}
+			}
+			i = !hit || tmax < tmin || n.is_leaf() ? n.escape : i + 1;
+		}
+		return visits;
+	};
+
+	// A callback keeping the nearest hit, as a shot or a line of sight would:
+	// it lowers best_t to where the ray enters each item's box.
+	long long nearest_hits = 0;
+	auto nearest = [&](const vec3<T> & o, const vec3<T> & d) {
+		return [&entries, &nearest_hits, o, d](int item, T & best_t) {
+			++nearest_hits;
+			const aa_box<T> & b = entries[item].first;
+			T tmin {}, tmax = best_t;
+			for (int a = 0; a < 3; ++a) {
+				if (d[a] == T {}) {
+					if (o[a] < b.mins[a] || o[a] > b.maxs[a])
+						return;
+					continue;
+				}
+				const T inv = tr::one() / d[a];
+				const T t1 = (b.mins[a] - o[a]) * inv, t2 = (b.maxs[a] - o[a]) * inv;
+				tmin = tr::max_val(tmin, tr::min_val(t1, t2));
+				tmax = tr::min_val(tmax, tr::max_val(t1, t2));
+			}
+			if (tmax >= tmin && tmin < best_t)
+				best_t = tmin;
+		};
+	};
+
+	for (bvh_build method : { bvh_build::median, bvh_build::sah }) {
+		const char * mname = method == bvh_build::median ? "median" : "sah";
+		bvh<T, int> tree;
+		tree.set_build_method(method);
+		char name[64];
+		std::snprintf(name, sizeof(name), "%s build, %d items", mname, static_cast<int>(entries.size()));
+		bench::go(name, 50, [&] {
+			auto copy = entries;
+			tree.build(copy);
+		});
+
+		long long av = 0, rv = 0, hits = 0;
+		for (size_t q = 0; q < boxes.size(); ++q) {
+			av += aabb_visits(tree, boxes[q]);
+			rv += ray_visits(tree, rays[q].first, rays[q].second);
+			tree.query_aabb(boxes[q], [&](int) { ++hits; });
+		}
+		printf("  %-50s %10.1f nodes/aabb  %6.1f nodes/ray  %6.1f items/aabb\n", mname, double(av) / boxes.size(),
+		       double(rv) / rays.size(), double(hits) / boxes.size());
+
+		size_t q = 0;
+		long long sink = 0;
+		std::snprintf(name, sizeof(name), "%s query_aabb", mname);
+		bench::go(name, 100000, [&] {
+			tree.query_aabb(boxes[q++ & 1023], [&](int item) { sink += item; });
+		});
+		std::snprintf(name, sizeof(name), "%s query_ray", mname);
+		bench::go(name, 100000, [&] {
+			const auto & r = rays[q++ & 1023];
+			tree.query_ray(r.first, r.second, [&](int item, T &) { sink += item; });
+		});
+		std::snprintf(name, sizeof(name), "%s query_ray nearest", mname);
+		bench::go(name, 100000, [&] {
+			const auto & r = rays[q++ & 1023];
+			tree.query_ray(r.first, r.second, nearest(r.first, r.second));
+		});
+
+		// The same tree collapsed to 4-wide nodes.
+		wide_bvh<T, int> wide;
+		wide.build(tree);
+		std::snprintf(name, sizeof(name), "%s wide query_aabb", mname);
+		bench::go(name, 100000, [&] {
+			wide.query_aabb(boxes[q++ & 1023], [&](int item) { sink += item; });
+		});
+		std::snprintf(name, sizeof(name), "%s wide query_ray", mname);
+		bench::go(name, 100000, [&] {
+			const auto & r = rays[q++ & 1023];
+			wide.query_ray(r.first, r.second, [&](int item, T &) { sink += item; });
+		});
+		std::snprintf(name, sizeof(name), "%s wide query_ray nearest", mname);
+		bench::go(name, 100000, [&] {
+			const auto & r = rays[q++ & 1023];
+			wide.query_ray(r.first, r.second, nearest(r.first, r.second));
+		});
+		if (sink + nearest_hits == 42)
+			printf("\n");
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Scenario 6: dynamic broad-phase upkeep.
+// 10000 dynamic spheres on a plane, of which 5% move each tick — a large world
+// that is mostly at rest. Measures what bvh_manager spends keeping its dynamic
+// structure current per tick (pre_update plus the per-solid post_update the
+// simulator issues), for the refit BVH (refitting every leaf, or only the
+// moved ones, or rebuilding on a worker thread), the incremental dynamic tree,
+// sweep and prune and the hashed grid, and the cost of a tick that also spawns
+// and despawns a body.
+// ----------------------------------------------------------------------------
+
+template <typename T> static void bench_broadphase_upkeep(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("[broadphase_upkeep %s]\n", label);
+
+	const int n = 10000;
+	const T dt = tr::from_milli(16);
+	std::vector<std::shared_ptr<solid<T>>> solids;
+	for (int i = 0; i < n; ++i) {
+		auto s = std::make_shared<solid<T>>();
+		s->set_position({ tr::from_int(i % 100 * 2), tr::from_int(i / 100 * 2), T {} });
+		s->add_shape(std::make_shared<shape<T>>(sphere<T> { vec3<T> {}, tr::half() }));
+		solids.push_back(s);
+	}
+	auto spare = std::make_shared<solid<T>>();
+	spare->set_position({ -tr::from_int(4), -tr::from_int(4), T {} });
+	spare->add_shape(std::make_shared<shape<T>>(sphere<T> { vec3<T> {}, tr::half() }));
+
+	auto run = [&](auto & mgr, const char * mode) {
+		for (auto & s : solids) {
+			s->set_velocity(vec3<T> {});
+			mgr.add_solid(s.get(), false);
+		}
+		mgr.pre_update(dt);
+
+		// Every 20th body drifts along x at 1 m/s.
+		const vec3<T> v(tr::one(), T {}, T {});
+		int tick = 0;
+		auto step = [&] {
+			for (int i = tick % 20; i < n; i += 20) {
+				solid<T> * s = solids[i].get();
+				s->set_velocity(v);
+				s->set_position(s->get_position() + v * dt);
+			}
+			mgr.pre_update(dt);
+			for (int i = tick % 20; i < n; i += 20)
+				mgr.post_update(solids[i].get(), dt);
+			++tick;
+		};
+		char name[64];
+		std::snprintf(name, sizeof(name), "N=%d %s, 5%% moving", n, mode);
+		bench::go(name, 200, step);
+		std::snprintf(name, sizeof(name), "N=%d %s, 5%% moving + spawn", n, mode);
+		bench::go(name, 200, [&] {
+			mgr.add_solid(spare.get(), false);
+			step();
+			mgr.remove_solid(spare.get());
+		});
+	};
+	const char * modes[] = { "refit", "dirty refit", "async rebuild", "incremental" };
+	for (int mode = 0; mode < 4; ++mode) {
+		bvh_manager<T> mgr;
+		mgr.set_dirty_refit(mode == 1);
+		mgr.set_async_rebuild(mode == 2);
+		mgr.set_incremental_dynamic(mode == 3);
+		run(mgr, modes[mode]);
+	}
+	sap_manager<T> sap;
+	run(sap, "sap");
+	grid_manager<T> grid;
+	run(grid, "grid");
+}
+
+// ----------------------------------------------------------------------------
+// Scenario 7: batched segment traces.
+// 512 line-of-sight rays a tick, from four eyes to bodies around them, through
+// a field of 2500 bodies: one trace_segment call each, then one trace_segments
+// call for all of them, and as any-hit queries, without a manager and with
+// bvh_manager.
+// ----------------------------------------------------------------------------
+
+template <typename T> static void bench_trace_segments(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("[trace_segments %s]\n", label);
+
+	for (bool managed : { false, true }) {
+		auto sim = std::make_shared<simulator<T>>();
+		bvh_manager<T> mgr;
+		if (managed)
+			sim->set_manager(&mgr);
+		for (int i = 0; i < 2500; ++i) {
+			auto s = std::make_shared<solid<T>>();
+			s->set_position({ tr::from_int(i % 50 * 2), tr::from_int(i / 50 * 2), tr::half() });
+			if (i % 2)
+				s->add_shape(std::make_shared<shape<T>>(sphere<T> { vec3<T> {}, tr::half() }));
+			else
+				s->add_shape(std::make_shared<shape<T>>(aa_box<T> { -tr::half(), -tr::half(), -tr::half(), tr::half(), tr::half(), tr::half() }));
+			s->set_infinite_mass();
+			sim->add_solid(s);
+			mgr.add_solid(s.get(), i % 4 == 0);
+		}
+		sim->update(tr::from_milli(16));
+
+		std::vector<segment<T>> segs(512);
+		for (int i = 0; i < 512; ++i) {
+			const int eye = i % 4;
+			const vec3<T> from(tr::from_int(20 + 50 * (eye % 2)), tr::from_int(20 + 50 * (eye / 2)), tr::from_int(2));
+			const vec3<T> to(from.x + tr::from_int((i * 7) % 17 - 8), from.y + tr::from_int((i * 13) % 17 - 8), tr::half());
+			segs[i].set_start_end(from, to);
+		}
+		std::vector<collision<T>> results(segs.size());
+		int hits = 0;
+		char name[64];
+		std::snprintf(name, sizeof(name), "512 rays %s, one at a time", managed ? "bvh" : "linear");
+		bench::go(name, managed ? 2000 : 20, [&] {
+			for (size_t i = 0; i < segs.size(); ++i)
+				sim->trace_segment(results[i], segs[i]);
+			hits += results[0].time < tr::one();
+		});
+		std::snprintf(name, sizeof(name), "512 rays %s, trace_segments", managed ? "bvh" : "linear");
+		bench::go(name, managed ? 2000 : 20, [&] {
+			sim->trace_segments(results.data(), segs.data(), static_cast<int>(segs.size()));
+			hits += results[0].time < tr::one();
+		});
+		std::snprintf(name, sizeof(name), "512 rays %s, trace_segment_any", managed ? "bvh" : "linear");
+		bench::go(name, managed ? 2000 : 20, [&] {
+			for (size_t i = 0; i < segs.size(); ++i)
+				hits += sim->trace_segment_any(segs[i]);
+		});
+		if (hits < 0)
+			printf("%d\n", hits);
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Scenario 8: layered queries.
+// 10000 bodies on a 100x100 grid, mostly debris (scope 4) with characters'
+// hitboxes (scope 2) gathered in a few blocks and some triggers (scope 8)
+// spread through. Projectile-sized boxes that only want hitboxes query
+// bvh_manager with and without scope pruning; half the bodies are static.
+// ----------------------------------------------------------------------------
+
+template <typename T> static void bench_layered_queries(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("[layered_queries %s]\n", label);
+
+	std::vector<std::shared_ptr<solid<T>>> solids;
+	bvh_manager<T> mgr;
+	for (int i = 0; i < 10000; ++i) {
+		const int x = i % 100, y = i / 100;
+		auto s = std::make_shared<solid<T>>();
+		s->set_position({ tr::from_int(x * 2), tr::from_int(y * 2), tr::half() });
+		s->add_shape(std::make_shared<shape<T>>(aa_box<T> { -tr::half(), -tr::half(), -tr::half(), tr::half(), tr::half(), tr::half() }));
+		const bool hitbox = (x / 10 + y / 10 * 3) % 7 == 0;
+		s->set_collision_scope(hitbox ? 2 : i % 53 == 0 ? 8 : 4);
+		mgr.add_solid(s.get(), i % 2 == 0);
+		solids.push_back(s);
+	}
+
+	std::vector<aa_box<T>> boxes;
+	for (int q = 0; q < 1024; ++q) {
+		const T x = tr::from_int((q * 37) % 200), y = tr::from_int((q * 91) % 200);
+		boxes.push_back(aa_box<T>(vec3<T>(x - tr::from_int(3), y - tr::from_int(3), T {}), vec3<T>(x + tr::from_int(3), y + tr::from_int(3), tr::one())));
+	}
+	for (bool pruning : { false, true }) {
+		mgr.set_scope_pruning(pruning);
+		mgr.pre_update(tr::from_milli(16));
+		solid<T> * found[256];
+		size_t q = 0;
+		long long sink = 0;
+		char name[64];
+		std::snprintf(name, sizeof(name), "hitbox query, %s", pruning ? "scope pruning" : "leaf filter");
+		bench::go(name, 200000, [&] {
+			sink += mgr.find_solids_in_aa_box(boxes[q++ & 1023], found, 256, 2);
+		});
+		std::snprintf(name, sizeof(name), "unfiltered query, %s", pruning ? "scope pruning" : "leaf filter");
+		bench::go(name, 200000, [&] {
+			sink += mgr.find_solids_in_aa_box(boxes[q++ & 1023], found, 256);
+		});
+		if (sink < 0)
+			printf("%lld\n", sink);
+	}
+}
+
 // ----------------------------------------------------------------------------
 
 int main() {
@@ -293,6 +669,18 @@ int main() {
 	bench_compound_narrow<float>("float");
 	bench_compound_narrow<fixed16>("fixed16");
 
+	bench_bvh_build<float>("float");
+	bench_bvh_build<fixed16>("fixed16");
+
+	bench_broadphase_upkeep<float>("float");
+	bench_broadphase_upkeep<fixed16>("fixed16");
+
+	bench_trace_segments<float>("float");
+	bench_trace_segments<fixed16>("fixed16");
+
+	bench_layered_queries<float>("float");
+	bench_layered_queries<fixed16>("fixed16");
+
 	printf("\ndone\n");
 	return 0;
 }
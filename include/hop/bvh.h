@@ -5,11 +5,117 @@
 #include <hop/scalar_traits.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace hop {
 
+// How bvh::build partitions each node's items.
+//   median: sort by centroid along the node's longest axis and split the count
+//           in half. Balanced, and the original builder.
+//   sah:    binned surface-area heuristic. Each node's centroids are binned
+//           along every axis and the split minimizing
+//           count_left * area_left + count_right * area_right is taken, so a
+//           few huge boxes (terrain slabs) get their own subtrees instead of
+//           bloating the bounds over a cluster of small props. O(n log n)
+//           build; fewer false positives for query_aabb and fewer node visits
+//           for query_ray in mixed-size worlds.
+enum class bvh_build { median, sah };
+
+// Hand item to a query callback. A callback may return bool to end the walk
+// (false stops it) or return nothing to see every item; this reports whether
+// to go on.
+template <typename Callback, typename Item> inline bool visit_item(Callback & cb, const Item & item) {
+	if constexpr (std::is_same<decltype(cb(item)), bool>::value) {
+		return cb(item);
+	} else {
+		cb(item);
+		return true;
+	}
+}
+
+// Cost arithmetic for the tree builders: the SAH split and its centroid bins,
+// and the surface-area comparisons the other trees make. Only the ordering of
+// costs matters, and it decides the tree's shape and so the order queries
+// report items in. For float trees it is float. For the fixed-point types it is
+// integer arithmetic on the raw values, so a fixed-point tree comes out the same
+// on every platform and compiler (float rounding or FMA contraction could tip a
+// near-tie). Fixed-point extents are shifted down by a per-call `shift`, taken
+// from the largest box the call compares, so that an area times an item count
+// stays inside int64.
+template <typename T, bool Fixed = is_fixed_scalar_v<T>> struct bvh_cost {
+	using tr = scalar_traits<T>;
+	using type = float;
+	using key = float;
+
+	static int shift_for(const aa_box<T> &, int) { return 0; }
+	static type area(const aa_box<T> & b, int) {
+		const float dx = tr::to_float(b.maxs.x - b.mins.x);
+		const float dy = tr::to_float(b.maxs.y - b.mins.y);
+		const float dz = tr::to_float(b.maxs.z - b.mins.z);
+		return dx * dy + dy * dz + dz * dx;
+	}
+	static type half_perimeter(const aa_box<T> & b) {
+		return tr::to_float(b.maxs.x - b.mins.x) + tr::to_float(b.maxs.y - b.mins.y) + tr::to_float(b.maxs.z - b.mins.z);
+	}
+	// A box's centroid along axis, doubled (mins + maxs), and the bin of
+	// `bins` over [lo, hi] it falls in.
+	static key centroid(const aa_box<T> & b, int axis) { return tr::to_float(b.mins[axis] + b.maxs[axis]); }
+	static int bin(key c, key lo, key hi, int bins) {
+		const int k = static_cast<int>((c - lo) * (bins / (hi - lo)));
+		return k < bins - 1 ? k : bins - 1;
+	}
+};
+
+template <typename T> struct bvh_cost<T, true> {
+	using type = std::int64_t;
+	using key = std::int64_t;
+
+	// hi - lo on the raw values, as unsigned so that no extent overflows.
+	static std::uint64_t extent(T lo, T hi) { return static_cast<std::uint64_t>(hi.raw) - static_cast<std::uint64_t>(lo.raw); }
+	static int bit_width(std::uint64_t v) {
+		int n = 0;
+		for (; v; v >>= 1)
+			++n;
+		return n;
+	}
+	// Bits to drop from each extent of boxes within bound so that count of
+	// their areas sum below 2^62: 3 * count * (2^keep)^2 stays under it.
+	static int shift_for(const aa_box<T> & bound, int count) {
+		std::uint64_t e = extent(bound.mins.x, bound.maxs.x);
+		e = std::max(e, extent(bound.mins.y, bound.maxs.y));
+		e = std::max(e, extent(bound.mins.z, bound.maxs.z));
+		const int keep = (60 - bit_width(static_cast<std::uint64_t>(count))) / 2;
+		const int bits = bit_width(e);
+		return bits > keep ? bits - keep : 0;
+	}
+	static type area(const aa_box<T> & b, int shift) {
+		const type dx = static_cast<type>(extent(b.mins.x, b.maxs.x) >> shift);
+		const type dy = static_cast<type>(extent(b.mins.y, b.maxs.y) >> shift);
+		const type dz = static_cast<type>(extent(b.mins.z, b.maxs.z) >> shift);
+		return dx * dy + dy * dz + dz * dx;
+	}
+	// Each extent loses its low two bits, so that the sum of three fits.
+	static type half_perimeter(const aa_box<T> & b) {
+		return static_cast<type>((extent(b.mins.x, b.maxs.x) >> 2) + (extent(b.mins.y, b.maxs.y) >> 2) +
+		                         (extent(b.mins.z, b.maxs.z) >> 2));
+	}
+	static key centroid(const aa_box<T> & b, int axis) {
+		return static_cast<key>(b.mins[axis].raw) + static_cast<key>(b.maxs[axis].raw);
+	}
+	static int bin(key c, key lo, key hi, int bins) {
+		std::uint64_t offset = static_cast<std::uint64_t>(c) - static_cast<std::uint64_t>(lo);
+		std::uint64_t range = static_cast<std::uint64_t>(hi) - static_cast<std::uint64_t>(lo);
+		const int shift = std::max(0, bit_width(range) + bit_width(static_cast<std::uint64_t>(bins)) - 63);
+		offset >>= shift;
+		range >>= shift;
+		const int k = range ? static_cast<int>(offset * static_cast<std::uint64_t>(bins) / range) : 0;
+		return k < bins - 1 ? k : bins - 1;
+	}
+};
+
 // A BVH (Bounding Volume Hierarchy) for spatial acceleration of AABB queries.
 //
 // Template parameters:
@@ -20,8 +126,19 @@ namespace hop {
 //   bvh<float, int> tree;
 //   std::vector<std::pair<aa_box<float>, int>> entries = ...;
 //   tree.build(entries);
-//   tree.query_aabb(box, [](int item) { ... });
+//   tree.query_aabb(box, [](int item) { ... });  // or return false to stop
 //   tree.query_ray(origin, direction, [](int item, float &best_t) { ... });
+//   tree.query_self_pairs([](int a, int b) { ... });
+//
+// set_build_method selects the builder (see bvh_build) for the next build().
+//
+// Layout: the nodes are one flat array in depth-first order, so an internal
+// node's left child is the node after it, and each node stores only its box,
+// the index just past its subtree (where a query goes when the box misses)
+// and, for a leaf, an index into a separate items array. That is 32 bytes a
+// node for float and fixed16 whatever Item is, and queries walk the array
+// forward with no stack: a hit steps to the next node, a miss or a leaf jumps
+// to the escape index.
 
 template <typename T, typename Item> class bvh {
 public:
@@ -29,26 +146,111 @@ public:
 
 	struct node {
 		aa_box<T> box;
-		int left = -1;
-		int right = -1;
-		Item item {};
-		bool is_leaf() const { return left == -1 && right == -1; }
+		int escape = 0;  // first node past this subtree
+		int leaf = -1;   // index into the items array; -1 for internal nodes
+		bool is_leaf() const { return leaf >= 0; }
 	};
+	static_assert(sizeof(T) != 4 || sizeof(node) == 32, "bvh node should stay 32 bytes");
+
+	// SAH bins per axis. More bins find better splits at a linear cost per node.
+	static constexpr int sah_bins = 16;
+	// Below this many items a node is split by median, where SAH has little to
+	// choose between; past this depth too, which bounds the tree's depth (and so
+	// the recursion of the build and of the pair queries) however unbalanced the
+	// SAH splits run.
+	static constexpr int sah_min_items = 4;
+	static constexpr int sah_max_depth = 48;
+
+	void set_build_method(bvh_build m) { build_method_ = m; }
+	bvh_build get_build_method() const { return build_method_; }
 
 	// Build from a list of (AABB, item) pairs. The input vector may be reordered.
 	void build(std::vector<std::pair<aa_box<T>, Item>> & entries) {
 		nodes_.clear();
+		items_.clear();
+		masks_.clear();
+		parents_.clear();
+		leaf_nodes_.clear();
 		if (entries.empty())
 			return;
 		nodes_.reserve(entries.size() * 2);
-		build_recursive(entries, 0, static_cast<int>(entries.size()));
+		items_.reserve(entries.size());
+		build_recursive(entries, 0, static_cast<int>(entries.size()), 0);
 	}
 
-	// Find all items whose AABBs overlap the given box.
+	// Find all items whose AABBs overlap the given box. A callback returning
+	// false ends the walk there (see visit_item): a caller whose buffer is full,
+	// or that only needs one item, stops paying for the rest of the tree.
 	template <typename Callback> void query_aabb(const aa_box<T> & box, Callback && cb) const {
+		const int end = static_cast<int>(nodes_.size());
+		for (int idx = 0; idx < end;) {
+			const node & n = nodes_[idx];
+			if (!test_intersection(n.box, box)) {
+				idx = n.escape;
+			} else if (n.is_leaf()) {
+				if (!visit_item(cb, items_[n.leaf]))
+					return;
+				idx = n.escape;
+			} else {
+				++idx;
+			}
+		}
+	}
+
+	// Give each node a bit mask: get_mask(item) at a leaf, the OR of its
+	// children's above. query_aabb with a mask then skips every subtree none of
+	// whose items shares a bit with it. The masks live beside the nodes, so the
+	// walks that don't use them read no more memory; build() drops them, and
+	// refit(get_box, get_mask) keeps them current.
+	template <typename GetMask> void set_masks(GetMask && get_mask) {
+		masks_.resize(nodes_.size());
+		for (int idx = static_cast<int>(nodes_.size()) - 1; idx >= 0; --idx) {
+			const node & n = nodes_[idx];
+			masks_[idx] = n.is_leaf() ? get_mask(items_[n.leaf]) : masks_[idx + 1] | masks_[right_child(idx)];
+		}
+	}
+	void clear_masks() { masks_.clear(); }
+	bool has_masks() const { return !nodes_.empty() && masks_.size() == nodes_.size(); }
+
+	// query_aabb reporting only items whose mask (see set_masks) shares a bit
+	// with mask, skipping the subtrees that have none. Without masks it reports
+	// every overlapping item, as query_aabb(box, cb) does; the caller filters.
+	template <typename Callback> void query_aabb(const aa_box<T> & box, int mask, Callback && cb) const {
+		if (!has_masks()) {
+			query_aabb(box, cb);
+			return;
+		}
+		const int end = static_cast<int>(nodes_.size());
+		for (int idx = 0; idx < end;) {
+			const node & n = nodes_[idx];
+			if ((masks_[idx] & mask) == 0 || !test_intersection(n.box, box)) {
+				idx = n.escape;
+			} else if (n.is_leaf()) {
+				if (!visit_item(cb, items_[n.leaf]))
+					return;
+				idx = n.escape;
+			} else {
+				++idx;
+			}
+		}
+	}
+
+	// Find all pairs of items, one from this tree and one from other, whose
+	// AABBs overlap once grown by pad: one simultaneous descent of both trees,
+	// so each subtree pair is tested once rather than once per item on the
+	// other side.
+	template <typename Callback> void query_pairs(const bvh & other, Callback && cb, T pad = T {}) const {
+		if (nodes_.empty() || other.nodes_.empty())
+			return;
+		query_pairs_recursive(0, other, 0, pad, cb);
+	}
+
+	// Find all pairs of distinct items of this tree whose AABBs overlap once
+	// grown by pad. Each pair is reported once, in no particular (a, b) order.
+	template <typename Callback> void query_self_pairs(Callback && cb, T pad = T {}) const {
 		if (nodes_.empty())
 			return;
-		query_aabb_recursive(0, box, cb);
+		query_self_pairs_recursive(0, pad, cb);
 	}
 
 	// Update node AABBs from the items at the leaves without changing tree
@@ -57,48 +259,192 @@ public:
 	// when items move but the partitioning doesn't need to change. Topology
 	// quality degrades over time as items drift away from their original
 	// clusters — call build() periodically to recover.
+	// Children follow their parent in the array, so one backward pass sees
+	// every child before its parent.
 	template <typename GetBox> void refit(GetBox && get_box) {
-		if (nodes_.empty())
-			return;
-		refit_recursive(0, get_box);
+		for (int idx = static_cast<int>(nodes_.size()) - 1; idx >= 0; --idx) {
+			node & n = nodes_[idx];
+			if (n.is_leaf()) {
+				n.box = get_box(items_[n.leaf]);
+			} else {
+				n.box = nodes_[idx + 1].box;
+				n.box.merge(nodes_[right_child(idx)].box);
+			}
+		}
+	}
+
+	// refit that recomputes the masks (see set_masks) in the same pass, for
+	// items whose mask can change as well as their box.
+	template <typename GetBox, typename GetMask> void refit(GetBox && get_box, GetMask && get_mask) {
+		masks_.resize(nodes_.size());
+		for (int idx = static_cast<int>(nodes_.size()) - 1; idx >= 0; --idx) {
+			node & n = nodes_[idx];
+			if (n.is_leaf()) {
+				n.box = get_box(items_[n.leaf]);
+				masks_[idx] = get_mask(items_[n.leaf]);
+			} else {
+				n.box = nodes_[idx + 1].box;
+				n.box.merge(nodes_[right_child(idx)].box);
+				masks_[idx] = masks_[idx + 1] | masks_[right_child(idx)];
+			}
+		}
+	}
+
+	// Refit only the given leaves — indices into get_items() — walking parent
+	// links up from each and stopping where a parent's box comes out unchanged,
+	// so a tick where a few items moved costs O(moved * depth) rather than
+	// O(n). Every leaf whose box changed since the last refit must be listed
+	// (listing one twice is harmless). The parent links are built on first use
+	// after each build().
+	template <typename GetBox> void refit_leaves(const int * leaves, int count, GetBox && get_box) {
+		refit_leaves_impl<false>(leaves, count, get_box, [](const Item &) { return 0; });
+	}
+
+	// refit_leaves that also updates the listed leaves' masks (see set_masks).
+	template <typename GetBox, typename GetMask>
+	void refit_leaves(const int * leaves, int count, GetBox && get_box, GetMask && get_mask) {
+		if (!has_masks())
+			set_masks(get_mask);
+		refit_leaves_impl<true>(leaves, count, get_box, get_mask);
 	}
 
 	// Find items along a ray (segment). The callback receives (item, best_t)
 	// and should update best_t if it finds a closer hit, enabling early pruning.
 	template <typename Callback>
 	void query_ray(const vec3<T> & origin, const vec3<T> & direction, Callback && cb) const {
-		if (nodes_.empty())
-			return;
 		T best_t = tr::one();
-		query_ray_recursive(0, origin, direction, best_t, cb);
+		const int end = static_cast<int>(nodes_.size());
+		for (int idx = 0; idx < end;) {
+			const node & n = nodes_[idx];
+			if (!ray_hits_aabb(origin, direction, n.box, best_t)) {
+				idx = n.escape;
+			} else if (n.is_leaf()) {
+				cb(items_[n.leaf], best_t);
+				idx = n.escape;
+			} else {
+				++idx;
+			}
+		}
 	}
 
 	// Append leaf items to `out` in spatial-cluster order. build_recursive emits
-	// nodes pre-order DFS, so a linear scan of nodes_ yields leaves in the same
-	// left-to-right order the median split produced — adjacent leaves are
-	// spatially adjacent. Useful for driving update loops in cache-friendly order.
+	// leaves in the same left-to-right order the splits produced, so adjacent
+	// items are spatially adjacent. Useful for driving update loops in
+	// cache-friendly order.
 	template <typename Out> void collect_leaves(Out & out) const {
-		for (const auto & n : nodes_)
-			if (n.is_leaf())
-				out.push_back(n.item);
+		for (const auto & item : items_)
+			out.push_back(item);
 	}
 
+	// The flattened tree, for tools that walk it (see the layout note above).
+	// A leaf's item is get_items()[node.leaf].
 	const std::vector<node> & get_nodes() const { return nodes_; }
+	const std::vector<Item> & get_items() const { return items_; }
+	int right_child(int idx) const { return nodes_[idx + 1].escape; }
 	bool empty() const { return nodes_.empty(); }
 	int size() const { return static_cast<int>(nodes_.size()); }
 
+	// Ray-AABB slab test. Returns true if ray hits box before best_t. Public so
+	// the other trees (dynamic_tree) prune rays the same way.
+	// We use a dedicated slab test rather than hop's find_intersection(segment, aa_box)
+	// because we only need a boolean (no hit point/normal), making this faster for
+	// BVH traversal where we test many nodes but only care about pruning.
+	//
+	// Zero direction components are handled without a sentinel reciprocal: a
+	// "big" 1/d would overflow the fixed16 raw-multiply for modest distances.
+	// Instead, axes with zero direction contribute a pure containment check.
+	static bool ray_hits_aabb(const vec3<T> & origin, const vec3<T> & direction, const aa_box<T> & box, T best_t) {
+		T zero_val {};
+		T tmin = zero_val;
+		T tmax = best_t;
+
+		if (direction.x != zero_val) {
+			T inv = tr::one() / direction.x;
+			T t1 = (box.mins.x - origin.x) * inv;
+			T t2 = (box.maxs.x - origin.x) * inv;
+			tmin = tr::max_val(tmin, tr::min_val(t1, t2));
+			tmax = tr::min_val(tmax, tr::max_val(t1, t2));
+		} else if (origin.x < box.mins.x || origin.x > box.maxs.x) {
+			return false;
+		}
+
+		if (direction.y != zero_val) {
+			T inv = tr::one() / direction.y;
+			T t1 = (box.mins.y - origin.y) * inv;
+			T t2 = (box.maxs.y - origin.y) * inv;
+			tmin = tr::max_val(tmin, tr::min_val(t1, t2));
+			tmax = tr::min_val(tmax, tr::max_val(t1, t2));
+		} else if (origin.y < box.mins.y || origin.y > box.maxs.y) {
+			return false;
+		}
+
+		if (direction.z != zero_val) {
+			T inv = tr::one() / direction.z;
+			T t1 = (box.mins.z - origin.z) * inv;
+			T t2 = (box.maxs.z - origin.z) * inv;
+			tmin = tr::max_val(tmin, tr::min_val(t1, t2));
+			tmax = tr::min_val(tmax, tr::max_val(t1, t2));
+		} else if (origin.z < box.mins.z || origin.z > box.maxs.z) {
+			return false;
+		}
+
+		return tmax >= tmin && tmin < best_t;
+	}
+
 private:
 	std::vector<node> nodes_;
+	std::vector<Item> items_;  // in leaf order
+	std::vector<int> masks_;   // per node, when set_masks was called; else empty
+	std::vector<int> parents_;     // per node, -1 at the root; built by refit_leaves
+	std::vector<int> leaf_nodes_;  // node of each item, likewise
+	bvh_build build_method_ = bvh_build::median;
+
+	template <bool masked, typename GetBox, typename GetMask>
+	void refit_leaves_impl(const int * leaves, int count, GetBox & get_box, GetMask && get_mask) {
+		if (parents_.size() != nodes_.size()) {
+			parents_.assign(nodes_.size(), -1);
+			leaf_nodes_.resize(items_.size());
+			for (int idx = 0; idx < static_cast<int>(nodes_.size()); ++idx) {
+				if (nodes_[idx].is_leaf()) {
+					leaf_nodes_[nodes_[idx].leaf] = idx;
+				} else {
+					parents_[idx + 1] = idx;
+					parents_[right_child(idx)] = idx;
+				}
+			}
+		}
+		for (int i = 0; i < count; ++i) {
+			const int leaf = leaves[i];
+			const int idx = leaf_nodes_[leaf];
+			nodes_[idx].box = get_box(items_[leaf]);
+			if constexpr (masked)
+				masks_[idx] = get_mask(items_[leaf]);
+			for (int p = parents_[idx]; p >= 0; p = parents_[p]) {
+				aa_box<T> box = nodes_[p + 1].box;
+				box.merge(nodes_[right_child(p)].box);
+				if constexpr (masked) {
+					const int mask = masks_[p + 1] | masks_[right_child(p)];
+					if (box == nodes_[p].box && mask == masks_[p])
+						break;
+					masks_[p] = mask;
+				} else if (box == nodes_[p].box) {
+					break;
+				}
+				nodes_[p].box = box;
+			}
+		}
+	}
 
-	int build_recursive(std::vector<std::pair<aa_box<T>, Item>> & entries, int start, int end) {
+	void build_recursive(std::vector<std::pair<aa_box<T>, Item>> & entries, int start, int end, int depth) {
 		int idx = static_cast<int>(nodes_.size());
 		nodes_.push_back({});
 
 		if (end - start == 1) {
-			// Leaf node — nodes_ won't reallocate here since we reserved 2x
 			nodes_[idx].box = entries[start].first;
-			nodes_[idx].item = entries[start].second;
-			return idx;
+			nodes_[idx].leaf = static_cast<int>(items_.size());
+			nodes_[idx].escape = idx + 1;
+			items_.push_back(entries[start].second);
+			return;
 		}
 
 		// Compute encompassing AABB
@@ -108,6 +454,20 @@ private:
 		}
 		nodes_[idx].box = total;
 
+		int mid = -1;
+		if (build_method_ == bvh_build::sah && end - start >= sah_min_items && depth < sah_max_depth)
+			mid = partition_sah(entries, start, end, total);
+		if (mid < 0)
+			mid = partition_median(entries, start, end, total);
+
+		// Note: recursive calls may grow nodes_, but we access nodes_[idx]
+		// by integer index after, so reallocation is safe.
+		build_recursive(entries, start, mid, depth + 1);
+		build_recursive(entries, mid, end, depth + 1);
+		nodes_[idx].escape = static_cast<int>(nodes_.size());
+	}
+
+	int partition_median(std::vector<std::pair<aa_box<T>, Item>> & entries, int start, int end, const aa_box<T> & total) {
 		// Split axis: longest extent
 		T dx = total.maxs.x - total.mins.x;
 		T dy = total.maxs.y - total.mins.y;
@@ -129,116 +489,124 @@ private:
 			          return ca < cb;
 		          });
 
-		int mid = (start + end) / 2;
-
-		// Note: recursive calls may grow nodes_, but we access nodes_[idx]
-		// by integer index after, so reallocation is safe.
-		int left = build_recursive(entries, start, mid);
-		int right = build_recursive(entries, mid, end);
-		nodes_[idx].left = left;
-		nodes_[idx].right = right;
-
-		return idx;
+		return (start + end) / 2;
 	}
 
-	template <typename GetBox> void refit_recursive(int idx, GetBox && get_box) {
-		auto & n = nodes_[idx];
-		if (n.is_leaf()) {
-			n.box = get_box(n.item);
-			return;
+	// Binned SAH split of [start, end). Returns the partition point, or -1 when
+	// no split separates anything (every centroid in one bin on every axis).
+	// Costs and bins come from bvh_cost: float for float trees, integer for the
+	// fixed-point ones (a fixed-point surface area overflows T for world-sized
+	// boxes), so the tree is reproducible either way.
+	int partition_sah(std::vector<std::pair<aa_box<T>, Item>> & entries, int start, int end, const aa_box<T> & total) {
+		using cost = bvh_cost<T>;
+		const int shift = cost::shift_for(total, end - start);
+		auto area = [shift](const aa_box<T> & b) { return cost::area(b, shift); };
+		// Centroids are kept doubled (mins + maxs), as the median split sorts them.
+		typename cost::key cmin[3], cmax[3];
+		for (int axis = 0; axis < 3; ++axis) {
+			cmin[axis] = cmax[axis] = cost::centroid(entries[start].first, axis);
+			for (int i = start + 1; i < end; ++i) {
+				const typename cost::key c = cost::centroid(entries[i].first, axis);
+				cmin[axis] = c < cmin[axis] ? c : cmin[axis];
+				cmax[axis] = c > cmax[axis] ? c : cmax[axis];
+			}
 		}
-		if (n.left >= 0)
-			refit_recursive(n.left, get_box);
-		if (n.right >= 0)
-			refit_recursive(n.right, get_box);
-		// Internal nodes always have both children in build_recursive, but be
-		// defensive in case a future builder produces a stub node.
-		if (n.left >= 0) {
-			n.box = nodes_[n.left].box;
-			if (n.right >= 0)
-				n.box.merge(nodes_[n.right].box);
-		} else if (n.right >= 0) {
-			n.box = nodes_[n.right].box;
+		auto bin_of = [&](const aa_box<T> & b, int axis) {
+			return cost::bin(cost::centroid(b, axis), cmin[axis], cmax[axis], sah_bins);
+		};
+
+		struct bin {
+			aa_box<T> box;
+			int count = 0;
+		};
+		int best_axis = -1;
+		int best_split = 0;  // bins [0, best_split) go left
+		typename cost::type best_cost {};
+		for (int axis = 0; axis < 3; ++axis) {
+			if (!(cmax[axis] > cmin[axis]))
+				continue;
+			bin bins[sah_bins];
+			for (int i = start; i < end; ++i) {
+				bin & b = bins[bin_of(entries[i].first, axis)];
+				if (b.count++ == 0)
+					b.box = entries[i].first;
+				else
+					b.box.merge(entries[i].first);
+			}
+			// Right-to-left sweep for the suffix areas, then left-to-right for the
+			// costs.
+			typename cost::type right_area[sah_bins];
+			int right_count[sah_bins];
+			aa_box<T> acc;
+			int n = 0;
+			for (int k = sah_bins - 1; k > 0; --k) {
+				if (bins[k].count > 0) {
+					if (n == 0)
+						acc = bins[k].box;
+					else
+						acc.merge(bins[k].box);
+				}
+				n += bins[k].count;
+				right_count[k] = n;
+				right_area[k] = n > 0 ? area(acc) : typename cost::type {};
+			}
+			n = 0;
+			for (int k = 0; k < sah_bins - 1; ++k) {
+				if (bins[k].count > 0) {
+					if (n == 0)
+						acc = bins[k].box;
+					else
+						acc.merge(bins[k].box);
+				}
+				n += bins[k].count;
+				if (n == 0 || right_count[k + 1] == 0)
+					continue;
+				const typename cost::type split_cost = n * area(acc) + right_count[k + 1] * right_area[k + 1];
+				if (best_axis < 0 || split_cost < best_cost) {
+					best_axis = axis;
+					best_split = k + 1;
+					best_cost = split_cost;
+				}
+			}
 		}
+		if (best_axis < 0)
+			return -1;
+		auto it = std::partition(entries.begin() + start, entries.begin() + end,
+		                         [&](const std::pair<aa_box<T>, Item> & e) { return bin_of(e.first, best_axis) < best_split; });
+		return static_cast<int>(it - entries.begin());
 	}
 
-	template <typename Callback> void query_aabb_recursive(int idx, const aa_box<T> & box, Callback && cb) const {
-		const auto & n = nodes_[idx];
-		if (!test_intersection(n.box, box))
+	// Descend the larger of the two nodes (by half-perimeter, from bvh_cost as
+	// partition_sah's costs are), so the pair's boxes stay of similar size.
+	// Two subtrees are walked at once here, so this one recurses.
+	template <typename Callback>
+	void query_pairs_recursive(int a, const bvh & other, int b, T pad, Callback && cb) const {
+		const auto & na = nodes_[a];
+		const auto & nb = other.nodes_[b];
+		if (na.box.mins.x - pad > nb.box.maxs.x || nb.box.mins.x > na.box.maxs.x + pad ||
+		    na.box.mins.y - pad > nb.box.maxs.y || nb.box.mins.y > na.box.maxs.y + pad ||
+		    na.box.mins.z - pad > nb.box.maxs.z || nb.box.mins.z > na.box.maxs.z + pad)
 			return;
-
-		if (n.is_leaf()) {
-			cb(n.item);
+		if (na.is_leaf() && nb.is_leaf()) {
+			cb(items_[na.leaf], other.items_[nb.leaf]);
 			return;
 		}
-		if (n.left >= 0)
-			query_aabb_recursive(n.left, box, cb);
-		if (n.right >= 0)
-			query_aabb_recursive(n.right, box, cb);
-	}
-
-	// Ray-AABB slab test. Returns true if ray hits box before best_t.
-	// We use a dedicated slab test rather than hop's find_intersection(segment, aa_box)
-	// because we only need a boolean (no hit point/normal), making this faster for
-	// BVH traversal where we test many nodes but only care about pruning.
-	//
-	// Zero direction components are handled without a sentinel reciprocal: a
-	// "big" 1/d would overflow the fixed16 raw-multiply for modest distances.
-	// Instead, axes with zero direction contribute a pure containment check.
-	static bool ray_hits_aabb(const vec3<T> & origin, const vec3<T> & direction, const aa_box<T> & box, T best_t) {
-		T zero_val {};
-		T tmin = zero_val;
-		T tmax = best_t;
-
-		if (direction.x != zero_val) {
-			T inv = tr::one() / direction.x;
-			T t1 = (box.mins.x - origin.x) * inv;
-			T t2 = (box.maxs.x - origin.x) * inv;
-			tmin = tr::max_val(tmin, tr::min_val(t1, t2));
-			tmax = tr::min_val(tmax, tr::max_val(t1, t2));
-		} else if (origin.x < box.mins.x || origin.x > box.maxs.x) {
-			return false;
-		}
-
-		if (direction.y != zero_val) {
-			T inv = tr::one() / direction.y;
-			T t1 = (box.mins.y - origin.y) * inv;
-			T t2 = (box.maxs.y - origin.y) * inv;
-			tmin = tr::max_val(tmin, tr::min_val(t1, t2));
-			tmax = tr::min_val(tmax, tr::max_val(t1, t2));
-		} else if (origin.y < box.mins.y || origin.y > box.maxs.y) {
-			return false;
+		if (nb.is_leaf() || (!na.is_leaf() && bvh_cost<T>::half_perimeter(na.box) >= bvh_cost<T>::half_perimeter(nb.box))) {
+			query_pairs_recursive(a + 1, other, b, pad, cb);
+			query_pairs_recursive(right_child(a), other, b, pad, cb);
+		} else {
+			query_pairs_recursive(a, other, b + 1, pad, cb);
+			query_pairs_recursive(a, other, other.right_child(b), pad, cb);
 		}
-
-		if (direction.z != zero_val) {
-			T inv = tr::one() / direction.z;
-			T t1 = (box.mins.z - origin.z) * inv;
-			T t2 = (box.maxs.z - origin.z) * inv;
-			tmin = tr::max_val(tmin, tr::min_val(t1, t2));
-			tmax = tr::min_val(tmax, tr::max_val(t1, t2));
-		} else if (origin.z < box.mins.z || origin.z > box.maxs.z) {
-			return false;
-		}
-
-		return tmax >= tmin && tmin < best_t;
 	}
 
-	template <typename Callback>
-	void query_ray_recursive(
-	    int idx, const vec3<T> & origin, const vec3<T> & direction, T & best_t, Callback && cb) const {
-		const auto & n = nodes_[idx];
-
-		if (!ray_hits_aabb(origin, direction, n.box, best_t))
-			return;
-
-		if (n.is_leaf()) {
-			cb(n.item, best_t);
+	// Pairs within each child, then pairs across the two.
+	template <typename Callback> void query_self_pairs_recursive(int idx, T pad, Callback && cb) const {
+		if (nodes_[idx].is_leaf())
 			return;
-		}
-		if (n.left >= 0)
-			query_ray_recursive(n.left, origin, direction, best_t, cb);
-		if (n.right >= 0)
-			query_ray_recursive(n.right, origin, direction, best_t, cb);
+		query_self_pairs_recursive(idx + 1, pad, cb);
+		query_self_pairs_recursive(right_child(idx), pad, cb);
+		query_pairs_recursive(idx + 1, *this, right_child(idx), pad, cb);
 	}
 };
 
@@ -1,11 +1,17 @@
 #pragma once
 
 #include <hop/bvh.h>
+#include <hop/dynamic_tree.h>
 #include <hop/manager.h>
 #include <hop/math/intersect.h>
 #include <hop/solid.h>
+#include <hop/wide_bvh.h>
 
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -34,38 +40,149 @@ namespace hop {
 // leave their initial clusters), inflating internal-node AABBs and
 // degrading query precision; rebuild_dynamic() is exposed for callers
 // who want to recover quality periodically.
+//
+// Incremental dynamic tree: set_incremental_dynamic(true) replaces the refit
+// BVH with a dynamic_tree of fat leaves. A solid is inserted when added and
+// removed when removed, each in O(log n), and after each solid's tick
+// post_update(s) reinserts it only if it left its fat box. A tick where most
+// bodies rest or move within their margins does almost no tree work, and a
+// spawn no longer forces a full rebuild. Solids moved outside the tick need
+// mark_dynamic_moved(), as for the refit BVH.
+//
+// Pair pass: set_pair_pass(true) makes pre_update(dt) find every candidate
+// pair for the tick up front, with one descent of the dynamic BVH against
+// itself and one against the static BVH, instead of each moving solid
+// searching the trees from the root for its own sweep. A solid's pair box is
+// its world bound grown by its motion over the tick plus pair_margin; the
+// descents pad one side by the largest such growth and keep, per solid, the
+// partners whose bounds meet its pair box. find_solids_near then answers a
+// solid's sweep query from that list while the query box lies inside the pair
+// box (a fast spin can push it out; the query then searches the trees as
+// before). Refit BVH only: the incremental tree ignores the setting.
+//
+// Scope pruning: set_scope_pruning(true) gives every node of the static and
+// refit dynamic BVHs the OR of its solids' collision scopes, so a filtered
+// query (collide_with_bits != -1: a projectile that only hits hitboxes) skips
+// whole subtrees of other layers instead of rejecting them leaf by leaf. The
+// masks are taken when a tree is built or refit — the dynamic tree's at every
+// pre_update, the static tree's at its rebuild — so after changing a static
+// solid's collision scope call mark_dirty(), and a dynamic solid's new scope
+// is seen from the next tick. The incremental tree filters at its leaves.
+//
+// Dirty refit: set_dirty_refit(true) makes the per-tick refit of the dynamic
+// BVH visit only the leaves of solids that moved. post_update(s) — which the
+// simulator calls for each solid it moved — records s's leaf, and pre_update
+// refits those leaves bottom-up (bvh::refit_leaves), stopping at the first
+// ancestor whose box is unchanged. A world that is mostly asleep then refits
+// in O(moved * depth) rather than O(n). Solids moved outside the tick need
+// mark_dynamic_moved(), which refits everything; so does a dynamic solid's
+// new collision scope under scope pruning.
+//
+// Sleeping tree: set_sleeping_tree(true) takes a dynamic solid out of the
+// dynamic BVH when it falls asleep and keeps it in a dynamic_tree of its own
+// until it wakes (the simulator reports both through solid_deactivated and
+// solid_activated). A sleeper is inserted and removed in O(log n) and is
+// otherwise left alone: it is never refit, and the periodic rebuild covers
+// the awake solids only, so the dynamic BVH's upkeep tracks the awake
+// population. A solid that wakes mid-tick leaves the sleeping tree at once and
+// is found by a linear scan until pre_update returns it to the dynamic BVH;
+// one that falls asleep moves at the next pre_update. Anything that moves a
+// body wakes it, so the sleeping tree never needs a refit. Solids asleep
+// when this is switched on move as they next fall asleep. Refit BVH only: the
+// incremental tree already does no work for a body at rest.
+//
+// Async rebuild: set_async_rebuild(true) takes the periodic rebuild of the
+// dynamic BVH off the tick. async_rebuild_lag ticks before one falls due,
+// pre_update snapshots the leaf bounds and hands them to a worker thread,
+// which builds the new tree while the old one goes on being refit. On the
+// tick the rebuild falls due, pre_update swaps the new tree in and refits it
+// to the current bounds, first waiting for the worker should it be late. The
+// tick then pays an O(n) snapshot and refit instead of the O(n log n) build,
+// and the frame time loses its sawtooth. The snapshot and the swap land on
+// fixed ticks, so the trees, the iteration order and the simulation are the
+// same from run to run. A rebuild forced by an add, remove or migration still
+// runs on the tick, and discards a background one started before it. The
+// worker is started with the first rebuild and parks between them. Refit BVH
+// only.
+//
+// Wide static tree: set_wide_static(true) also collapses the static BVH into a
+// wide_bvh at each rebuild, 8 wide where AVX2 is enabled and 4 wide otherwise,
+// and box queries of the static bucket walk that instead, testing a node's
+// children in one vector compare. Segment traces (find_solids_on_segment) walk
+// it along the segment, so a long diagonal trace through a level hands on only
+// the statics it passes near rather than every one its box meets; fixed-point
+// reciprocals round too coarsely for that, so fixed-point traces query the
+// segment's box. The wide tree has no scope masks: a filtered query under
+// scope pruning keeps to the binary tree.
 
 template <typename T> class bvh_manager : public manager<T> {
 public:
+	using tr = scalar_traits<T>;
+
+	~bvh_manager() override { stop_rebuild_worker(); }
+
 	void add_solid(solid<T> * s, bool is_static) {
 		if (is_static) {
 			static_solids_.push_back(s);
 			dirty_ = true;
 		} else {
 			dynamic_solids_.push_back(s);
-			dynamic_dirty_ = true;
+			if (incremental_)
+				insert_proxy(s);
+			else
+				dynamic_dirty_ = true;
 		}
 		// iteration_order_ contains both buckets, so any add invalidates it —
 		// including static adds, which leave dynamic_dirty_ untouched.
 		order_dirty_ = true;
+		pairs_valid_ = false;
 	}
 
-	void remove_solid(solid<T> * s) {
-		auto it_s = std::find(static_solids_.begin(), static_solids_.end(), s);
-		if (it_s != static_solids_.end()) {
-			static_solids_.erase(it_s);
+	void remove_solid(solid<T> * s) { remove_solids(&s, 1); }
+
+	// Remove count solids in one compaction pass over each bucket, so a batch
+	// costs O(n + count log count) rather than O(n) per solid. Each bucket that
+	// lost a solid rebuilds once, on its next use.
+	void remove_solids(solid<T> * const solids[], int count) {
+		pairs_valid_ = false;
+		removing_.assign(solids, solids + count);
+		std::sort(removing_.begin(), removing_.end());
+		auto is_dead = [this](solid<T> * s) { return std::binary_search(removing_.begin(), removing_.end(), s); };
+		auto drop = [&](std::vector<solid<T> *> & bucket) {
+			auto it = std::remove_if(bucket.begin(), bucket.end(), is_dead);
+			const bool removed = it != bucket.end();
+			bucket.erase(it, bucket.end());
+			return removed;
+		};
+		if (drop(static_solids_)) {
 			dirty_ = true;
-			// Drop the now-dangling pointer from the cached order immediately;
+			// Drop the now-dangling pointers from the cached order immediately;
 			// it may be read again before the next rebuild.
 			order_dirty_ = true;
-			return;
 		}
-		auto it_d = std::find(dynamic_solids_.begin(), dynamic_solids_.end(), s);
-		if (it_d != dynamic_solids_.end()) {
-			dynamic_solids_.erase(it_d);
+		if (incremental_) {
+			for (auto * s : dynamic_solids_) {
+				if (s->get_manager_proxy() >= 0 && is_dead(s)) {
+					dynamic_tree_.remove(s->get_manager_proxy());
+					s->set_manager_proxy(-1);
+				}
+			}
+			drop(unproxied_);
+		}
+		if (drop(dynamic_solids_)) {
 			dynamic_dirty_ = true;
 			order_dirty_ = true;
 		}
+		for (auto * s : removing_) {
+			if (in_sleeping_tree(s)) {
+				sleepers_.remove(s->get_manager_proxy());
+				s->set_manager_proxy(-1);
+				order_dirty_ = true;
+			}
+		}
+		if (drop(woken_))
+			order_dirty_ = true;
+		drop(fell_asleep_);
 	}
 
 	// Mark the static BVH stale. Call after a static solid's position or
@@ -77,8 +194,118 @@ public:
 	// integration moving trigger volumes, say) and still need the next query to
 	// see current bounds. Unlike mark_dirty() this costs an O(n) refit rather
 	// than a sort-and-rebuild; topology is still refreshed periodically so
-	// drift cannot degrade query precision indefinitely.
-	void mark_dynamic_moved() { dynamic_moved_ = true; }
+	// drift cannot degrade query precision indefinitely. With the incremental
+	// tree it re-checks every dynamic solid against its fat box.
+	void mark_dynamic_moved() {
+		dynamic_moved_ = true;
+		pairs_valid_ = false;
+	}
+
+	// Keep dynamic solids in an incrementally updated dynamic_tree instead of the
+	// refit-and-rebuild BVH (see the class comment). Switching builds the new
+	// structure from the current solids.
+	void set_incremental_dynamic(bool on) {
+		if (on == incremental_)
+			return;
+		restore_sleepers();
+		for (auto * s : dynamic_solids_)
+			s->set_manager_proxy(-1);
+		dynamic_tree_.clear();
+		unproxied_.clear();
+		incremental_ = on;
+		if (on) {
+			for (auto * s : dynamic_solids_)
+				insert_proxy(s);
+		}
+		dynamic_dirty_ = true;
+		order_dirty_ = true;
+	}
+	bool get_incremental_dynamic() const { return incremental_; }
+
+	// Find each tick's candidate pairs in one pass (see the class comment).
+	void set_pair_pass(bool on) {
+		pair_pass_ = on;
+		pairs_valid_ = false;
+	}
+	bool get_pair_pass() const { return pair_pass_; }
+
+	// Slack around each solid's motion in its pair-pass box. Larger margins
+	// let faster spins use the candidate list, and add false candidates.
+	void set_pair_margin(T m) { pair_margin_ = m; }
+	T get_pair_margin() const { return pair_margin_; }
+
+	// Prune filtered queries by collision scope (see the class comment).
+	void set_scope_pruning(bool on) {
+		scope_pruning_ = on;
+		if (on) {
+			bvh_.set_masks(scope_of);
+			dynamic_bvh_.set_masks(scope_of);
+		} else {
+			bvh_.clear_masks();
+			dynamic_bvh_.clear_masks();
+		}
+	}
+	bool get_scope_pruning() const { return scope_pruning_; }
+
+	// Refit only the moved solids' leaves (see the class comment).
+	// Switching on refits everything once, for moves made before it.
+	void set_dirty_refit(bool on) {
+		dirty_refit_ = on;
+		dynamic_moved_ = true;
+		moved_leaves_.clear();
+	}
+	bool get_dirty_refit() const { return dirty_refit_; }
+
+	// Keep asleep dynamics in a tree of their own (see the class comment).
+	// Switching off returns them to the dynamic BVH.
+	void set_sleeping_tree(bool on) {
+		if (!on)
+			restore_sleepers();
+		sleeping_tree_ = on;
+		sleepers_.set_margin(T {});  // a sleeper does not move
+	}
+	bool get_sleeping_tree() const { return sleeping_tree_; }
+	int get_sleeping_count() const { return sleepers_.size(); }
+
+	// Rebuild the dynamic BVH on a worker thread (see the class comment).
+	// Switching off waits for a running rebuild, drops its tree and stops the
+	// worker.
+	void set_async_rebuild(bool on) {
+		if (!on)
+			stop_rebuild_worker();
+		async_rebuild_ = on;
+	}
+	bool get_async_rebuild() const { return async_rebuild_; }
+
+	// Walk a wide copy of the static BVH (see the class comment); takes effect
+	// at the static tree's next rebuild.
+	void set_wide_static(bool on) {
+		wide_static_ = on;
+		dirty_ = true;
+	}
+	bool get_wide_static() const { return wide_static_; }
+	const wide_bvh<T, solid<T> *, wide_bvh_native_width> & get_wide_static_tree() const { return wide_bvh_; }
+
+	// Candidate (solid, partner) entries from the last pair pass: twice the
+	// dynamic-dynamic pairs plus the dynamic-static ones. 0 when the pass is
+	// off or its list is stale.
+	int get_pair_count() const { return pairs_valid_ ? static_cast<int>(partners_.size()) : 0; }
+
+	// The incremental tree, for tuning its margin and for inspection.
+	dynamic_tree<T, solid<T> *> & get_dynamic_tree() { return dynamic_tree_; }
+	const dynamic_tree<T, solid<T> *> & get_dynamic_tree() const { return dynamic_tree_; }
+
+	// Builder for each tree (see bvh_build); takes effect at its next rebuild.
+	// The static tree is built once and queried every tick, which is where SAH
+	// pays off most: a world of huge terrain slabs next to small props.
+	void set_static_build_method(bvh_build m) {
+		bvh_.set_build_method(m);
+		dirty_ = true;
+	}
+	void set_dynamic_build_method(bvh_build m) {
+		dynamic_bvh_.set_build_method(m);
+		dynamic_dirty_ = true;
+	}
 
 	void rebuild() {
 		std::vector<std::pair<aa_box<T>, solid<T> *>> entries;
@@ -91,6 +318,10 @@ public:
 		}
 
 		bvh_.build(entries);
+		if (scope_pruning_)
+			bvh_.set_masks(scope_of);
+		if (wide_static_)
+			wide_bvh_.build(bvh_);
 		dirty_ = false;
 	}
 
@@ -103,7 +334,7 @@ public:
 			rebuild_dynamic();
 			return;
 		}
-		dynamic_bvh_.refit([](solid<T> * s) { return s->get_world_bound(); });
+		refit_dynamic_bvh(true);
 		dynamic_moved_ = false;
 	}
 
@@ -122,18 +353,17 @@ public:
 		}
 
 		dynamic_bvh_.build(entries);
-		dynamic_dirty_ = false;
-		dynamic_moved_ = false;
-		ticks_since_dynamic_rebuild_ = 0;
-		refits_since_dynamic_rebuild_ = 0;
-
-		rebuild_iteration_order();
+		if (scope_pruning_)
+			dynamic_bvh_.set_masks(scope_of);
+		// A background rebuild from before this has the old solids.
+		rebuild_stale_ = rebuild_in_flight_;
+		dynamic_bvh_built();
 	}
 
 	// Rebuild the simulator's spatial-locality update order from the current
 	// BVH leaves plus the bookkeeping vectors. Invariant the simulator relies
 	// on: the order must contain *every* solid this manager owns exactly once,
-	// so its size equals dynamic_solids_.size() + static_solids_.size(). The
+	// so its size equals get_dynamic_count() + static_solids_.size(). The
 	// dynamic BVH only holds solids with shapes, so shape-less dynamics (e.g. a
 	// body added to the space before its collision shape arrives) are appended
 	// explicitly — otherwise they'd be silently dropped from the order. Assumes
@@ -144,17 +374,26 @@ public:
 		// since walls don't move and their per-tick work is trivial).
 		iteration_order_.clear();
 		iteration_order_.reserve(dynamic_solids_.size() + static_solids_.size());
-		dynamic_bvh_.collect_leaves(iteration_order_);
-		for (auto * s : dynamic_solids_)
-			if (s->get_shapes().empty())
-				iteration_order_.push_back(s);
+		if (incremental_) {
+			dynamic_tree_.collect_leaves(iteration_order_);
+			iteration_order_.insert(iteration_order_.end(), unproxied_.begin(), unproxied_.end());
+		} else {
+			dynamic_bvh_.collect_leaves(iteration_order_);
+			for (auto * s : dynamic_solids_)
+				if (s->get_shapes().empty())
+					iteration_order_.push_back(s);
+		}
+		iteration_order_.insert(iteration_order_.end(), woken_.begin(), woken_.end());
+		sleepers_.collect_leaves(iteration_order_);
 		for (auto * s : static_solids_)
 			iteration_order_.push_back(s);
 		order_dirty_ = false;
 	}
 
 	int get_static_count() const { return static_cast<int>(static_solids_.size()); }
-	int get_dynamic_count() const { return static_cast<int>(dynamic_solids_.size()); }
+	int get_dynamic_count() const {
+		return static_cast<int>(dynamic_solids_.size() + woken_.size()) + sleepers_.size();
+	}
 
 	// ---- manager<T> interface ----
 
@@ -173,69 +412,89 @@ public:
 	// cost is ~1 ms/build at N=10000, well below the savings).
 	static constexpr int dynamic_rebuild_period = 16;
 
+	// Ticks between an async rebuild's snapshot and its swap (see the class
+	// comment): how long the worker has to build before the tick waits for it.
+	// Two ticks is ~30 ms at 60 Hz against ~1 ms to build N=10000, and the
+	// bounds the tree is built from are only that old when it goes in.
+	static constexpr int async_rebuild_lag = 2;
+
 	int find_solids_in_aa_box(const aa_box<T> & box, solid<T> * solids[], int max_solids,
 	                          int collide_with_bits = -1) override {
-		// -1 means "no filter", not "all bits": it must keep reporting scope-0 solids,
-		// which a bitwise test against -1 would drop.
-		const bool filter = collide_with_bits != -1;
-		int count = 0;
-		auto accepts = [&](solid<T> * s) {
-			return !filter || (collide_with_bits & s->get_collision_scope()) != 0;
-		};
+		refresh_trees();
+		return query_solids_in_aa_box(box, solids, max_solids, collide_with_bits);
+	}
 
-		if (static_cast<int>(static_solids_.size()) >= linear_scan_threshold) {
-			if (dirty_)
-				rebuild();
-			bvh_.query_aabb(box, [&](solid<T> * s) {
-				if (count < max_solids && accepts(s)) {
-					solids[count] = s;
-					count++;
-				}
+	// Each bucket from its tree when the tree is current, by a linear scan
+	// otherwise (below linear_scan_threshold, or a tree find_solids_in_aa_box
+	// would have rebuilt or refit first). The walk ends when the buffer fills.
+	int query_solids_in_aa_box(const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                           int collide_with_bits = -1) const override {
+		int count = 0;
+		if (max_solids > 0) {
+			visit_solids(box, collide_with_bits, [&](solid<T> * s) {
+				solids[count++] = s;
+				return count < max_solids;
 			});
-		} else {
-			for (auto * s : static_solids_) {
-				if (count >= max_solids)
-					break;
-				if (s->get_shapes().empty())
-					continue;
-				if (!accepts(s))
-					continue;
-				if (test_intersection(box, s->get_world_bound())) {
-					solids[count] = s;
-					count++;
-				}
-			}
 		}
+		return count;
+	}
 
-		// Dynamics: BVH above threshold, linear scan below. Refit normally
-		// happens in pre_update; rebuild lazily here only if we're stale and
-		// no tick has yet driven the refit (e.g., direct caller queries).
-		if (static_cast<int>(dynamic_solids_.size()) >= linear_scan_threshold) {
-			if (dynamic_dirty_) {
-				rebuild_dynamic();
-			} else if (dynamic_moved_) {
-				refit_dynamic();
-			}
-			dynamic_bvh_.query_aabb(box, [&](solid<T> * s) {
-				if (count < max_solids && accepts(s)) {
-					solids[count] = s;
-					count++;
-				}
-			});
-		} else {
-			for (auto * s : dynamic_solids_) {
-				if (count >= max_solids)
-					break;
-				if (!accepts(s))
-					continue;
-				if (test_intersection(box, s->get_world_bound())) {
-					solids[count] = s;
-					count++;
+	bool for_each_solid_in_aa_box(const aa_box<T> & box, const std::function<bool(solid<T> *)> & fn,
+	                              int collide_with_bits = -1) override {
+		refresh_trees();
+		visit_solids(box, collide_with_bits, fn);
+		return true;
+	}
+
+	// With the pair pass, s's candidates from pre_update; see the class comment.
+	int find_solids_near(solid<T> * s, const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                     int collide_with_bits = -1) override {
+		const int i = s->get_manager_proxy();
+		if (!pairs_valid_ || i < 0 || i >= static_cast<int>(pair_boxes_.size()) || dynamic_solids_[i] != s ||
+		    !contains(pair_boxes_[i], box))
+			return find_solids_in_aa_box(box, solids, max_solids, collide_with_bits);
+		int count = 0;
+		for (int k = pair_start_[i]; k < pair_start_[i + 1] && count < max_solids; ++k) {
+			solid<T> * p = partners_[k];
+			if (collide_with_bits != -1 && (collide_with_bits & p->get_collision_scope()) == 0)
+				continue;
+			if (test_intersection(box, p->get_world_bound()))
+				solids[count++] = p;
+		}
+		return count;
+	}
+
+	// With the wide static tree, the statics seg passes within pad of, by a walk
+	// along it, then the other buckets' solids that meet its box; see the class
+	// comment.
+	int find_solids_on_segment(const segment<T> & seg, T pad, solid<T> * solids[], int max_solids,
+	                           int collide_with_bits = -1) override {
+		refresh_trees();
+		aa_box<T> box(seg.origin, seg.origin);
+		box.merge(seg.get_end_point());
+		box.mins -= vec3<T>(pad, pad, pad);
+		box.maxs += vec3<T>(pad, pad, pad);
+		if constexpr (!is_fixed_scalar_v<T>) {
+			const bool filter = collide_with_bits != -1;
+			if (wide_static_current() && !(filter && scope_pruning_)) {
+				int count = 0;
+				wide_bvh_.query_ray(seg.origin, seg.direction, pad, [&](solid<T> * s, T &) {
+					if (count < max_solids && (!filter || (collide_with_bits & s->get_collision_scope()) != 0))
+						solids[count++] = s;
+				});
+				if (count < max_solids) {
+					visit_solids(
+					    box, collide_with_bits,
+					    [&](solid<T> * s) {
+						    solids[count++] = s;
+						    return count < max_solids;
+					    },
+					    false);
 				}
+				return count;
 			}
 		}
-
-		return count;
+		return query_solids_in_aa_box(box, solids, max_solids, collide_with_bits);
 	}
 
 	// bvh_manager is broad-phase only — find_solids_in_aa_box accelerates the
@@ -250,14 +509,36 @@ public:
 	// topology is stale (adds/removes since last rebuild) or every
 	// dynamic_rebuild_period ticks to recover from drift; otherwise refit.
 	// Below threshold the linear scan is faster, so we skip the BVH work.
+	// A stale static tree is rebuilt here too, so the queries made during the
+	// tick only read the trees (the simulator's split Pass A issues them from
+	// several threads at once).
 	void pre_update(T dt) override {
-		if (static_cast<int>(dynamic_solids_.size()) < linear_scan_threshold)
+		pairs_valid_ = false;
+		pair_dt_ = dt;
+		if (dirty_ && static_cast<int>(static_solids_.size()) >= linear_scan_threshold)
+			rebuild();
+		if (incremental_) {
+			pre_update_incremental();
+			return;
+		}
+		if (!woken_.empty() || !fell_asleep_.empty())
+			migrate_sleepers();
+		if (static_cast<int>(dynamic_solids_.size()) < linear_scan_threshold) {
+			moved_leaves_.clear();
 			return;
-		if (dynamic_dirty_ || ++ticks_since_dynamic_rebuild_ >= dynamic_rebuild_period) {
+		}
+		// A due rebuild is the background one when it is ready to go in.
+		bool swapped = false;
+		if (!dynamic_dirty_ && ++ticks_since_dynamic_rebuild_ >= dynamic_rebuild_period)
+			swapped = finish_async_rebuild();
+		if (!swapped && (dynamic_dirty_ || ticks_since_dynamic_rebuild_ >= dynamic_rebuild_period)) {
 			rebuild_dynamic();  // also refreshes iteration_order_
 			ticks_since_dynamic_rebuild_ = 0;
-		} else {
-			dynamic_bvh_.refit([](solid<T> * s) { return s->get_world_bound(); });
+		} else if (!swapped) {
+			if (async_rebuild_ && ticks_since_dynamic_rebuild_ >= dynamic_rebuild_period - async_rebuild_lag &&
+			    (!rebuild_in_flight_ || rebuild_stale_))
+				start_async_rebuild();
+			refit_dynamic_bvh(dynamic_moved_ || !dirty_refit_);
 			dynamic_moved_ = false;
 			// A refit preserves topology, so the BVH leaves are unchanged — but
 			// a static add/remove (which doesn't dirty the dynamic BVH) can still
@@ -265,6 +546,8 @@ public:
 			if (order_dirty_)
 				rebuild_iteration_order();
 		}
+		if (pair_pass_)
+			find_pairs();
 	}
 	void post_update(T dt) override {}
 	void pre_update(solid<T> * s, T dt) override {}
@@ -272,7 +555,36 @@ public:
 	bool collision_response(solid<T> * s, vec3<T> & position, vec3<T> & remainder, collision<T> & col) override {
 		return false;
 	}
-	void post_update(solid<T> * s, T dt) override {}
+	// The simulator calls this serially once a solid's position is final for the
+	// tick, so this is where the incremental tree learns of the move, and where
+	// dirty refit records the leaf to refit.
+	void post_update(solid<T> * s, T dt) override {
+		const int proxy = s->get_manager_proxy();
+		if (!incremental_) {
+			if (dirty_refit_ && proxy >= 0 && proxy < static_cast<int>(leaf_of_.size()) &&
+			    proxy < static_cast<int>(dynamic_solids_.size()) && dynamic_solids_[proxy] == s && leaf_of_[proxy] >= 0)
+				moved_leaves_.push_back(leaf_of_[proxy]);
+			return;
+		}
+		if (proxy < 0 || dynamic_tree_.get_item(proxy) != s)
+			return;
+		dynamic_tree_.move(proxy, s->get_world_bound(), s->get_velocity() * dt);
+	}
+
+	// The sleeping tree's hooks. A woken solid leaves the tree now, as it may
+	// move this tick; one that fell asleep waits for pre_update.
+	void solid_activated(solid<T> * s) override {
+		if (!in_sleeping_tree(s))
+			return;
+		sleepers_.remove(s->get_manager_proxy());
+		s->set_manager_proxy(-1);
+		woken_.push_back(s);
+		order_dirty_ = true;
+	}
+	void solid_deactivated(solid<T> * s) override {
+		if (sleeping_tree_ && !incremental_)
+			fell_asleep_.push_back(s);
+	}
 
 	// Spatial-locality iteration order. Returned when the dynamic BVH is in
 	// active use — below that threshold the linear-scan fallback wouldn't
@@ -284,11 +596,431 @@ public:
 	}
 
 private:
+	static int scope_of(solid<T> * s) { return s->get_collision_scope(); }
+
+	bool wide_static_current() const {
+		return wide_static_ && !dirty_ && static_cast<int>(static_solids_.size()) >= linear_scan_threshold;
+	}
+
+	// Bookkeeping for a new dynamic BVH topology, from rebuild_dynamic or a
+	// finished async rebuild.
+	void dynamic_bvh_built() {
+		// Dirty refit finds a moved solid's leaf through its proxy, its index
+		// in dynamic_solids_ (the pair pass uses the same numbering).
+		if (!incremental_) {
+			for (int i = 0; i < static_cast<int>(dynamic_solids_.size()); ++i)
+				dynamic_solids_[i]->set_manager_proxy(i);
+			const auto & leaves = dynamic_bvh_.get_items();
+			leaf_of_.assign(dynamic_solids_.size(), -1);
+			for (int k = 0; k < static_cast<int>(leaves.size()); ++k)
+				leaf_of_[leaves[k]->get_manager_proxy()] = k;
+		}
+		moved_leaves_.clear();
+		dynamic_dirty_ = false;
+		dynamic_moved_ = false;
+		ticks_since_dynamic_rebuild_ = 0;
+		refits_since_dynamic_rebuild_ = 0;
+
+		rebuild_iteration_order();
+	}
+
+	// Every leaf, or with all false only the moved ones.
+	void refit_dynamic_bvh(bool all) {
+		auto bound = [](solid<T> * s) { return s->get_world_bound(); };
+		const int * leaves = moved_leaves_.data();
+		const int count = static_cast<int>(moved_leaves_.size());
+		if (all && scope_pruning_)
+			dynamic_bvh_.refit(bound, scope_of);
+		else if (all)
+			dynamic_bvh_.refit(bound);
+		else if (scope_pruning_)
+			dynamic_bvh_.refit_leaves(leaves, count, bound, scope_of);
+		else
+			dynamic_bvh_.refit_leaves(leaves, count, bound);
+		moved_leaves_.clear();
+	}
+
+	// Snapshot the dynamic solids' bounds and hand them to the worker, starting
+	// it if need be. The worker touches only rebuild_entries_ and rebuilt_bvh_,
+	// which the tick leaves alone until wait_for_rebuild returns. A stale
+	// rebuild still running is waited out and dropped first.
+	void start_async_rebuild() {
+		wait_for_rebuild();
+		rebuild_entries_.clear();
+		for (auto * s : dynamic_solids_) {
+			if (!s->get_shapes().empty())
+				rebuild_entries_.push_back({ s->get_world_bound(), s });
+		}
+		rebuilt_bvh_.set_build_method(dynamic_bvh_.get_build_method());
+		rebuild_stale_ = false;
+		rebuild_in_flight_ = true;
+		if (!rebuild_worker_.joinable())
+			rebuild_worker_ = std::thread([this] { rebuild_worker_loop(); });
+		{
+			std::lock_guard<std::mutex> lock(rebuild_mutex_);
+			rebuild_job_ = true;
+		}
+		rebuild_cv_.notify_all();
+	}
+
+	// Swap in the background rebuild, waiting for it if the worker is late, and
+	// refit it from the current bounds. Returns false, dropping the tree, when
+	// there is none or the dynamic solids have changed since its snapshot.
+	bool finish_async_rebuild() {
+		if (!rebuild_in_flight_)
+			return false;
+		wait_for_rebuild();
+		if (rebuild_stale_ || dynamic_dirty_)
+			return false;
+		std::swap(dynamic_bvh_, rebuilt_bvh_);
+		refit_dynamic_bvh(true);
+		dynamic_bvh_built();
+		return true;
+	}
+
+	// Block until the worker has finished the job it was given, if any.
+	void wait_for_rebuild() {
+		if (!rebuild_in_flight_)
+			return;
+		std::unique_lock<std::mutex> lock(rebuild_mutex_);
+		rebuild_cv_.wait(lock, [this] { return !rebuild_job_; });
+		rebuild_in_flight_ = false;
+	}
+
+	void stop_rebuild_worker() {
+		if (!rebuild_worker_.joinable())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(rebuild_mutex_);
+			rebuild_stop_ = true;
+		}
+		rebuild_cv_.notify_all();
+		rebuild_worker_.join();
+		rebuild_stop_ = false;
+		rebuild_job_ = false;
+		rebuild_in_flight_ = false;
+	}
+
+	// The worker: park until handed a job (or told to stop), build, report.
+	void rebuild_worker_loop() {
+		std::unique_lock<std::mutex> lock(rebuild_mutex_);
+		for (;;) {
+			rebuild_cv_.wait(lock, [this] { return rebuild_job_ || rebuild_stop_; });
+			if (rebuild_stop_)
+				return;
+			lock.unlock();
+			rebuilt_bvh_.build(rebuild_entries_);
+			lock.lock();
+			rebuild_job_ = false;
+			rebuild_cv_.notify_all();
+		}
+	}
+
+	// Bring a stale tree up to date before a query. Refit normally happens in
+	// pre_update; this only does work for direct callers between an add,
+	// remove or mark_* and the next tick.
+	void refresh_trees() {
+		if (dirty_ && static_cast<int>(static_solids_.size()) >= linear_scan_threshold)
+			rebuild();
+		if (static_cast<int>(dynamic_solids_.size()) < linear_scan_threshold)
+			return;
+		if (incremental_) {
+			if (dynamic_moved_)
+				sync_dynamic_tree();
+		} else if (dynamic_dirty_) {
+			rebuild_dynamic();
+		} else if (dynamic_moved_) {
+			refit_dynamic();
+		}
+	}
+
+	// fn(s) for each solid overlapping box that collide_with_bits accepts —
+	// statics (unless with_statics is false), then dynamics, each bucket from
+	// its tree when the tree is current and by a linear scan otherwise — until
+	// fn returns false. Only reads, so the read-only query can use it. A
+	// filtered walk of a BVH with scope masks skips the subtrees the filter
+	// rejects; visit still checks each solid's current scope.
+	template <typename Fn>
+	void visit_solids(const aa_box<T> & box, int collide_with_bits, Fn && fn, bool with_statics = true) const {
+		// -1 means "no filter", not "all bits": it must keep reporting scope-0 solids,
+		// which a bitwise test against -1 would drop.
+		const bool filter = collide_with_bits != -1;
+		bool go = true;
+		auto visit = [&](solid<T> * s) {
+			if (!filter || (collide_with_bits & s->get_collision_scope()) != 0)
+				go = fn(s);
+			return go;
+		};
+
+		if (with_statics && wide_static_current() && !(filter && scope_pruning_)) {
+			wide_bvh_.query_aabb(box, visit);
+		} else if (with_statics && !dirty_ && static_cast<int>(static_solids_.size()) >= linear_scan_threshold) {
+			if (filter)
+				bvh_.query_aabb(box, collide_with_bits, visit);
+			else
+				bvh_.query_aabb(box, visit);
+		} else if (with_statics) {
+			for (auto * s : static_solids_) {
+				if (!s->get_shapes().empty() && test_intersection(box, s->get_world_bound()) && !visit(s))
+					break;
+			}
+		}
+		if (!go)
+			return;
+
+		// The incremental tree's leaves are fat, so its hits are re-tested
+		// against the tight bound.
+		const bool tree_current = static_cast<int>(dynamic_solids_.size()) >= linear_scan_threshold &&
+		                          !dynamic_moved_ && (incremental_ || !dynamic_dirty_);
+		if (tree_current && incremental_) {
+			dynamic_tree_.query_aabb(box, [&](solid<T> * s) {
+				return !test_intersection(box, s->get_world_bound()) || visit(s);
+			});
+		} else if (tree_current && filter) {
+			dynamic_bvh_.query_aabb(box, collide_with_bits, visit);
+		} else if (tree_current) {
+			dynamic_bvh_.query_aabb(box, visit);
+		} else {
+			for (auto * s : dynamic_solids_) {
+				if (test_intersection(box, s->get_world_bound()) && !visit(s))
+					break;
+			}
+		}
+		if (!go)
+			return;
+
+		for (auto * s : woken_) {
+			if (test_intersection(box, s->get_world_bound()) && !visit(s))
+				return;
+		}
+		sleepers_.query_aabb(box, [&](solid<T> * s) {
+			return !test_intersection(box, s->get_world_bound()) || visit(s);
+		});
+	}
+
+	static bool contains(const aa_box<T> & outer, const aa_box<T> & inner) {
+		return outer.mins.x <= inner.mins.x && outer.mins.y <= inner.mins.y && outer.mins.z <= inner.mins.z &&
+		       inner.maxs.x <= outer.maxs.x && inner.maxs.y <= outer.maxs.y && inner.maxs.z <= outer.maxs.z;
+	}
+
+	// The pair pass. A solid's sweep box reaches past its bound by at most twice
+	// the motion's L1 norm (the sweep_slide box is shifted by the motion and
+	// grown by its length), so its pair box is grown by that plus pair_margin_.
+	// The descents pad one side by the largest growth, so they meet every pair
+	// either solid needs; each (solid, partner) entry is then kept if the
+	// partner's bound meets the solid's own pair box, and the entries are
+	// bucketed by solid with a counting sort so each solid's candidates are
+	// contiguous in partners_. Only awake solids sweep, so a sleeping solid
+	// gets no list; its pair box is left empty, and should it be woken and
+	// query this tick, it searches.
+	void find_pairs() {
+		const int n = static_cast<int>(dynamic_solids_.size());
+		pair_boxes_.resize(n);
+		T pad {};
+		for (int i = 0; i < n; ++i) {
+			// A solid with no shape is not in the tree; its queries search.
+			solid<T> * s = dynamic_solids_[i];
+			s->set_manager_proxy(s->get_shapes().empty() ? -1 : i);
+			aa_box<T> & box = pair_boxes_[i];
+			if (!s->active()) {
+				box.mins = vec3<T>(tr::one(), tr::one(), tr::one());
+				box.maxs = vec3<T>(T {}, T {}, T {});
+				continue;
+			}
+			const vec3<T> & v = s->get_velocity();
+			const T r = (tr::abs(v.x) + tr::abs(v.y) + tr::abs(v.z)) * pair_dt_ * tr::two() + pair_margin_;
+			box = s->get_world_bound();
+			box.mins -= vec3<T>(r, r, r);
+			box.maxs += vec3<T>(r, r, r);
+			pad = std::max(pad, r);
+		}
+		raw_pairs_.clear();
+		auto add = [this](solid<T> * a, solid<T> * b) {
+			const int i = a->get_manager_proxy();
+			if (test_intersection(pair_boxes_[i], b->get_world_bound()))
+				raw_pairs_.push_back({ i, b });
+		};
+		dynamic_bvh_.query_self_pairs(
+		    [&](solid<T> * a, solid<T> * b) {
+			    add(a, b);
+			    add(b, a);
+		    },
+		    pad);
+		if (static_cast<int>(static_solids_.size()) >= linear_scan_threshold) {
+			dynamic_bvh_.query_pairs(bvh_, add, pad);
+		} else {
+			for (auto * st : static_solids_) {
+				if (st->get_shapes().empty())
+					continue;
+				aa_box<T> box = st->get_world_bound();
+				box.mins -= vec3<T>(pad, pad, pad);
+				box.maxs += vec3<T>(pad, pad, pad);
+				dynamic_bvh_.query_aabb(box, [&](solid<T> * a) { add(a, st); });
+			}
+		}
+		if (!sleepers_.empty()) {
+			for (int i = 0; i < n; ++i) {
+				if (dynamic_solids_[i]->get_manager_proxy() < 0 || !dynamic_solids_[i]->active())
+					continue;
+				sleepers_.query_aabb(pair_boxes_[i], [&](solid<T> * b) {
+					if (test_intersection(pair_boxes_[i], b->get_world_bound()))
+						raw_pairs_.push_back({ i, b });
+				});
+			}
+		}
+		pair_start_.assign(n + 1, 0);
+		for (const auto & p : raw_pairs_)
+			++pair_start_[p.first + 1];
+		for (int i = 0; i < n; ++i)
+			pair_start_[i + 1] += pair_start_[i];
+		partners_.resize(raw_pairs_.size());
+		pair_fill_.assign(pair_start_.begin(), pair_start_.end() - 1);
+		for (const auto & p : raw_pairs_)
+			partners_[pair_fill_[p.first]++] = p.second;
+		pairs_valid_ = true;
+	}
+
+	// Whether s is a leaf of the sleeping tree. Its proxy is then that leaf;
+	// an awake solid's proxy indexes dynamic_solids_, so check the item too.
+	bool in_sleeping_tree(solid<T> * s) const {
+		const int p = s->get_manager_proxy();
+		const auto & nodes = sleepers_.get_nodes();
+		return p >= 0 && p < static_cast<int>(nodes.size()) && nodes[p].height == 0 && nodes[p].item == s;
+	}
+
+	// Return the solids woken since the last tick to dynamic_solids_, then move
+	// the ones still asleep of those that fell asleep into the sleeping tree.
+	// Either dirties the dynamic BVH, which rebuilds over the awake solids.
+	void migrate_sleepers() {
+		if (!woken_.empty()) {
+			dynamic_solids_.insert(dynamic_solids_.end(), woken_.begin(), woken_.end());
+			woken_.clear();
+			dynamic_dirty_ = true;
+			order_dirty_ = true;
+		}
+		removing_.clear();
+		for (auto * s : fell_asleep_)
+			if (!s->active() && !s->get_shapes().empty())
+				removing_.push_back(s);
+		fell_asleep_.clear();
+		std::sort(removing_.begin(), removing_.end());
+		auto it = std::remove_if(dynamic_solids_.begin(), dynamic_solids_.end(), [this](solid<T> * s) {
+			if (!std::binary_search(removing_.begin(), removing_.end(), s))
+				return false;
+			s->set_manager_proxy(sleepers_.insert(s->get_world_bound(), vec3<T> {}, s));
+			return true;
+		});
+		if (it != dynamic_solids_.end()) {
+			dynamic_solids_.erase(it, dynamic_solids_.end());
+			dynamic_dirty_ = true;
+			order_dirty_ = true;
+		}
+	}
+
+	// Move every sleeper back to dynamic_solids_ (set_sleeping_tree(false)).
+	void restore_sleepers() {
+		sleepers_.collect_leaves(woken_);
+		sleepers_.clear();
+		for (auto * s : woken_)
+			s->set_manager_proxy(-1);
+		dynamic_solids_.insert(dynamic_solids_.end(), woken_.begin(), woken_.end());
+		dynamic_dirty_ = dynamic_dirty_ || !woken_.empty();
+		order_dirty_ = order_dirty_ || !woken_.empty();
+		woken_.clear();
+		fell_asleep_.clear();
+	}
+
+	void insert_proxy(solid<T> * s) {
+		if (s->get_shapes().empty()) {
+			unproxied_.push_back(s);  // inserted by pre_update once it has a shape
+			return;
+		}
+		s->set_manager_proxy(dynamic_tree_.insert(s->get_world_bound(), vec3<T> {}, s));
+	}
+
+	// Re-check every dynamic solid against its fat box (mark_dynamic_moved).
+	void sync_dynamic_tree() {
+		for (auto * s : dynamic_solids_) {
+			if (s->get_manager_proxy() >= 0)
+				dynamic_tree_.move(s->get_manager_proxy(), s->get_world_bound(), vec3<T> {});
+		}
+		dynamic_moved_ = false;
+	}
+
+	void pre_update_incremental() {
+		if (!unproxied_.empty()) {
+			auto it = std::remove_if(unproxied_.begin(), unproxied_.end(), [this](solid<T> * s) {
+				if (s->get_shapes().empty())
+					return false;
+				s->set_manager_proxy(dynamic_tree_.insert(s->get_world_bound(), vec3<T> {}, s));
+				return true;
+			});
+			if (it != unproxied_.end()) {
+				unproxied_.erase(it, unproxied_.end());
+				order_dirty_ = true;
+			}
+		}
+		if (dynamic_moved_)
+			sync_dynamic_tree();
+		dynamic_dirty_ = false;
+		if (static_cast<int>(dynamic_solids_.size()) < linear_scan_threshold)
+			return;
+		// Leaves drift apart in the tree's order as bodies move and reinsert, so
+		// the iteration order is refreshed periodically as well as on add/remove.
+		if (order_dirty_ || ++ticks_since_dynamic_rebuild_ >= dynamic_rebuild_period) {
+			rebuild_iteration_order();
+			ticks_since_dynamic_rebuild_ = 0;
+		}
+	}
+
 	std::vector<solid<T> *> static_solids_;
 	std::vector<solid<T> *> dynamic_solids_;
+	std::vector<solid<T> *> removing_;  // remove_solids scratch
 	std::vector<solid<T> *> iteration_order_;
 	bvh<T, solid<T> *> bvh_;
+	wide_bvh<T, solid<T> *, wide_bvh_native_width> wide_bvh_;  // set_wide_static: bvh_ collapsed
 	bvh<T, solid<T> *> dynamic_bvh_;
+	dynamic_tree<T, solid<T> *> dynamic_tree_;
+	std::vector<solid<T> *> unproxied_;  // incremental mode: dynamics awaiting a shape
+	// Sleeping tree: the asleep dynamics (not in dynamic_solids_), the solids
+	// woken since the last pre_update and those that fell asleep since.
+	dynamic_tree<T, solid<T> *> sleepers_;
+	std::vector<solid<T> *> woken_;
+	std::vector<solid<T> *> fell_asleep_;
+	// Async rebuild: the worker, the bounds it builds from and the tree it
+	// builds. rebuild_job_ (under rebuild_mutex_) is set while the worker owns
+	// those two; rebuild_in_flight_ is the tick's view, cleared once it has
+	// waited the job out. Stale once a rebuild on the tick has superseded it.
+	std::thread rebuild_worker_;
+	std::mutex rebuild_mutex_;
+	std::condition_variable rebuild_cv_;
+	std::vector<std::pair<aa_box<T>, solid<T> *>> rebuild_entries_;
+	bvh<T, solid<T> *> rebuilt_bvh_;
+	bool rebuild_job_ = false;
+	bool rebuild_stop_ = false;
+	bool rebuild_in_flight_ = false;
+	bool rebuild_stale_ = false;
+	bool async_rebuild_ = false;
+	// Dirty refit: dynamic_bvh_ leaf of dynamic_solids_[i], and the leaves of
+	// the solids moved since the last refit.
+	std::vector<int> leaf_of_;
+	std::vector<int> moved_leaves_;
+	// Pair pass: candidates of dynamic_solids_[i] are
+	// partners_[pair_start_[i] .. pair_start_[i + 1]).
+	std::vector<aa_box<T>> pair_boxes_;
+	std::vector<int> pair_start_;
+	std::vector<int> pair_fill_;
+	std::vector<solid<T> *> partners_;
+	std::vector<std::pair<int, solid<T> *>> raw_pairs_;
+	T pair_margin_ = tr::from_milli(50);
+	T pair_dt_ {};
+	bool pair_pass_ = false;
+	bool scope_pruning_ = false;
+	bool wide_static_ = false;
+	bool dirty_refit_ = false;
+	bool sleeping_tree_ = false;
+	bool pairs_valid_ = false;
+	bool incremental_ = false;
 	bool dirty_ = false;
 	bool dynamic_dirty_ = false;
 	bool order_dirty_ = false;
@@ -1164,8 +1164,11 @@ void merge_intra_pair(collision<T> & result, const collision<T> & col, T epsilon
 	result.trigger_scope = modify_scope ? (trigger_scope | col.trigger_scope) : trigger_scope;
 }
 
+// With first_hit set, the first shape hit ends the test and only result.time
+// is written: the any-hit query (simulator::trace_segment_any) needs no point,
+// normal or merge.
 template <typename T>
-void test_segment(collision<T> & result, const segment<T> & seg, solid<T> * s, T epsilon) {
+void test_segment(collision<T> & result, const segment<T> & seg, solid<T> * s, T epsilon, bool first_hit = false) {
 	using tr = scalar_traits<T>;
 	collision<T> col;
 	col.collider = s;
@@ -1248,6 +1251,11 @@ void test_segment(collision<T> & result, const segment<T> & seg, solid<T> * s, T
 			break;
 		}
 
+		if (first_hit && col.time < one) {
+			result.time = col.time;
+			return;
+		}
+
 		// Carry the hit back out of the shape's frame. time and depth are invariant
 		// under a rigid transform; the contact point and normal are not.
 		if (in_shape_frame && col.time < one) {
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <hop/bvh.h>
+#include <hop/math/aa_box.h>
+#include <hop/math/intersect.h>
+#include <hop/scalar_traits.h>
+
+#include <vector>
+
+namespace hop {
+
+// An incrementally maintained AABB tree for moving items (the dynamic tree of
+// Box2D and Bullet's btDbvt). Where bvh is built in one pass and refit, this
+// tree takes O(log n) insert, remove and move calls, so its upkeep per tick is
+// proportional to the items that moved, not to the size of the tree.
+//
+// Each leaf stores a fat box: the item's tight box grown by a margin on every
+// side and extended along its predicted displacement (velocity * dt). While the
+// item's tight box stays inside its fat box, move() is a containment test and
+// nothing else; only an item that escapes is reinserted. Queries therefore
+// report every item whose fat box overlaps — a superset of the tight overlaps,
+// which the caller filters.
+//
+// Insertion descends toward the sibling that grows the tree's total surface
+// area least, and every node on the way back up is rebalanced by a rotation
+// when its children's heights differ by more than one, so the tree stays
+// within a small factor of log2(n) deep however items arrive and move.
+//
+// Usage:
+//   dynamic_tree<float, solid<float> *> tree;
+//   int proxy = tree.insert(s->get_world_bound(), displacement, s);
+//   tree.move(proxy, s->get_world_bound(), displacement);  // each tick it moved
+//   tree.query_aabb(box, [](solid<float> * s) { ... });
+//   tree.remove(proxy);
+//
+// Proxies are node indices and stay valid until remove(); a removed proxy is
+// recycled by a later insert.
+
+template <typename T, typename Item> class dynamic_tree {
+public:
+	using tr = scalar_traits<T>;
+
+	static constexpr int null_node = -1;
+	// Traversal stack entries. A balanced tree of a million leaves is under 30
+	// deep; the rotations keep the depth near that, far inside this bound.
+	static constexpr int stack_size = 256;
+
+	struct node {
+		aa_box<T> box;  // fat box; the union of the children's for internal nodes
+		Item item {};
+		int parent = null_node;  // next free node while on the free list
+		int child1 = null_node;
+		int child2 = null_node;
+		int height = 0;  // 0 for a leaf, -1 for a free node
+		bool is_leaf() const { return child1 == null_node; }
+	};
+
+	// Margin added to every side of a leaf's fat box. Larger margins reinsert
+	// less often and report more false positives; the default suits bodies
+	// around a meter across. Takes effect as leaves are next (re)inserted.
+	void set_margin(T m) { margin_ = m; }
+	T get_margin() const { return margin_; }
+
+	int insert(const aa_box<T> & tight, const vec3<T> & displacement, const Item & item) {
+		const int leaf = allocate();
+		nodes_[leaf].box = fatten(tight, displacement);
+		nodes_[leaf].item = item;
+		nodes_[leaf].height = 0;
+		insert_leaf(leaf);
+		++leaf_count_;
+		return leaf;
+	}
+
+	void remove(int proxy) {
+		remove_leaf(proxy);
+		release(proxy);
+		--leaf_count_;
+	}
+
+	// Report the item's new tight box. Returns true if the leaf was reinserted:
+	// its tight box escaped the fat box, or the fat box has grown far larger than
+	// the item now needs (a fast body that came to rest) and would only add
+	// false positives.
+	bool move(int proxy, const aa_box<T> & tight, const vec3<T> & displacement) {
+		const aa_box<T> fat = fatten(tight, displacement);
+		if (contains(nodes_[proxy].box, tight)) {
+			const T slack = margin_ * tr::from_int(4);
+			aa_box<T> loose(fat);
+			loose.mins -= vec3<T>(slack, slack, slack);
+			loose.maxs += vec3<T>(slack, slack, slack);
+			if (contains(loose, nodes_[proxy].box))
+				return false;
+		}
+		remove_leaf(proxy);
+		nodes_[proxy].box = fat;
+		insert_leaf(proxy);
+		return true;
+	}
+
+	const aa_box<T> & get_fat_box(int proxy) const { return nodes_[proxy].box; }
+	const Item & get_item(int proxy) const { return nodes_[proxy].item; }
+
+	// Find all items whose fat boxes overlap the given box; a callback returning
+	// false ends the walk, as in bvh::query_aabb.
+	template <typename Callback> void query_aabb(const aa_box<T> & box, Callback && cb) const {
+		if (root_ == null_node)
+			return;
+		int stack[stack_size];
+		int top = 0;
+		stack[top++] = root_;
+		while (top > 0) {
+			const node & n = nodes_[stack[--top]];
+			if (!test_intersection(n.box, box))
+				continue;
+			if (n.is_leaf()) {
+				if (!visit_item(cb, n.item))
+					return;
+			} else {
+				stack[top++] = n.child2;
+				stack[top++] = n.child1;
+			}
+		}
+	}
+
+	// Find items along a ray (segment), as bvh::query_ray: the callback receives
+	// (item, best_t) and lowers best_t on a closer hit to prune the rest.
+	template <typename Callback>
+	void query_ray(const vec3<T> & origin, const vec3<T> & direction, Callback && cb) const {
+		if (root_ == null_node)
+			return;
+		T best_t = tr::one();
+		int stack[stack_size];
+		int top = 0;
+		stack[top++] = root_;
+		while (top > 0) {
+			const node & n = nodes_[stack[--top]];
+			if (!bvh<T, Item>::ray_hits_aabb(origin, direction, n.box, best_t))
+				continue;
+			if (n.is_leaf()) {
+				cb(n.item, best_t);
+			} else {
+				stack[top++] = n.child2;
+				stack[top++] = n.child1;
+			}
+		}
+	}
+
+	// Append leaf items to `out` in depth-first order, which keeps spatially
+	// adjacent items adjacent (see bvh::collect_leaves).
+	template <typename Out> void collect_leaves(Out & out) const {
+		if (root_ == null_node)
+			return;
+		int stack[stack_size];
+		int top = 0;
+		stack[top++] = root_;
+		while (top > 0) {
+			const node & n = nodes_[stack[--top]];
+			if (n.is_leaf()) {
+				out.push_back(n.item);
+			} else {
+				stack[top++] = n.child2;
+				stack[top++] = n.child1;
+			}
+		}
+	}
+
+	void clear() {
+		nodes_.clear();
+		root_ = null_node;
+		free_ = null_node;
+		leaf_count_ = 0;
+	}
+
+	bool empty() const { return root_ == null_node; }
+	int size() const { return leaf_count_; }
+	int get_height() const { return root_ == null_node ? 0 : nodes_[root_].height; }
+	const std::vector<node> & get_nodes() const { return nodes_; }
+
+private:
+	std::vector<node> nodes_;
+	int root_ = null_node;
+	int free_ = null_node;
+	int leaf_count_ = 0;
+	T margin_ = tr::from_milli(100);
+
+	int allocate() {
+		if (free_ == null_node) {
+			nodes_.push_back({});
+			return static_cast<int>(nodes_.size()) - 1;
+		}
+		const int i = free_;
+		free_ = nodes_[i].parent;
+		nodes_[i] = node {};
+		return i;
+	}
+
+	void release(int i) {
+		nodes_[i].parent = free_;
+		nodes_[i].height = -1;
+		free_ = i;
+	}
+
+	aa_box<T> fatten(const aa_box<T> & tight, const vec3<T> & d) const {
+		aa_box<T> fat(tight);
+		fat.mins -= vec3<T>(margin_, margin_, margin_);
+		fat.maxs += vec3<T>(margin_, margin_, margin_);
+		for (int axis = 0; axis < 3; ++axis) {
+			if (d[axis] < T {})
+				fat.mins[axis] += d[axis];
+			else
+				fat.maxs[axis] += d[axis];
+		}
+		return fat;
+	}
+
+	static bool contains(const aa_box<T> & outer, const aa_box<T> & inner) {
+		return outer.mins.x <= inner.mins.x && outer.mins.y <= inner.mins.y && outer.mins.z <= inner.mins.z &&
+		       inner.maxs.x <= outer.maxs.x && inner.maxs.y <= outer.maxs.y && inner.maxs.z <= outer.maxs.z;
+	}
+
+	static aa_box<T> merged(const aa_box<T> & a, const aa_box<T> & b) {
+		aa_box<T> m(a);
+		m.merge(b);
+		return m;
+	}
+
+	void insert_leaf(int leaf) {
+		if (root_ == null_node) {
+			root_ = leaf;
+			nodes_[leaf].parent = null_node;
+			return;
+		}
+
+		// Descend toward the cheapest sibling. Pairing the leaf with a node costs
+		// the area of their union; every ancestor above grows to contain the leaf
+		// as well, which is the inherited cost carried down.
+		// Areas come from bvh_cost (integer for the fixed-point types, so the
+		// tree's shape is the same on every platform), scaled to the root's box
+		// grown by the leaf, which bounds every box compared below.
+		using cost_t = typename bvh_cost<T>::type;
+		const aa_box<T> leaf_box = nodes_[leaf].box;
+		const int shift = bvh_cost<T>::shift_for(merged(nodes_[root_].box, leaf_box), 4);
+		auto area = [shift](const aa_box<T> & b) { return bvh_cost<T>::area(b, shift); };
+		int index = root_;
+		while (!nodes_[index].is_leaf()) {
+			const node & n = nodes_[index];
+			const cost_t combined_area = area(merged(n.box, leaf_box));
+			const cost_t cost = 2 * combined_area;
+			const cost_t inherited = 2 * (combined_area - area(n.box));
+			auto descend_cost = [&](int child) {
+				const node & c = nodes_[child];
+				const cost_t grown = area(merged(c.box, leaf_box));
+				return (c.is_leaf() ? grown : grown - area(c.box)) + inherited;
+			};
+			const cost_t cost1 = descend_cost(n.child1);
+			const cost_t cost2 = descend_cost(n.child2);
+			if (cost < cost1 && cost < cost2)
+				break;
+			index = cost1 < cost2 ? n.child1 : n.child2;
+		}
+		const int sibling = index;
+
+		const int old_parent = nodes_[sibling].parent;
+		const int new_parent = allocate();
+		nodes_[new_parent].parent = old_parent;
+		nodes_[new_parent].box = merged(leaf_box, nodes_[sibling].box);
+		nodes_[new_parent].height = nodes_[sibling].height + 1;
+		nodes_[new_parent].child1 = sibling;
+		nodes_[new_parent].child2 = leaf;
+		nodes_[sibling].parent = new_parent;
+		nodes_[leaf].parent = new_parent;
+		if (old_parent == null_node) {
+			root_ = new_parent;
+		} else if (nodes_[old_parent].child1 == sibling) {
+			nodes_[old_parent].child1 = new_parent;
+		} else {
+			nodes_[old_parent].child2 = new_parent;
+		}
+
+		fix_upwards(new_parent);
+	}
+
+	void remove_leaf(int leaf) {
+		if (leaf == root_) {
+			root_ = null_node;
+			return;
+		}
+		const int parent = nodes_[leaf].parent;
+		const int grand_parent = nodes_[parent].parent;
+		const int sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+
+		nodes_[sibling].parent = grand_parent;
+		release(parent);
+		if (grand_parent == null_node) {
+			root_ = sibling;
+			return;
+		}
+		if (nodes_[grand_parent].child1 == parent)
+			nodes_[grand_parent].child1 = sibling;
+		else
+			nodes_[grand_parent].child2 = sibling;
+		fix_upwards(grand_parent);
+	}
+
+	// Rebalance and refresh box and height from index up to the root.
+	void fix_upwards(int index) {
+		while (index != null_node) {
+			index = balance(index);
+			node & n = nodes_[index];
+			const node & c1 = nodes_[n.child1];
+			const node & c2 = nodes_[n.child2];
+			n.height = 1 + (c1.height > c2.height ? c1.height : c2.height);
+			n.box = merged(c1.box, c2.box);
+			index = n.parent;
+		}
+	}
+
+	// If a's children differ in height by more than one, rotate the taller child
+	// up into a's place and hand a the shorter of that child's children. Returns
+	// the index now at a's position.
+	int balance(int a) {
+		if (nodes_[a].is_leaf() || nodes_[a].height < 2)
+			return a;
+		const int b = nodes_[a].child1;
+		const int c = nodes_[a].child2;
+		const int diff = nodes_[c].height - nodes_[b].height;
+		if (diff > 1)
+			return rotate_up(a, c, b, false);
+		if (diff < -1)
+			return rotate_up(a, b, c, true);
+		return a;
+	}
+
+	// Lift `up` (a child of a) above a. `other` is a's remaining child;
+	// `up_was_child1` says which of a's slots `up` vacates.
+	int rotate_up(int a, int up, int other, bool up_was_child1) {
+		const int f = nodes_[up].child1;
+		const int g = nodes_[up].child2;
+
+		nodes_[up].child1 = a;
+		nodes_[up].parent = nodes_[a].parent;
+		nodes_[a].parent = up;
+		const int p = nodes_[up].parent;
+		if (p == null_node) {
+			root_ = up;
+		} else if (nodes_[p].child1 == a) {
+			nodes_[p].child1 = up;
+		} else {
+			nodes_[p].child2 = up;
+		}
+
+		// The taller grandchild stays under `up`; the shorter one moves to a.
+		const bool f_taller = nodes_[f].height > nodes_[g].height;
+		const int keep = f_taller ? f : g;
+		const int give = f_taller ? g : f;
+		nodes_[up].child2 = keep;
+		if (up_was_child1)
+			nodes_[a].child1 = give;
+		else
+			nodes_[a].child2 = give;
+		nodes_[give].parent = a;
+
+		const int ha = 1 + (nodes_[other].height > nodes_[give].height ? nodes_[other].height : nodes_[give].height);
+		nodes_[a].box = merged(nodes_[other].box, nodes_[give].box);
+		nodes_[a].height = ha;
+		nodes_[up].box = merged(nodes_[a].box, nodes_[keep].box);
+		nodes_[up].height = 1 + (ha > nodes_[keep].height ? ha : nodes_[keep].height);
+		return up;
+	}
+};
+
+} // namespace hop
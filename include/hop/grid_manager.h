@@ -0,0 +1,439 @@
+#pragma once
+
+#include <hop/manager.h>
+#include <hop/math/intersect.h>
+#include <hop/solid.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace hop {
+
+// A hop::manager that hashes solids into a uniform grid, for worlds of many
+// bodies of about the same size (debris, piles of spheres). The grid is
+// loose: each solid is listed once, in the cell holding the center of its
+// world bound, and a query widens its range of cells by half a cell on each
+// side to catch the solids reaching in from the neighbours. The cells live in
+// a table of buckets indexed by a hash of the cell coordinates, so the grid is
+// unbounded and costs memory only for its buckets. Moving a solid costs O(1):
+// nothing at all while its center stays in the same cell, one unlink and one
+// link when it changes cells. Solids wider than a cell (floors, walls) are
+// kept in a separate list that every query tests.
+//
+// Usage:
+//   grid_manager<float> mgr;
+//   mgr.set_cell_size(1.0f);  // ~ the diameter of the common body
+//   mgr.add_solid(static_floor, true);
+//   mgr.add_solid(debris, false);
+//   simulator.set_manager(&mgr);
+//
+// Dynamic solids are re-hashed after their own tick (post_update(s)) and at
+// both ends of the tick, so they are current wherever they were moved from.
+// Static solids are not checked; after moving or reshaping one, call
+// mark_moved().
+//
+// get_iteration_order() lists the solids in Morton order of their cells, so
+// the simulator walks neighbours one after another. The order is re-sorted in
+// pre_update(dt), by insertion sort while bodies move coherently.
+
+template <typename T> class grid_manager : public manager<T> {
+public:
+	using tr = scalar_traits<T>;
+
+	grid_manager() {
+		heads_.assign(1024, none);
+		set_cell_size(tr::one());
+	}
+
+	// Edge length of a cell: the diameter of the common body, or a little
+	// more. Smaller cells push the bodies into the oversize list; larger ones
+	// put many bodies in each cell. Re-hashes every solid.
+	void set_cell_size(T size) {
+		cell_size_ = size;
+		inv_cell_size_ = tr::one() / size;
+		// Coordinates are clamped to ±extent_, which keeps coordinate /
+		// cell_size representable (fixed16 tops out at 32767) and within the 21
+		// bits per axis of the Morton keys. Doubling only while below half the
+		// position limit keeps extent_ itself from overflowing.
+		const T half_max = tr::default_max_position_component() / tr::two();
+		int cap = 1 << 20;
+		if constexpr (is_fixed_scalar_v<T>)
+			cap = std::min(cap, tr::to_int(half_max));
+		T extent = size;
+		for (int limit = 1; limit * 2 <= cap && extent < half_max; limit *= 2)
+			extent = extent + extent;
+		extent_ = extent;
+		rehash(static_cast<int>(heads_.size()));
+	}
+	T get_cell_size() const { return cell_size_; }
+
+	void add_solid(solid<T> * s, bool is_static) {
+		int e;
+		if (free_entries_.empty()) {
+			e = static_cast<int>(entries_.size());
+			entries_.emplace_back();
+		} else {
+			e = free_entries_.back();
+			free_entries_.pop_back();
+		}
+		grid_entry & entry = entries_[e];
+		entry.s = s;
+		entry.is_static = is_static;
+		s->set_manager_proxy(e);
+		++(is_static ? static_count_ : dynamic_count_);
+		// Keep at least two buckets per solid, so few cells share a bucket.
+		if ((static_count_ + dynamic_count_) * 2 > static_cast<int>(heads_.size())) {
+			rehash(static_cast<int>(heads_.size()) * 2);
+		} else {
+			place(e);
+			// The next pre_update's insertion sort moves it into place.
+			order_ids_.push_back(e);
+		}
+	}
+
+	void remove_solid(solid<T> * s) { remove_solids(&s, 1); }
+
+	// Remove count solids: O(1) each, plus one compaction of the iteration
+	// order for the batch.
+	void remove_solids(solid<T> * const solids[], int count) {
+		bool any = false;
+		for (int i = 0; i < count; ++i) {
+			const int e = find_entry(solids[i]);
+			if (e < 0)
+				continue;
+			unplace(e);
+			grid_entry & entry = entries_[e];
+			--(entry.is_static ? static_count_ : dynamic_count_);
+			entry.s->set_manager_proxy(-1);
+			entry.s = nullptr;
+			free_entries_.push_back(e);
+			any = true;
+		}
+		if (!any)
+			return;
+		// The iteration order must not outlive its solids, even until the next
+		// pre_update.
+		order_ids_.erase(std::remove_if(order_ids_.begin(), order_ids_.end(),
+		                                [this](int e) { return entries_[e].s == nullptr; }),
+		                 order_ids_.end());
+		fill_iteration_order();
+	}
+
+	// Re-hash the static solids too at the next pre_update(dt).
+	void mark_moved() { moved_ = true; }
+
+	int get_static_count() const { return static_count_; }
+	int get_dynamic_count() const { return dynamic_count_; }
+	int get_bucket_count() const { return static_cast<int>(heads_.size()); }
+	// Solids kept out of the grid for being wider than a cell.
+	int get_oversize_count() const { return static_cast<int>(oversize_.size()); }
+
+	// ---- manager<T> interface ----
+
+	int find_solids_in_aa_box(const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                          int collide_with_bits = -1) override {
+		return query_solids_in_aa_box(box, solids, max_solids, collide_with_bits);
+	}
+
+	// Read-only, so the simulator may query from several threads at once.
+	int query_solids_in_aa_box(const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                           int collide_with_bits = -1) const override {
+		int count = 0;
+		if (max_solids > 0) {
+			visit_solids(box, collide_with_bits, [&](solid<T> * s) {
+				solids[count++] = s;
+				return count < max_solids;
+			});
+		}
+		return count;
+	}
+
+	bool for_each_solid_in_aa_box(const aa_box<T> & box, const std::function<bool(solid<T> *)> & fn,
+	                              int collide_with_bits = -1) override {
+		visit_solids(box, collide_with_bits, fn);
+		return true;
+	}
+
+	// grid_manager is broad-phase only; see bvh_manager.
+	void trace_segment(collision<T> & result, const segment<T> & seg, int collide_with_bits) override {}
+	void trace_solid(collision<T> & result, solid<T> * s, const segment<T> & seg, int collide_with_bits, T margin) override {}
+
+	void pre_update(T dt) override {
+		update_all();
+		sort_iteration_order();
+	}
+	// The tick may also move solids after their own post_update(s) (a body
+	// pushed out of penetration by a later one), so check them all once more.
+	void post_update(T dt) override { update_all(); }
+	void pre_update(solid<T> * s, T dt) override {}
+	void intra_update(solid<T> * s, T dt) override {}
+	bool collision_response(solid<T> * s, vec3<T> & position, vec3<T> & remainder, collision<T> & col) override {
+		return false;
+	}
+	// Re-hash s as soon as its tick is done, so the solids after it in the
+	// same tick find it where it now is.
+	void post_update(solid<T> * s, T dt) override {
+		const int e = find_entry(s);
+		if (e >= 0 && !entries_[e].is_static)
+			update(e);
+	}
+
+	const std::vector<solid<T> *> * get_iteration_order() const override { return &iteration_order_; }
+
+private:
+	static constexpr int none = -1;
+
+	struct grid_entry {
+		solid<T> * s = nullptr;  // null while the slot is free
+		aa_box<T> bound;         // the solid's world bound when last placed
+		int cell[3] = {};        // cell of the bound's center
+		int prev = none;         // bucket list links
+		int next = none;
+		std::uint64_t key = 0;   // Morton key of cell, for the iteration order
+		bool is_static = false;
+		bool oversize = false;   // in oversize_ rather than a bucket
+	};
+
+	std::vector<grid_entry> entries_;
+	std::vector<int> free_entries_;
+	std::vector<int> heads_;  // first entry of each bucket; size is a power of two
+	std::vector<int> oversize_;
+	std::vector<int> order_ids_;  // entry ids in iteration order
+	std::vector<solid<T> *> iteration_order_;
+	T cell_size_ = tr::one();
+	T inv_cell_size_ = tr::one();
+	T extent_ = tr::one();
+	int static_count_ = 0;
+	int dynamic_count_ = 0;
+	bool moved_ = false;
+	bool order_dirty_ = false;  // rehashed: sort from scratch
+	bool order_moved_ = false;  // keys changed or solids added: insertion sort
+
+	int find_entry(solid<T> * s) const {
+		const int e = s->get_manager_proxy();
+		return e >= 0 && e < static_cast<int>(entries_.size()) && entries_[e].s == s ? e : -1;
+	}
+
+	// fn(s) for each solid overlapping box that collide_with_bits accepts, until
+	// fn returns false: the oversize list, then the box's cells, or every solid
+	// when the box spans more cells than there are solids.
+	template <typename Fn> void visit_solids(const aa_box<T> & box, int collide_with_bits, Fn && fn) const {
+		for (int e : oversize_) {
+			if (report(entries_[e].s, box, collide_with_bits) && !fn(entries_[e].s))
+				return;
+		}
+		// A solid reaching into box has its center within half a cell of it.
+		int lo[3], hi[3];
+		for (int axis = 0; axis < 3; ++axis) {
+			lo[axis] = floor_int(to_cells(box.mins[axis]) - query_pad());
+			hi[axis] = floor_int(to_cells(box.maxs[axis]) + query_pad());
+		}
+		// A box spanning more cells than there are solids is cheaper to answer
+		// by testing every solid.
+		std::int64_t cells = 1;
+		for (int axis = 0; axis < 3; ++axis)
+			cells *= static_cast<std::int64_t>(hi[axis]) - lo[axis] + 1;
+		if (cells > static_cast<std::int64_t>(entries_.size())) {
+			for (const grid_entry & entry : entries_) {
+				if (entry.s && !entry.oversize && report(entry.s, box, collide_with_bits) && !fn(entry.s))
+					return;
+			}
+			return;
+		}
+		for (int z = lo[2]; z <= hi[2]; ++z)
+			for (int y = lo[1]; y <= hi[1]; ++y)
+				for (int x = lo[0]; x <= hi[0]; ++x) {
+					const int c[3] = { x, y, z };
+					for (int e = heads_[bucket_of(c)]; e != none; e = entries_[e].next) {
+						const grid_entry & entry = entries_[e];
+						// Bucket mates from other cells (hash collisions) are met
+						// in their own cell, if it is in range.
+						if (entry.cell[0] != x || entry.cell[1] != y || entry.cell[2] != z ||
+						    !test_intersection(box, entry.bound))
+							continue;
+						if (report(entry.s, box, collide_with_bits) && !fn(entry.s))
+							return;
+					}
+				}
+	}
+
+	bool report(solid<T> * s, const aa_box<T> & box, int collide_with_bits) const {
+		// -1 means "no filter"; see bvh_manager::find_solids_in_aa_box.
+		if (collide_with_bits != -1 && (collide_with_bits & s->get_collision_scope()) == 0)
+			return false;
+		return !s->get_shapes().empty() && test_intersection(box, s->get_world_bound());
+	}
+
+	// v in cell units, clamped to ±extent_. Multiplying by the rounded inverse
+	// may shift a cell boundary by a rounding step, which is harmless: solids
+	// and queries are mapped by this one monotone function.
+	T to_cells(T v) const { return tr::clamp(-extent_, extent_, v) * inv_cell_size_; }
+
+	// to_int truncates for float and floors for fixed point; the correction
+	// makes both floor.
+	static int floor_int(T q) {
+		int i = tr::to_int(q);
+		if (tr::from_int(i) > q)
+			--i;
+		return i;
+	}
+
+	// The widest solid kept in the grid, in cells: a little over one, so that
+	// bodies exactly a cell wide stay in despite rounding.
+	static T max_span() { return tr::from_milli(1030); }
+	// Half of max_span, plus slack for the rounding of a solid's center.
+	static T query_pad() { return tr::from_milli(530); }
+
+	// Teschner et al.'s spatial hash.
+	int bucket_of(const int c[3]) const {
+		const std::uint32_t h = (static_cast<std::uint32_t>(c[0]) * 73856093u) ^
+		                        (static_cast<std::uint32_t>(c[1]) * 19349663u) ^
+		                        (static_cast<std::uint32_t>(c[2]) * 83492791u);
+		return static_cast<int>(h & static_cast<std::uint32_t>(heads_.size() - 1));
+	}
+
+	// Part1By2: spread the low 21 bits of v three apart.
+	static std::uint64_t spread_bits(std::uint64_t v) {
+		v &= 0x1fffff;
+		v = (v | v << 32) & 0x1f00000000ffffull;
+		v = (v | v << 16) & 0x1f0000ff0000ffull;
+		v = (v | v << 8) & 0x100f00f00f00f00full;
+		v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+		v = (v | v << 2) & 0x1249249249249249ull;
+		return v;
+	}
+
+	static std::uint64_t morton_key(const int c[3]) {
+		std::uint64_t key = 0;
+		for (int axis = 0; axis < 3; ++axis) {
+			const std::uint64_t u = std::min<std::uint64_t>(static_cast<std::uint64_t>(c[axis] + (1 << 20)), 0x1fffff);
+			key |= spread_bits(u) << axis;
+		}
+		return key;
+	}
+
+	// The cell of s's center, or false if s is wider than max_span on some axis.
+	bool cell_of(const solid<T> * s, int cell[3]) const {
+		const aa_box<T> & bound = s->get_world_bound();
+		for (int axis = 0; axis < 3; ++axis) {
+			const T a = to_cells(bound.mins[axis]);
+			const T b = to_cells(bound.maxs[axis]);
+			if (b - a > max_span())
+				return false;
+			cell[axis] = floor_int(a + (b - a) * tr::half());
+		}
+		return true;
+	}
+
+	void place(int e) {
+		grid_entry & entry = entries_[e];
+		entry.bound = entry.s->get_world_bound();
+		entry.oversize = !cell_of(entry.s, entry.cell);
+		if (entry.oversize) {
+			std::fill(entry.cell, entry.cell + 3, 0);
+			oversize_.push_back(e);
+		} else {
+			int & head = heads_[bucket_of(entry.cell)];
+			entry.prev = none;
+			entry.next = head;
+			if (head != none)
+				entries_[head].prev = e;
+			head = e;
+		}
+		entry.key = morton_key(entry.cell);
+		order_moved_ = true;
+	}
+
+	void unplace(int e) {
+		grid_entry & entry = entries_[e];
+		if (entry.oversize) {
+			auto it = std::find(oversize_.begin(), oversize_.end(), e);
+			*it = oversize_.back();
+			oversize_.pop_back();
+			return;
+		}
+		if (entry.prev != none)
+			entries_[entry.prev].next = entry.next;
+		else
+			heads_[bucket_of(entry.cell)] = entry.next;
+		if (entry.next != none)
+			entries_[entry.next].prev = entry.prev;
+		entry.prev = entry.next = none;
+	}
+
+	// Re-hash entry e if its center changed cells. The copy of its bound is
+	// refreshed either way; queries test it before touching the solid.
+	void update(int e) {
+		grid_entry & entry = entries_[e];
+		const aa_box<T> & bound = entry.s->get_world_bound();
+		if (bound == entry.bound)
+			return;
+		entry.bound = bound;
+		int cell[3];
+		if (cell_of(entry.s, cell) ? !entry.oversize && std::equal(cell, cell + 3, entry.cell) : entry.oversize)
+			return;
+		unplace(e);
+		place(e);
+	}
+
+	void update_all() {
+		for (int e = 0; e < static_cast<int>(entries_.size()); ++e)
+			if (entries_[e].s && (moved_ || !entries_[e].is_static))
+				update(e);
+		moved_ = false;
+	}
+
+	void rehash(int bucket_count) {
+		heads_.assign(bucket_count, none);
+		oversize_.clear();
+		for (int e = 0; e < static_cast<int>(entries_.size()); ++e)
+			if (entries_[e].s)
+				place(e);
+		order_dirty_ = true;
+	}
+
+	// Bring the iteration order up to date with the entries' keys: a full sort
+	// after a rehash, else an insertion sort, which costs O(n) plus one step
+	// per pair of solids that swapped places (O(n) per added solid).
+	void sort_iteration_order() {
+		auto before = [this](int a, int b) {
+			return entries_[a].key < entries_[b].key || (entries_[a].key == entries_[b].key && a < b);
+		};
+		if (order_dirty_) {
+			order_ids_.clear();
+			for (int e = 0; e < static_cast<int>(entries_.size()); ++e)
+				if (entries_[e].s)
+					order_ids_.push_back(e);
+			std::sort(order_ids_.begin(), order_ids_.end(), before);
+			order_dirty_ = order_moved_ = false;
+			fill_iteration_order();
+			return;
+		}
+		if (!order_moved_)
+			return;
+		order_moved_ = false;
+		bool changed = iteration_order_.size() != order_ids_.size();
+		for (int i = 1; i < static_cast<int>(order_ids_.size()); ++i) {
+			const int e = order_ids_[i];
+			int j = i;
+			for (; j > 0 && before(e, order_ids_[j - 1]); --j)
+				order_ids_[j] = order_ids_[j - 1];
+			if (j != i) {
+				order_ids_[j] = e;
+				changed = true;
+			}
+		}
+		if (changed)
+			fill_iteration_order();
+	}
+
+	void fill_iteration_order() {
+		iteration_order_.clear();
+		for (int e : order_ids_)
+			iteration_order_.push_back(entries_[e].s);
+	}
+};
+
+} // namespace hop
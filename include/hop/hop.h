@@ -26,8 +26,15 @@
 #include <hop/collide.h>
 #include <hop/collision.h>
 #include <hop/constraint.h>
+#include <hop/dynamic_tree.h>
+#include <hop/grid_manager.h>
 #include <hop/manager.h>
+#include <hop/pool.h>
+#include <hop/sap_manager.h>
 #include <hop/shape.h>
 #include <hop/simulator.h>
 #include <hop/solid.h>
+#include <hop/task_scheduler.h>
+#include <hop/thread_pool.h>
 #include <hop/traceable.h>
+#include <hop/wide_bvh.h>
@@ -3,6 +3,7 @@
 #include <hop/collision.h>
 #include <hop/math/segment.h>
 
+#include <functional>
 #include <vector>
 
 namespace hop {
@@ -15,7 +16,8 @@ template <typename T> class solid;
 //
 //   1. Broad-phase acceleration. Override find_solids_in_aa_box to replace
 //      the simulator's linear scan with a BVH, octree, BSP, etc. Return -1
-//      to fall through to the default scan. See bvh_manager.
+//      to fall through to the default scan. See bvh_manager, and sap_manager
+//      for one that also overrides find_solids_near.
 //
 //   2. External / custom geometry. Override trace_segment and trace_solid
 //      to merge in collisions against geometry that is NOT in the simulator's
@@ -38,6 +40,10 @@ template <typename T> class solid;
 //      collision_response methods let a host engine observe or override
 //      per-tick and per-solid behavior (e.g. routing collision response
 //      through an engine's character controller).
+//
+// query_solids_in_aa_box, query_segment and query_solid are read-only versions
+// of the broad-phase and geometry hooks, for queries made from several threads
+// at once between ticks (simulator::query_scratch).
 template <typename T> class manager {
 public:
 	virtual ~manager() = default;
@@ -50,14 +56,90 @@ public:
 	// drained first — they can crowd out the moving bodies the caller actually wanted.
 	virtual int find_solids_in_aa_box(const aa_box<T> & box, solid<T> * solids[], int max_solids,
 	                                  int collide_with_bits = -1) = 0;
+
+	// Every solid find_solids_in_aa_box would report, with no buffer to size or
+	// overflow: fn(s) for each in turn until fn returns false, which also ends
+	// the manager's search. Returns false when the manager has no broad phase of
+	// its own (find_solids_in_aa_box's -1), leaving the caller to scan. The
+	// default fills a buffer, doubling it until the list fits; the bundled
+	// managers walk their structures directly.
+	virtual bool for_each_solid_in_aa_box(const aa_box<T> & box, const std::function<bool(solid<T> *)> & fn,
+	                                      int collide_with_bits = -1) {
+		std::vector<solid<T> *> found(64);
+		int count;
+		while ((count = find_solids_in_aa_box(box, found.data(), static_cast<int>(found.size()), collide_with_bits)) ==
+		       static_cast<int>(found.size()))
+			found.resize(found.size() * 2);
+		if (count < 0)
+			return false;
+		for (int i = 0; i < count; ++i)
+			if (!fn(found[i]))
+				break;
+		return true;
+	}
+
+	// Read-only find_solids_in_aa_box, for the simulator's reentrant queries
+	// (simulator::query_scratch): the same solids, but callable from several
+	// threads at once between ticks, so it must not rebuild, refit or otherwise
+	// write — a stale structure is answered around rather than brought up to
+	// date. -1 (the default) makes the simulator scan its own list.
+	virtual int query_solids_in_aa_box(const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                                   int collide_with_bits = -1) const {
+		return -1;
+	}
+
+	// The broad phase for s's own motion this tick: box bounds everywhere s can
+	// reach. Must report every solid the manager owns whose bound overlaps box;
+	// s itself may be left out. The default runs find_solids_in_aa_box(box). A
+	// manager that keeps each solid's overlapping partners (sap_manager) answers
+	// from those instead of searching.
+	virtual int find_solids_near(solid<T> * s, const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                             int collide_with_bits = -1) {
+		return find_solids_in_aa_box(box, solids, max_solids, collide_with_bits);
+	}
+
+	// The broad phase for tracing seg: must report every solid the manager owns
+	// whose bound seg passes within pad of, and may report any others its box
+	// query would. The default runs find_solids_in_aa_box on seg's box grown by
+	// pad. A manager that can walk the segment itself (bvh_manager's wide static
+	// tree) hands on fewer solids for a long diagonal trace.
+	virtual int find_solids_on_segment(const segment<T> & seg, T pad, solid<T> * solids[], int max_solids,
+	                                   int collide_with_bits = -1) {
+		aa_box<T> box(seg.origin, seg.origin);
+		box.merge(seg.get_end_point());
+		box.mins -= vec3<T>(pad, pad, pad);
+		box.maxs += vec3<T>(pad, pad, pad);
+		return find_solids_in_aa_box(box, solids, max_solids, collide_with_bits);
+	}
 	virtual void trace_segment(collision<T> & result, const segment<T> & seg, int collide_with_bits) = 0;
+	// Whether trace_segment would report a hit (result.time below one), for the
+	// simulator's any-hit query. The default traces and checks; geometry that can
+	// stop at its first hit should override.
+	virtual bool trace_segment_any(const segment<T> & seg, int collide_with_bits) {
+		collision<T> col;
+		col.time = scalar_traits<T>::one();
+		trace_segment(col, seg, collide_with_bits);
+		return col.time < scalar_traits<T>::one();
+	}
 	virtual void trace_solid(collision<T> & result, solid<T> * s, const segment<T> & seg, int collide_with_bits, T margin) = 0;
+	// Read-only trace_segment and trace_solid for the reentrant queries, under
+	// the same rules as query_solids_in_aa_box. The defaults add nothing; a
+	// manager with geometry of its own overrides them too.
+	virtual void query_segment(collision<T> & result, const segment<T> & seg, int collide_with_bits) const {}
+	virtual void query_solid(collision<T> & result, solid<T> * s, const segment<T> & seg, int collide_with_bits,
+	                         T margin) const {}
 	virtual void pre_update(T dt) = 0;
 	virtual void post_update(T dt) = 0;
 	virtual void pre_update(solid<T> * s, T dt) = 0;
 	virtual void intra_update(solid<T> * s, T dt) = 0;
 	virtual bool collision_response(solid<T> * s, vec3<T> & position, vec3<T> & remainder, collision<T> & col) = 0;
 	virtual void post_update(solid<T> * s, T dt) = 0;
+	// Optional: s woke (solid_activated) or fell asleep (solid_deactivated). The
+	// simulator calls these serially, for solids it holds, as the body changes
+	// state — which may be mid-tick. A manager that keeps sleeping bodies apart
+	// (bvh_manager::set_sleeping_tree) moves them here; the rest ignore them.
+	virtual void solid_activated(solid<T> * s) {}
+	virtual void solid_deactivated(solid<T> * s) {}
 
 	// Optional: a per-tick iteration order for the simulator's update loop.
 	// Returning non-null commits to including every solid the simulator should
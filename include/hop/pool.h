@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hop {
+
+// A reference to an object_pool entry: the slot index plus the generation the
+// slot had when the object was handed out. Releasing the object bumps the
+// slot's generation, so a handle that outlives its object reads back as stale
+// (object_pool::get returns null) instead of aliasing whatever reuses the slot.
+struct pool_handle {
+	std::uint32_t index = ~std::uint32_t {};
+	std::uint32_t generation = 0;
+
+	bool operator==(const pool_handle & h) const { return index == h.index && generation == h.generation; }
+	bool operator!=(const pool_handle & h) const { return !(*this == h); }
+};
+
+// Free-list pool for the scene objects a game spawns and despawns in bulk
+// (debris solids, their constraints). Objects live in fixed-size blocks that are
+// never moved or freed before the pool, so their addresses stay valid; a
+// released slot goes on a free list and the next create() reuses it. Spawning
+// and despawning are O(1) and allocate only when the pool grows by a block.
+//
+// An object is constructed once, when its block is allocated, and recycled
+// rather than destroyed: release() calls its reset(), so U must be
+// default-constructible and provide reset() restoring the default state (solid
+// and constraint do). Recycling keeps the capacity of the object's own vectors
+// (a solid's shape list), so a respawn does not reallocate those either.
+//
+// get_ptr() wraps an entry in a non-owning shared_ptr for the hop APIs that
+// take one. It has no control block, so copying it costs no allocation and no
+// atomic reference counting; the pool alone decides the object's lifetime.
+template <typename U> class object_pool {
+public:
+	static constexpr int block_size = 64;
+
+	object_pool() = default;
+	object_pool(const object_pool &) = delete;
+	object_pool & operator=(const object_pool &) = delete;
+
+	pool_handle create() {
+		if (free_ == none)
+			grow();
+		const std::uint32_t i = free_;
+		slot & s = at(i);
+		free_ = s.next_free;
+		s.next_free = none;
+		s.live = true;
+		++live_count_;
+		return pool_handle { i, s.generation };
+	}
+
+	// Reset the object and recycle its slot. Every handle to it goes stale.
+	void release(pool_handle h) {
+		slot * s = find(h);
+		if (!s)
+			return;
+		s->object.reset();
+		s->live = false;
+		++s->generation;
+		s->next_free = free_;
+		free_ = h.index;
+		--live_count_;
+	}
+
+	// The object h refers to, or null if h is stale or was never issued.
+	U * get(pool_handle h) const {
+		slot * s = find(h);
+		return s ? &s->object : nullptr;
+	}
+
+	std::shared_ptr<U> get_ptr(pool_handle h) const {
+		return std::shared_ptr<U>(std::shared_ptr<U> {}, get(h));
+	}
+
+	int size() const { return live_count_; }
+	int capacity() const { return static_cast<int>(blocks_.size()) * block_size; }
+
+private:
+	static constexpr std::uint32_t none = ~std::uint32_t {};
+
+	struct slot {
+		U object;
+		std::uint32_t generation = 0;
+		std::uint32_t next_free = none;
+		bool live = false;
+	};
+
+	slot & at(std::uint32_t i) const { return blocks_[i / block_size][i % block_size]; }
+
+	slot * find(pool_handle h) const {
+		if (h.index >= static_cast<std::uint32_t>(capacity()))
+			return nullptr;
+		slot & s = at(h.index);
+		return s.live && s.generation == h.generation ? &s : nullptr;
+	}
+
+	// Add a block and thread its slots onto the free list in index order.
+	void grow() {
+		const std::uint32_t first = static_cast<std::uint32_t>(capacity());
+		blocks_.emplace_back(new slot[block_size]);
+		for (int k = block_size - 1; k >= 0; --k) {
+			blocks_.back()[k].next_free = free_;
+			free_ = first + static_cast<std::uint32_t>(k);
+		}
+	}
+
+	std::vector<std::unique_ptr<slot[]>> blocks_;
+	std::uint32_t free_ = none;
+	int live_count_ = 0;
+};
+
+} // namespace hop
@@ -0,0 +1,421 @@
+#pragma once
+
+#include <hop/manager.h>
+#include <hop/math/intersect.h>
+#include <hop/solid.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace hop {
+
+// A hop::manager that keeps solids in an incremental sweep and prune (the
+// scheme of Bullet's btAxisSweep3). Each solid owns a fat box — its world
+// bound grown by a margin plus its motion over a tick — whose six endpoints
+// sit in three per-axis arrays kept sorted. When a solid's fat box has to
+// change, its endpoints are moved by insertion sort, and every endpoint they
+// pass is a pair of boxes starting or ceasing to overlap on that axis. The
+// set of overlapping pairs is thus persistent: it changes only when endpoints
+// cross, so in a coherent scene (most bodies move a little per tick) a tick
+// costs O(n) containment checks plus a few short sifts: a body moving within
+// its margin touches nothing at all.
+//
+// Each solid's partners are kept with it, so the simulator's per-solid broad
+// phase (find_solids_near) reads them instead of searching: the query box of a
+// solid's sweep lies inside its fat box as long as its motion stays within the
+// margin. A query outside that, and find_solids_in_aa_box for an arbitrary
+// box, fall back to a scan of the flat box array. Pairs between two static
+// solids are never tracked.
+//
+// Usage:
+//   sap_manager<float> mgr;
+//   mgr.add_solid(static_wall, true);
+//   mgr.add_solid(player, false);
+//   simulator.set_manager(&mgr);
+//
+// pre_update(dt) sweeps in the solids added since the last tick and brings
+// every dynamic solid's box up to date, wherever the solid was moved from.
+// Static solids are not checked; after moving or reshaping one, call
+// mark_moved().
+
+template <typename T> class sap_manager : public manager<T> {
+public:
+	using tr = scalar_traits<T>;
+
+	void add_solid(solid<T> * s, bool is_static) {
+		int b;
+		if (free_boxes_.empty()) {
+			b = static_cast<int>(boxes_.size());
+			boxes_.emplace_back();
+		} else {
+			b = free_boxes_.back();
+			free_boxes_.pop_back();
+		}
+		sap_box & box = boxes_[b];
+		box.s = s;
+		box.is_static = is_static;
+		box.swept = false;
+		box.partners.clear();
+		s->set_manager_proxy(b);
+		pending_.push_back(b);
+		++(is_static ? static_count_ : dynamic_count_);
+	}
+
+	void remove_solid(solid<T> * s) { remove_solids(&s, 1); }
+
+	// Remove count solids with one compaction of each axis, O(n + pairs of the
+	// removed solids) for the whole batch.
+	void remove_solids(solid<T> * const solids[], int count) {
+		bool any_swept = false;
+		for (int i = 0; i < count; ++i) {
+			const int b = find_box(solids[i]);
+			if (b < 0)
+				continue;
+			sap_box & box = boxes_[b];
+			for (int p : box.partners)
+				erase_partner(boxes_[p], b);
+			pair_count_ -= static_cast<int>(box.partners.size());
+			box.partners.clear();
+			if (box.swept)
+				any_swept = true;
+			else
+				pending_.erase(std::find(pending_.begin(), pending_.end(), b));
+			--(box.is_static ? static_count_ : dynamic_count_);
+			box.s->set_manager_proxy(-1);
+			box.s = nullptr;
+			box.swept = false;
+			free_boxes_.push_back(b);
+		}
+		if (!any_swept)
+			return;
+		for (auto & axis : axes_) {
+			axis.erase(std::remove_if(axis.begin(), axis.end(),
+			                          [this](const endpoint & e) { return boxes_[e.box()].s == nullptr; }),
+			           axis.end());
+		}
+		reindex();
+	}
+
+	// Margin added around each dynamic solid's motion in its fat box. Larger
+	// margins move endpoints less often and track more false pairs.
+	void set_margin(T m) { margin_ = m; }
+	T get_margin() const { return margin_; }
+
+	// Re-check the static solids' boxes at the next pre_update(dt) too.
+	void mark_moved() { moved_ = true; }
+
+	int get_static_count() const { return static_count_; }
+	int get_dynamic_count() const { return dynamic_count_; }
+
+	// The persistent pair set: solids whose fat boxes overlap, at least one of
+	// them dynamic. fn(a, b) is called once per pair.
+	int get_pair_count() const { return pair_count_; }
+	template <typename Fn> void for_each_pair(Fn && fn) const {
+		for (int b = 0; b < static_cast<int>(boxes_.size()); ++b) {
+			for (int p : boxes_[b].partners)
+				if (p > b)
+					fn(boxes_[b].s, boxes_[p].s);
+		}
+	}
+
+	// ---- manager<T> interface ----
+
+	int find_solids_in_aa_box(const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                          int collide_with_bits = -1) override {
+		return query_solids_in_aa_box(box, solids, max_solids, collide_with_bits);
+	}
+
+	// O(n) in the solids held: both box queries scan every box, unswept ones
+	// included. The sorted axes cannot bound the scan, since a fat box holds its
+	// solid's bound only as of the last pre_update, and these queries must also
+	// find solids moved or added since. Only find_solids_near uses the pair set.
+	int query_solids_in_aa_box(const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                           int collide_with_bits = -1) const override {
+		int count = 0;
+		for (const auto & b : boxes_) {
+			if (count >= max_solids)
+				break;
+			if (b.s && report(b.s, box, collide_with_bits))
+				solids[count++] = b.s;
+		}
+		return count;
+	}
+
+	bool for_each_solid_in_aa_box(const aa_box<T> & box, const std::function<bool(solid<T> *)> & fn,
+	                              int collide_with_bits = -1) override {
+		for (const auto & b : boxes_) {
+			if (b.s && report(b.s, box, collide_with_bits) && !fn(b.s))
+				break;
+		}
+		return true;
+	}
+
+	int find_solids_near(solid<T> * s, const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                     int collide_with_bits = -1) override {
+		const int b = find_box(s);
+		if (b < 0 || !boxes_[b].swept || !pending_.empty() || !contains(boxes_[b].fat, box))
+			return find_solids_in_aa_box(box, solids, max_solids, collide_with_bits);
+		// Every solid overlapping box overlaps s's fat box, so it is a partner.
+		int count = 0;
+		for (int p : boxes_[b].partners) {
+			if (count >= max_solids)
+				break;
+			if (report(boxes_[p].s, box, collide_with_bits))
+				solids[count++] = boxes_[p].s;
+		}
+		return count;
+	}
+
+	// sap_manager is broad-phase only; see bvh_manager.
+	void trace_segment(collision<T> & result, const segment<T> & seg, int collide_with_bits) override {}
+	void trace_solid(collision<T> & result, solid<T> * s, const segment<T> & seg, int collide_with_bits, T margin) override {}
+
+	// Runs before the tick's queries, which then only read. The velocities are
+	// those the last tick's solve left, so the fat boxes anticipate this tick's
+	// motion.
+	void pre_update(T dt) override {
+		if (!pending_.empty())
+			sweep_in_pending();
+		for (int b = 0; b < static_cast<int>(boxes_.size()); ++b)
+			if (boxes_[b].s && boxes_[b].swept && (moved_ || !boxes_[b].is_static))
+				follow(b, dt);
+		moved_ = false;
+	}
+	void post_update(T dt) override {}
+	void pre_update(solid<T> * s, T dt) override {}
+	void intra_update(solid<T> * s, T dt) override {}
+	bool collision_response(solid<T> * s, vec3<T> & position, vec3<T> & remainder, collision<T> & col) override {
+		return false;
+	}
+	void post_update(solid<T> * s, T dt) override {}
+
+private:
+	// One end of a box on one axis. `data` packs the box index and whether this
+	// is its max end; at equal values min ends sort first, so boxes that touch
+	// count as overlapping, as test_intersection has it.
+	struct endpoint {
+		T value;
+		int data;
+		int box() const { return data >> 1; }
+		bool is_max() const { return (data & 1) != 0; }
+		bool operator<(const endpoint & e) const {
+			return value < e.value || (value == e.value && !is_max() && e.is_max());
+		}
+	};
+
+	struct sap_box {
+		aa_box<T> fat;
+		solid<T> * s = nullptr;  // null while the slot is free
+		int min[3] = { -1, -1, -1 };
+		int max[3] = { -1, -1, -1 };
+		bool is_static = false;
+		bool swept = false;  // endpoints are in axes_
+		std::vector<int> partners;
+	};
+
+	std::vector<sap_box> boxes_;
+	std::vector<int> free_boxes_;
+	std::vector<int> pending_;  // added, not yet swept in
+	std::vector<endpoint> axes_[3];
+	std::vector<int> active_;  // sweep_in_pending scratch
+	T margin_ = tr::from_milli(100);
+	int pair_count_ = 0;
+	int static_count_ = 0;
+	int dynamic_count_ = 0;
+	bool moved_ = false;
+
+	int find_box(solid<T> * s) const {
+		const int b = s->get_manager_proxy();
+		return b >= 0 && b < static_cast<int>(boxes_.size()) && boxes_[b].s == s ? b : -1;
+	}
+
+	bool report(solid<T> * s, const aa_box<T> & box, int collide_with_bits) const {
+		// -1 means "no filter"; see bvh_manager::find_solids_in_aa_box.
+		if (collide_with_bits != -1 && (collide_with_bits & s->get_collision_scope()) == 0)
+			return false;
+		return !s->get_shapes().empty() && test_intersection(box, s->get_world_bound());
+	}
+
+	static bool contains(const aa_box<T> & outer, const aa_box<T> & inner) {
+		return outer.mins.x <= inner.mins.x && outer.mins.y <= inner.mins.y && outer.mins.z <= inner.mins.z &&
+		       inner.maxs.x <= outer.maxs.x && inner.maxs.y <= outer.maxs.y && inner.maxs.z <= outer.maxs.z;
+	}
+
+	static aa_box<T> grown(const aa_box<T> & b, T r) {
+		aa_box<T> g(b);
+		g.mins -= vec3<T>(r, r, r);
+		g.maxs += vec3<T>(r, r, r);
+		return g;
+	}
+
+	// How far past its bound a solid's sweep box reaches along any axis. The
+	// sweep_slide box is shifted by the motion and grown by its length, so twice
+	// the motion's L1 norm covers it (and the speculative box) without a sqrt.
+	static T reach(const solid<T> * s, T dt) {
+		const vec3<T> & v = s->get_velocity();
+		return (tr::abs(v.x) + tr::abs(v.y) + tr::abs(v.z)) * dt * tr::two();
+	}
+
+	// Keep box b's fat box around its solid, one axis at a time. An axis is left
+	// alone while it covers the solid's reach for the coming tick and is not much
+	// wider than that (a fast body that stopped); otherwise it is reset to the
+	// reach plus the margin. Per axis, so a body that starts moving across a
+	// floor does not re-fatten its height and sift past every other body resting
+	// at the same height.
+	void follow(int b, T dt) {
+		sap_box & box = boxes_[b];
+		const T r = box.is_static ? T {} : reach(box.s, dt);
+		const T m = box.is_static ? T {} : margin_;
+		const aa_box<T> & bound = box.s->get_world_bound();
+		aa_box<T> fat = box.fat;
+		bool changed = false;
+		for (int axis = 0; axis < 3; ++axis) {
+			const T lo = bound.mins[axis] - r;
+			const T hi = bound.maxs[axis] + r;
+			const T slack = margin_ * tr::from_int(4);
+			if (fat.mins[axis] <= lo && hi <= fat.maxs[axis] && lo - slack <= fat.mins[axis] && fat.maxs[axis] <= hi + slack)
+				continue;
+			fat.mins[axis] = lo - m;
+			fat.maxs[axis] = hi + m;
+			changed = true;
+		}
+		if (changed)
+			move(b, fat);
+	}
+
+	bool add_pair(int a, int b) {
+		if (boxes_[a].is_static && boxes_[b].is_static)
+			return false;
+		auto & pa = boxes_[a].partners;
+		if (!test_intersection(boxes_[a].fat, boxes_[b].fat) || std::find(pa.begin(), pa.end(), b) != pa.end())
+			return false;
+		pa.push_back(b);
+		boxes_[b].partners.push_back(a);
+		++pair_count_;
+		return true;
+	}
+
+	static bool erase_partner(sap_box & box, int p) {
+		auto it = std::find(box.partners.begin(), box.partners.end(), p);
+		if (it == box.partners.end())
+			return false;
+		*it = box.partners.back();
+		box.partners.pop_back();
+		return true;
+	}
+
+	void remove_pair(int a, int b) {
+		if (erase_partner(boxes_[a], b)) {
+			erase_partner(boxes_[b], a);
+			--pair_count_;
+		}
+	}
+
+	void set_index(const endpoint & e, int axis, int i) {
+		if (e.is_max())
+			boxes_[e.box()].max[axis] = i;
+		else
+			boxes_[e.box()].min[axis] = i;
+	}
+
+	// Move box b to a new fat box. On each axis, ends that grow outward are
+	// sifted first (max up, min down) and ends that shrink after, so each end
+	// only passes other boxes' ends. Passing one means the two boxes start or
+	// stop overlapping on that axis: a start adds the pair if the boxes now
+	// overlap on every axis, a stop removes it.
+	void move(int b, const aa_box<T> & fat) {
+		boxes_[b].fat = fat;
+		for (int axis = 0; axis < 3; ++axis) {
+			std::vector<endpoint> & ep = axes_[axis];
+			const int n = static_cast<int>(ep.size());
+			auto sift_up = [&](int i, bool is_max) {
+				while (i + 1 < n && ep[i + 1] < ep[i]) {
+					const int o = ep[i + 1].box();
+					if (is_max != ep[i + 1].is_max()) {
+						if (is_max)
+							add_pair(b, o);
+						else
+							remove_pair(b, o);
+					}
+					std::swap(ep[i], ep[i + 1]);
+					set_index(ep[i], axis, i);
+					++i;
+				}
+				set_index(ep[i], axis, i);
+			};
+			auto sift_down = [&](int i, bool is_max) {
+				while (i > 0 && ep[i] < ep[i - 1]) {
+					const int o = ep[i - 1].box();
+					if (is_max != ep[i - 1].is_max()) {
+						if (is_max)
+							remove_pair(b, o);
+						else
+							add_pair(b, o);
+					}
+					std::swap(ep[i], ep[i - 1]);
+					set_index(ep[i], axis, i);
+					--i;
+				}
+				set_index(ep[i], axis, i);
+			};
+			ep[boxes_[b].max[axis]].value = fat.maxs[axis];
+			ep[boxes_[b].min[axis]].value = fat.mins[axis];
+			sift_up(boxes_[b].max[axis], true);
+			sift_down(boxes_[b].min[axis], false);
+			sift_up(boxes_[b].min[axis], false);
+			sift_down(boxes_[b].max[axis], true);
+		}
+	}
+
+	void reindex() {
+		for (int axis = 0; axis < 3; ++axis)
+			for (int i = 0; i < static_cast<int>(axes_[axis].size()); ++i)
+				set_index(axes_[axis][i], axis, i);
+	}
+
+	// Merge the pending boxes' endpoints into the sorted axes, then find their
+	// pairs with one sweep along x: O(n + k log k) for k new boxes, where
+	// inserting them one at a time would sift each across the whole axis.
+	void sweep_in_pending() {
+		for (int b : pending_) {
+			sap_box & box = boxes_[b];
+			box.fat = grown(box.s->get_world_bound(), box.is_static ? T {} : margin_);
+			box.swept = true;
+		}
+		for (int axis = 0; axis < 3; ++axis) {
+			std::vector<endpoint> & ep = axes_[axis];
+			const auto old_end = static_cast<std::ptrdiff_t>(ep.size());
+			for (int b : pending_) {
+				ep.push_back({ boxes_[b].fat.mins[axis], b << 1 });
+				ep.push_back({ boxes_[b].fat.maxs[axis], (b << 1) | 1 });
+			}
+			std::sort(ep.begin() + old_end, ep.end());
+			std::inplace_merge(ep.begin(), ep.begin() + old_end, ep.end());
+		}
+		reindex();
+
+		// A new box pairs with every box open on x when it opens, and with every
+		// new box that opens while it is open.
+		std::vector<char> is_new(boxes_.size(), 0);
+		for (int b : pending_)
+			is_new[b] = 1;
+		pending_.clear();
+		active_.clear();
+		for (const endpoint & e : axes_[0]) {
+			const int b = e.box();
+			if (e.is_max()) {
+				auto it = std::find(active_.begin(), active_.end(), b);
+				*it = active_.back();
+				active_.pop_back();
+				continue;
+			}
+			for (int a : active_)
+				if (is_new[a] || is_new[b])
+					add_pair(a, b);
+			active_.push_back(b);
+		}
+	}
+};
+
+} // namespace hop
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <hop/collide.h>
 #include <hop/collision.h>
 #include <hop/constraint.h>
@@ -10,7 +13,13 @@
 #include <hop/math/intersect.h>
 #include <hop/math/support.h>
 #include <hop/math/project.h>
+#include <hop/pool.h>
 #include <hop/solid.h>
+#include <hop/task_scheduler.h>
+#include <hop/thread_pool.h>
+#include <memory>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace hop {
@@ -37,7 +46,21 @@ public:
 		static_world_.solve_id_ = 0;
 	}
 
-	~simulator() = default;
+	// A solid can outlive its simulator: detach each, as remove_solid would.
+	// Every sleep ring and contact cache is dropped, since either may point at
+	// pooled solids freed with solid_pool_.
+	~simulator() {
+		for (auto & s : solids_) {
+			s->sleep_next_ = s->sleep_prev_ = nullptr;
+			s->touch_count_ = 0;
+			for (auto & slot : s->touches_)
+				slot = typename solid<T>::touch {};
+			s->touched_by_.clear();
+			s->solids_index_ = -1;
+			s->awake_index_ = -1;
+			s->internal_set_simulator(nullptr);
+		}
+	}
 
 	// Epsilon
 	void set_epsilon(T epsilon) {
@@ -166,55 +189,222 @@ public:
 	void set_position_iterations(int n) { spec_pos_iters_ = n < 0 ? 0 : n; }
 	int get_position_iterations() const { return spec_pos_iters_; }
 
+	// Parallel Pass A (opt-in). The default Pass A walks the bodies one at a time,
+	// and a body may wake, push, or read a partner that has already moved this tick,
+	// so its result depends on the walk order and it cannot be split across threads.
+	// The split Pass A removes that dependence for speculative bodies: every
+	// unconstrained speculative body first integrates, then every one discovers
+	// contacts against the integrated frame-start state, and the side effects a
+	// discovery has on other bodies (partner wakes, collision records, manager
+	// relocations) are buffered and applied afterwards in iteration order. Both
+	// phases are split across set_thread_count() threads. sweep_slide bodies and
+	// constrained bodies touch their partners' state directly, so they still run
+	// serially, ahead of the split phases.
+	//
+	// The split pass is a different (equally valid) order from the default pass, so
+	// enabling it changes results slightly; the thread count does not. With it on,
+	// the manager's per-solid hooks (pre_update(s), intra_update, collision_response)
+	// and its queries (find_solids_in_aa_box, trace_solid) may be called concurrently
+	// for different solids, and each call may only modify the solid it was given.
+	void set_parallel_pass_a(bool p) { parallel_pass_a_ = p; }
+	bool get_parallel_pass_a() const { return parallel_pass_a_; }
+	// Parts each parallel phase is split into, and threads the built-in pool may
+	// use (at most one per core), including the calling thread. 1 (the
+	// default) runs everything on the caller. The thread count never changes
+	// results: every parallel phase splits work into parts that share no written
+	// state, and merges what they defer in iteration order, so a fixed-point
+	// simulator steps bit-identically for any count (tests/test_determinism.cpp).
+	void set_thread_count(int n) {
+		thread_count_ = n > 1 ? n : 1;
+		pool_.reset();  // the built-in pool is resized on next use
+	}
+	int get_thread_count() const { return thread_count_; }
+	// Where the parallel phases run. By default the simulator starts its own
+	// thread_pool of get_thread_count() threads the first time a phase needs it;
+	// set a task_scheduler to run them on a host engine's job system instead
+	// (nullptr restores the built-in pool). Not owned: it must outlive the
+	// simulator or be unset first. The thread count still sets how many parts each
+	// phase is split into, so pick one that keeps the scheduler's workers busy.
+	void set_task_scheduler(task_scheduler * s) { scheduler_ = s; }
+	task_scheduler * get_task_scheduler() const { return scheduler_; }
+
+	// Simulation islands. Each tick the velocity solve partitions the bodies into
+	// islands: the connected components of the graph whose edges are this tick's
+	// contacts and the constraints. Immovable bodies (infinite mass, no dynamic
+	// spin — walls, floors, kinematic platforms) take no impulse, so they break the
+	// graph instead of joining it: two piles resting on one floor are two islands.
+	// Members are every awake movable body plus any sleeping one an awake body
+	// touches; an isolated awake body is an island of its own. The contacts are
+	// grouped by island, and the velocity solve, shock propagation and the position
+	// correction run island by island (across set_thread_count() threads when it is
+	// above 1), so independent piles no longer pay for each other's convergence.
+	// Islands share no movable body, so the result is the same as one global solve
+	// over every contact, and the same for any thread count.
+	//
+	// Valid from the end of one update() until the next update() or removal.
+	struct island {
+		int first_solid = 0;    // range in get_island_solid()
+		int num_solids = 0;
+		int first_contact = 0;  // range in get_contact()
+		int num_contacts = 0;
+		int num_colors = 0;     // contact colors (see set_colored_solve); 0 if uncolored
+		int first_color = 0;    // internal: this island's entries in color_first_
+	};
+	int get_island_count() const { return static_cast<int>(islands_.size()); }
+	const island & get_island(int i) const { return islands_[i]; }
+	// Island members, ordered by island and then by add order.
+	solid<T> * get_island_solid(int k) const { return island_solids_[k]; }
+	// This tick's contacts, grouped by island. Contacts between two immovable
+	// bodies belong to no island and come after the last island's range.
+	int get_contact_count() const { return static_cast<int>(contact_pairs_.size()); }
+	void get_contact(int k, solid<T> *& a, solid<T> *& b, vec3<T> & normal, T & normal_impulse) const {
+		const contact_pair & p = contact_pairs_[k];
+		a = p.a;
+		b = p.b;
+		normal.set(p.normal);  // points from a toward b
+		normal_impulse = p.accum_n;
+	}
+	// A colored island's contacts are grouped by color: color c is the range
+	// [get_color_first(isl, c), get_color_first(isl, c + 1)), and the overflow
+	// group runs from get_color_first(isl, isl.num_colors) to the island's end.
+	int get_color_first(const island & isl, int c) const { return color_first_[isl.first_color + c]; }
+
+	// Colored solve (opt-in). Islands run in parallel with each other, which does
+	// nothing for a scene that is one giant island (a single settled pile). With
+	// this on, an island of at least colored_solve_min_contacts contacts has its
+	// contacts partitioned into colors, greedily in contact order: no two contacts
+	// of one color share a movable body, so each color's contacts are independent
+	// and the velocity sweeps and the position correction solve a color at a time,
+	// split across set_thread_count() threads. A contact that finds no free color
+	// among the first max_colors goes to an overflow group solved serially after
+	// them. Warm starting is unchanged; shock propagation walks its support-first
+	// order serially as before.
+	//
+	// Coloring reorders the Gauss-Seidel visits, so enabling it changes results
+	// slightly. Which islands are colored, and how, depends only on the contacts,
+	// never on the thread count, so the thread count does not change results.
+	static constexpr int colored_solve_min_contacts = 256;
+	static constexpr int max_colors = 64;
+	void set_colored_solve(bool c) { colored_solve_ = c; }
+	bool get_colored_solve() const { return colored_solve_; }
+
 	// Solid management
 	void add_solid(std::shared_ptr<solid<T>> s) {
-		for (auto & existing : solids_) {
-			if (existing == s)
-				return;
-		}
+		if (s->simulator_ == this)
+			return;  // already added
+		s->sleep_next_ = s->sleep_prev_ = nullptr;  // any ring it slept in belongs to another simulator
+		s->solids_index_ = static_cast<int>(solids_.size());
 		solids_.push_back(s);
 		s->internal_set_simulator(this);
 		s->solve_id_ = next_solve_id_++;  // stable canonical-ordering key (see solid::solve_id_)
 		s->set_contact_mode(default_contact_mode_);  // per-body default; override after add_solid
 		s->activate();
+		internal_add_awake(s.get());  // already-active bodies skip activate()'s push
 		spacial_collection_.resize(solids_.size());
 	}
 
 	void remove_solid(std::shared_ptr<solid<T>> s) {
-		// Purge any cached references to this solid from every other body's
-		// contact cache so the solver doesn't dereference a dead partner.
-		auto * dead = s.get();
-		for (auto & other : solids_) {
-			if (other.get() == dead)
+		solid<T> * dead = s.get();
+		remove_solids(&dead, 1);
+	}
+
+	// Remove count solids at once. Each costs O(its contacts), independent of how
+	// many solids the scene holds, and the per-call work (collision records,
+	// island lists) is done once for the whole batch, so despawning thousands of
+	// fragments in one call is no frame spike. Solids not in this simulator are
+	// skipped. A manager that holds them must drop them too (see
+	// bvh_manager::remove_solids).
+	void remove_solids(solid<T> * const solids[], int count) {
+		removing_.clear();
+		for (int i = 0; i < count; ++i) {
+			solid<T> * dead = solids[i];
+			if (dead->simulator_ != this)
 				continue;
-			int w = 0;
-			for (int r = 0; r < other->touch_count_; ++r) {
-				if (other->touches_[r].partner != dead) {
-					if (w != r)
-						other->touches_[w] = other->touches_[r];
-					++w;
-				}
+			internal_remove_touches(dead);
+			// Drop it from the ring of the island it is sleeping with.
+			if (dead->sleep_next_) {
+				dead->sleep_prev_->sleep_next_ = dead->sleep_next_;
+				dead->sleep_next_->sleep_prev_ = dead->sleep_prev_;
+				dead->sleep_next_ = dead->sleep_prev_ = nullptr;
 			}
-			other->touch_count_ = w;
+			internal_remove_awake(dead);
+			dead->internal_set_simulator(nullptr);
+			removing_.push_back(dead);
 		}
-		s->touch_count_ = 0;
+		if (removing_.empty())
+			return;
 
 		if (reporting_collisions_) {
+			std::sort(removing_.begin(), removing_.end());
+			auto is_dead = [this](const solid<T> * s) {
+				return s && std::binary_search(removing_.begin(), removing_.end(), s);
+			};
 			for (int i = 0; i < num_collisions_; ++i) {
 				auto & c = collisions_[i];
-				if (c.collider == s.get())
+				if (is_dead(c.collider))
 					c.collider = nullptr;
-				if (c.collidee == s.get())
+				if (is_dead(c.collidee))
 					c.collidee = nullptr;
 			}
 		}
 
-		s->internal_set_simulator(nullptr);
-		solids_.erase(std::remove(solids_.begin(), solids_.end(), s), solids_.end());
+		// The island and contact lists point at the dead solids; drop them until
+		// the next solve rebuilds them.
+		islands_.clear();
+		island_solids_.clear();
+		contact_pairs_.clear();
+
+		// Swap-and-pop out of solids_ last: this may release the final reference.
+		for (auto * dead : removing_) {
+			const int i = dead->solids_index_;
+			dead->solids_index_ = -1;
+			if (i != static_cast<int>(solids_.size()) - 1) {
+				solids_[i] = std::move(solids_.back());
+				solids_[i]->solids_index_ = i;
+			}
+			solids_.pop_back();
+		}
 	}
 
 	const std::vector<std::shared_ptr<solid<T>>> & get_solids() const { return solids_; }
 
+	// Pooled solids, for bodies spawned and despawned in bulk. create_solid takes
+	// a default-state solid from the simulator's object_pool and adds it; the
+	// solid itself costs no heap allocation or reference counting once the pool
+	// has grown to the scene's peak. Shapes are not pooled: each add_shape still
+	// brings its own shape. Configure the solid through get_solid afterwards, as
+	// after add_solid. destroy_solid removes it (see remove_solid) and recycles
+	// it, so every handle to it goes stale and get_solid returns null. A manager
+	// that holds the solid must drop it first, as for remove_solid. get_solid_ptr
+	// wraps a pooled solid for the APIs that take a shared_ptr (constraints); it
+	// does not keep the solid alive past destroy_solid, so destroy_solid also
+	// destroys every constraint attached to the solid and removes it from the
+	// simulator.
+	pool_handle create_solid() {
+		const pool_handle h = solid_pool_.create();
+		add_solid(solid_pool_.get_ptr(h));
+		return h;
+	}
+	void destroy_solid(pool_handle h) {
+		solid<T> * s = solid_pool_.get(h);
+		if (!s)
+			return;
+		while (!s->constraints_.empty()) {
+			constraint<T> * c = s->constraints_.back();
+			c->destroy();  // unlinks c from both ends, s included
+			auto it = std::find_if(constraints_.begin(), constraints_.end(),
+			                       [c](const typename constraint<T>::ptr & p) { return p.get() == c; });
+			if (it != constraints_.end()) {
+				c->internal_set_simulator(nullptr);
+				constraints_.erase(it);
+			}
+		}
+		remove_solid(solid_pool_.get_ptr(h));
+		solid_pool_.release(h);
+	}
+	solid<T> * get_solid(pool_handle h) const { return solid_pool_.get(h); }
+	std::shared_ptr<solid<T>> get_solid_ptr(pool_handle h) const { return solid_pool_.get_ptr(h); }
+
 	// Constraint management
 	void add_constraint(typename constraint<T>::ptr c) {
 		for (auto & existing : constraints_) {
@@ -238,29 +428,48 @@ public:
 			manager_->pre_update(dt);
 
 		// Build the iteration list. When a target is given we update just that
-		// one solid. Otherwise the manager may suggest a spatial-locality
-		// iteration order; contract: when non-null, it must contain every solid
-		// the simulator should update — anything in solids_ but absent from the
-		// order is skipped. With no manager order, iterate solids_ directly.
-		const std::vector<solid<T> *> * order =
-		    (target == nullptr && manager_) ? manager_->get_iteration_order() : nullptr;
-		// The manager's order is a spatial-locality *hint*, not a contract. If a
-		// manager desync or a mid-tick add/remove leaves it out of sync with
-		// solids_, ignore it for this tick and iterate solids_ directly. A stale
-		// order would otherwise skip bodies (release) or dereference a dangling
-		// solid pointer (use-after-free) — both far worse than losing locality
-		// for one tick. (Was an assert(); promoted to a graceful fallback.)
-		if (order && order->size() != solids_.size())
-			order = nullptr;
-
-		const size_t num = target ? 1 : (order ? order->size() : solids_.size());
+		// one solid. Otherwise walk the awake list only — a sleeping body has no
+		// per-tick work — in canonical (solve_id_) order, so the walk does not
+		// depend on the order bodies happened to wake in.
+		//
+		// The manager may suggest a spatial-locality iteration order; contract:
+		// when non-null, it must contain every solid the simulator should update.
+		// It lists sleeping bodies too, so filtering it costs O(solids), not
+		// O(awake): use it only while at least half the world is awake, where the
+		// locality is worth the scan.
+		auto build_order = [&] {
+			tick_order_.clear();
+			if (target) {
+				tick_order_.push_back(target);
+				return;
+			}
+			const std::vector<solid<T> *> * order = manager_ ? manager_->get_iteration_order() : nullptr;
+			// The manager's order is a spatial-locality *hint*, not a contract. If a
+			// manager desync or a mid-tick add/remove leaves it out of sync with
+			// solids_, ignore it for this tick and walk the awake list. A stale
+			// order would otherwise skip bodies (release) or dereference a dangling
+			// solid pointer (use-after-free) — both far worse than losing locality
+			// for one tick. (Was an assert(); promoted to a graceful fallback.)
+			if (order && order->size() == solids_.size() && awake_.size() * 2 >= order->size()) {
+				for (auto * s : *order)
+					if (s->active_)
+						tick_order_.push_back(s);
+			} else {
+				const auto & awake = sorted_awake();
+				tick_order_.assign(awake.begin(), awake.end());
+			}
+		};
+		build_order();
+		size_t num = tick_order_.size();
 		const bool flip = !target && (current_tick_ & 1);
 
 		// Resolve the solid for iteration index ii (applying the per-tick flip),
 		// or nullptr if it should be skipped this tick. Shared by both pipelines.
+		// The list is a snapshot: a body that falls asleep during the walk is
+		// skipped, and one woken during it joins from the next walk on.
 		auto select = [&](size_t ii) -> solid<T> * {
 			size_t i = flip ? num - 1 - ii : ii;
-			solid<T> * s = target ? target : (order ? (*order)[i] : solids_[i].get());
+			solid<T> * s = tick_order_[i];
 			if (!s->active_ || (scope != 0 && (s->scope_ & scope) == 0))
 				return nullptr;
 			return s;
@@ -274,39 +483,14 @@ public:
 		// pass and shock propagation have work to do; a scene with no speculative
 		// body behaves exactly as the legacy swept pipeline did.
 		bool any_speculative = false;
-		for (size_t ii = 0; ii < num; ++ii) {
-			solid<T> * s = select(ii);
-			if (!s) continue;
-			// Each integration path accumulates into this (the angular-CCD loop below
-			// calls update_solid several times), so it starts the tick at zero.
-			s->ext_dv_.reset();
-			if (manager_) manager_->pre_update(s, dt);
-			if (s->uses_speculative_solve()) {
-				any_speculative = true;
-				integrate_and_discover(s, dt);
-			} else {
-				int nsub = angular_substeps(s, dt);
-				if (nsub == 1) {
-					update_solid(s, dt); // the common, bit-identical path
-				} else {
-					// Angular CCD: re-run the integrate+trace at dt/N, so the body is
-					// traced at N interpolated orientations. update_solid clears force_
-					// and torque_ each call (and integrate_angular clears torque_), so
-					// re-apply the frame's external force/torque before each sub-step —
-					// each then acts over dt/N and they sum to the full-frame impulse.
-					// Gravity, drag, and constraints recompute per sub-step already.
-					const vec3<T> ext_force = s->force_;
-					const vec3<T> ext_torque = s->torque_;
-					const T sub = dt / tr::from_int(nsub);
-					for (int k = 0; k < nsub && s->active_; ++k) {
-						if (k > 0) {
-							s->force_ = ext_force;
-							s->torque_ = ext_torque;
-						}
-						update_solid(s, sub);
-					}
-				}
-				if (manager_) manager_->post_update(s, dt);
+		if (parallel_pass_a_ && !target) {
+			any_speculative = split_pass_a(num, select, dt);
+		} else {
+			for (size_t ii = 0; ii < num; ++ii) {
+				solid<T> * s = select(ii);
+				if (!s) continue;
+				if (pass_a_body(s, dt))
+					any_speculative = true;
 			}
 		}
 
@@ -326,7 +510,10 @@ public:
 			// sweep_slide partner. commit_solid folds the correction into the move.
 			correct_positions();
 			// Pass B: commit each speculative body's position; sweep_slide bodies
-			// already committed (and ran post_update) in Pass A.
+			// already committed (and ran post_update) in Pass A. Re-snapshot the
+			// awake list: the solve may have woken bodies Pass A did not walk.
+			build_order();
+			num = tick_order_.size();
 			for (size_t ii = 0; ii < num; ++ii) {
 				solid<T> * s = select(ii);
 				if (!s || !s->uses_speculative_solve()) continue;
@@ -335,6 +522,11 @@ public:
 			}
 		}
 
+		release_solver_bodies();
+
+		// Put to sleep every island whose members all came to rest this tick.
+		sleep_islands();
+
 		report_collisions();
 		if (manager_)
 			manager_->post_update(dt);
@@ -360,6 +552,10 @@ public:
 	// position, decide whether it qualifies to sleep this tick. Used by both the
 	// default and speculative pipelines.
 	void try_deactivate(solid<T> * solid_ptr, const vec3<T> & new_pos, T dt);
+	// Island sleep: deactivate, as one unit, every island whose members are all
+	// asleep or marked ready by try_deactivate this tick, and link them into one
+	// sleep ring so they also wake as one.
+	void sleep_islands();
 
 	// Find solids in box. collide_with_bits filters the result to solids whose
 	// collision_scope shares a bit with it (the same test trace_segment applies); -1,
@@ -368,43 +564,66 @@ public:
 	// slots in its fixed-capacity result buffer. See manager::find_solids_in_aa_box.
 	int find_solids_in_aa_box(const aa_box<T> & box, solid<T> * solids[], int max_solids,
 	                          int collide_with_bits = -1) const {
-		aa_box<T> expanded(box);
-		expanded.mins.x -= epsilon_;
-		expanded.mins.y -= epsilon_;
-		expanded.mins.z -= epsilon_;
-		expanded.maxs.x += epsilon_;
-		expanded.maxs.y += epsilon_;
-		expanded.maxs.z += epsilon_;
-
-		int amount = -1;
-		if (manager_)
-			amount = manager_->find_solids_in_aa_box(expanded, solids, max_solids, collide_with_bits);
+		return find_solids(nullptr, box, solids, max_solids, collide_with_bits);
+	}
 
-		if (amount == -1) {
-			amount = 0;
-			for (auto & s : solids_) {
-				// -1 means "no filter", not "all bits": a bitwise test against it would
-				// drop scope-0 solids, which the unfiltered scan has always reported.
-				if (collide_with_bits != -1 && (collide_with_bits & s->collision_scope_) == 0)
-					continue;
-				if (test_intersection(expanded, s->world_bound_)) {
-					if (amount < max_solids)
-						solids[amount] = s.get();
-					amount++;
-				}
-			}
-		}
-		if (amount > max_solids)
-			amount = max_solids;
-		return amount;
+	// Every solid find_solids_in_aa_box would report, handed to fn one at a time
+	// until it returns false: no result buffer to size or overflow, and the
+	// manager's search stops where fn does (manager::for_each_solid_in_aa_box).
+	// For large swept boxes, and for queries that can stop at the first solid.
+	void for_each_solid_in_aa_box(const aa_box<T> & box, const std::function<bool(solid<T> *)> & fn,
+	                              int collide_with_bits = -1) const;
+
+	// Scratch for the reentrant queries: the const overloads of trace_segment,
+	// trace_segment_any and trace_solid below, and query_solids_in_aa_box. They
+	// keep their candidates here instead of in the simulator, and only read the
+	// manager (manager::query_solids_in_aa_box, query_segment, query_solid), so
+	// threads each holding their own scratch can query at once — between ticks,
+	// not during update() or while solids are added or removed. A stale
+	// bvh_manager tree is searched around rather than rebuilt, so the results
+	// name the same solids as the other overloads, possibly folded in another
+	// order.
+	struct query_scratch {
+		std::vector<solid<T> *> solids;
+	};
+	int query_solids_in_aa_box(const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                           int collide_with_bits = -1) const {
+		return find_solids(nullptr, box, solids, max_solids, collide_with_bits, true);
 	}
 
-	// Trace / test
+	// Trace / test. Every trace filters by collide_with_bits in the broad phase
+	// as well as the narrow phase, so the search (and bvh_manager's scope
+	// pruning) hands on only solids whose collision_scope shares a bit with it;
+	// -1 passes every solid. The const overloads below follow the same rule.
 	void trace_segment(collision<T> & result,
 	                   const segment<T> & seg,
 	                   int collide_with_bits = -1,
 	                   solid<T> * ignore = nullptr);
+	// Whether anything blocks seg: true exactly when trace_segment would report a
+	// hit, for line-of-sight and visibility checks. The first candidate hit ends
+	// the query, and no contact point, normal or merge is computed. With
+	// with_manager false the manager's own geometry (manager::trace_segment_any)
+	// is left out.
+	bool trace_segment_any(const segment<T> & seg, int collide_with_bits = -1, solid<T> * ignore = nullptr,
+	                       bool with_manager = true);
+	// Trace count segments in one call: results[i] is what
+	// trace_segment(results[i], segs[i], collide_with_bits, ignore) reports. The
+	// segments are taken in the order of a space-filling curve through their
+	// boxes, and neighbours are grouped while their union box is no bigger than
+	// their separate boxes put together. Each group makes one broad-phase query
+	// for its union box instead of one per segment: one descent of bvh_manager's
+	// trees, or without a manager one pass over the solids. For the hundreds of
+	// line-of-sight, volley or suspension rays a game casts from a few places
+	// each tick.
+	void trace_segments(collision<T> results[], const segment<T> segs[], int count, int collide_with_bits = -1,
+	                    solid<T> * ignore = nullptr);
 	void trace_solid(collision<T> & result, solid<T> * s, const segment<T> & seg, int collide_with_bits = -1);
+	void trace_segment(collision<T> & result, const segment<T> & seg, query_scratch & scratch,
+	                   int collide_with_bits = -1, solid<T> * ignore = nullptr) const;
+	bool trace_segment_any(const segment<T> & seg, query_scratch & scratch, int collide_with_bits = -1,
+	                       solid<T> * ignore = nullptr, bool with_manager = true) const;
+	void trace_solid(collision<T> & result, solid<T> * s, const segment<T> & seg, query_scratch & scratch,
+	                 int collide_with_bits = -1) const;
 	void test_segment(collision<T> & result, const segment<T> & seg, solid<T> * s) {
 		hop::test_segment(result, seg, s, epsilon_);
 	}
@@ -475,15 +694,61 @@ public:
 		return x < epsilon && x > -epsilon && y < epsilon && y > -epsilon && z < epsilon && z > -epsilon;
 	}
 
-	int count_active_solids() const {
-		int n = 0;
-		for (auto & s : solids_)
-			if (s->active_)
-				n++;
-		return n;
-	}
+	int count_active_solids() const { return static_cast<int>(awake_.size()); }
 
 private:
+	// find_solids_in_aa_box, or with `near` set, the broad phase for that solid's
+	// own sweep, which the manager may answer from its per-solid tracking
+	// (manager::find_solids_near). With `shared` set, the read-only query behind
+	// the reentrant API (manager::query_solids_in_aa_box).
+	int find_solids(solid<T> * near, const aa_box<T> & box, solid<T> * solids[], int max_solids,
+	                int collide_with_bits = -1, bool shared = false) const {
+		aa_box<T> expanded(box);
+		expanded.mins.x -= epsilon_;
+		expanded.mins.y -= epsilon_;
+		expanded.mins.z -= epsilon_;
+		expanded.maxs.x += epsilon_;
+		expanded.maxs.y += epsilon_;
+		expanded.maxs.z += epsilon_;
+
+		int amount = -1;
+		if (manager_ && shared)
+			amount = manager_->query_solids_in_aa_box(expanded, solids, max_solids, collide_with_bits);
+		else if (manager_ && near)
+			amount = manager_->find_solids_near(near, expanded, solids, max_solids, collide_with_bits);
+		else if (manager_)
+			amount = manager_->find_solids_in_aa_box(expanded, solids, max_solids, collide_with_bits);
+
+		if (amount == -1) {
+			amount = 0;
+			for (auto & s : solids_) {
+				// -1 means "no filter", not "all bits": a bitwise test against it would
+				// drop scope-0 solids, which the unfiltered scan has always reported.
+				if (collide_with_bits != -1 && (collide_with_bits & s->collision_scope_) == 0)
+					continue;
+				if (test_intersection(expanded, s->world_bound_)) {
+					if (amount < max_solids)
+						solids[amount] = s.get();
+					amount++;
+				}
+			}
+		}
+		if (amount > max_solids)
+			amount = max_solids;
+		return amount;
+	}
+
+	// The candidates for tracing seg: the manager's (manager::find_solids_on_segment,
+	// padded by epsilon_ as find_solids grows a box), or the scan of seg's box.
+	int find_solids_on_segment(const segment<T> & seg, solid<T> * solids[], int max_solids, int collide_with_bits) {
+		if (manager_) {
+			const int amount = manager_->find_solids_on_segment(seg, epsilon_, solids, max_solids, collide_with_bits);
+			if (amount != -1)
+				return amount;
+		}
+		return find_solids(nullptr, segment_box(seg), solids, max_solids, collide_with_bits);
+	}
+
 	void init_epsilon_defaults() {
 		if constexpr (is_fixed_scalar_v<T>) {
 			set_epsilon_bits(tr::default_epsilon_bits());
@@ -504,15 +769,202 @@ private:
 		spec_pos_baumgarte_ = tr::from_milli(800);   // 0.8 — fraction of penetration removed per NGS iteration
 	}
 
+	// Per-worker state for the split Pass A (see set_parallel_pass_a). A worker never
+	// touches another body's state during discovery; what it would have done to one
+	// is recorded here and applied in iteration order once the workers have joined.
+	struct pass_a_scratch {
+		std::vector<solid<T> *> spacials;    // broad-phase result buffer (this worker's spacial_collection_)
+		std::vector<collision<T>> events;     // collision-callback records, appended to collisions_
+		std::vector<solid<T> *> wakes;        // partners to activate()
+		std::vector<std::pair<solid<T> *, vec3<T>>> relocations;  // collision_response position overrides
+	};
+
+	// One body's Pass A in the default (serial) walk, dispatching on its contact
+	// mode. Returns true if the body took the speculative path.
+	bool pass_a_body(solid<T> * s, T dt);
+	// The split Pass A. Returns whether any body took the speculative path.
+	template <typename Select> bool split_pass_a(size_t num, Select && select, T dt);
+	// The two halves of integrate_and_discover. With a scratch, discover_contacts
+	// defers its effects on other bodies into it instead of applying them.
+	void integrate_speculative(solid<T> * solid_ptr, T dt);
+	void discover_contacts(solid<T> * solid_ptr, T dt, pass_a_scratch * scratch);
+	// Run fn(0) .. fn(count - 1) on the task scheduler (see set_task_scheduler).
+	template <typename Fn> void parallel_for(int count, Fn && fn);
+
+	// Awake list upkeep, called by solid::activate/deactivate. Swap-and-pop, so
+	// both are O(1) and leave the list unordered.
+	void internal_add_awake(solid<T> * s) {
+		if (s->awake_index_ >= 0)
+			return;
+		s->awake_index_ = static_cast<int>(awake_.size());
+		awake_.push_back(s);
+		awake_sorted_ = false;
+	}
+	void internal_remove_awake(solid<T> * s) {
+		if (s->awake_index_ < 0)
+			return;
+		solid<T> * last = awake_.back();
+		awake_[s->awake_index_] = last;
+		last->awake_index_ = s->awake_index_;
+		awake_.pop_back();
+		s->awake_index_ = -1;
+		awake_sorted_ = false;
+	}
+	// solid::activate/deactivate report the change to the manager through
+	// these, once the awake list is up to date.
+	void internal_activated(solid<T> * s) {
+		if (manager_)
+			manager_->solid_activated(s);
+	}
+	void internal_deactivated(solid<T> * s) {
+		if (manager_)
+			manager_->solid_deactivated(s);
+	}
+	// Touch back-references (solid::touched_by_). A slot's registration
+	// (touch::linked) trails its partner while Pass A discovers contacts, possibly
+	// on several threads; link_touches brings one body's slots up to date once its
+	// discovery is done, always serially.
+	void link_touches(solid<T> * s) {
+		// Unregister every stale slot before registering any new one, so a holder
+		// is never listed twice by one partner (a slot's old partner may be
+		// another slot's new one).
+		bool relink = false;
+		for (int i = 0; i < s->touch_count_; ++i) {
+			auto & slot = s->touches_[i];
+			if (slot.linked != slot.partner) {
+				relink = true;
+				if (slot.linked)
+					unlink_touch(slot);
+			}
+		}
+		if (!relink)
+			return;
+		for (int i = 0; i < s->touch_count_; ++i) {
+			auto & slot = s->touches_[i];
+			if (slot.partner && !slot.linked) {
+				slot.linked = slot.partner;
+				slot.linked_index = static_cast<int>(slot.partner->touched_by_.size());
+				slot.partner->touched_by_.push_back(s);
+			}
+		}
+	}
+	// Drop slot's entry from its partner's back-references (swap-and-pop).
+	void unlink_touch(typename solid<T>::touch & slot) {
+		auto & list = slot.linked->touched_by_;
+		const int i = slot.linked_index;
+		solid<T> * moved = list.back();
+		list.pop_back();
+		if (i < static_cast<int>(list.size())) {
+			list[i] = moved;
+			for (int k = 0; k < moved->touch_count_; ++k) {
+				if (moved->touches_[k].linked == slot.linked) {
+					moved->touches_[k].linked_index = i;
+					break;
+				}
+			}
+		}
+		slot.linked = nullptr;
+		slot.linked_index = -1;
+	}
+	// Purge every touch slot that refers to dead, from both directions.
+	void internal_remove_touches(solid<T> * dead) {
+		for (int i = 0; i < dead->touch_count_; ++i)
+			if (dead->touches_[i].linked)
+				unlink_touch(dead->touches_[i]);
+		dead->touch_count_ = 0;
+		for (auto * other : dead->touched_by_) {
+			int w = 0;
+			for (int r = 0; r < other->touch_count_; ++r) {
+				if (other->touches_[r].partner != dead) {
+					if (w != r)
+						other->touches_[w] = other->touches_[r];
+					++w;
+				}
+			}
+			// The vacated tail is reused for new partners, which start unregistered.
+			for (int r = w; r < other->touch_count_; ++r)
+				other->touches_[r].linked = nullptr;
+			other->touch_count_ = w;
+		}
+		dead->touched_by_.clear();
+	}
+
+	// The awake list in canonical (solve_id_) order, sorted only if a body woke
+	// or slept since the last call.
+	const std::vector<solid<T> *> & sorted_awake() {
+		if (!awake_sorted_) {
+			std::sort(awake_.begin(), awake_.end(),
+			          [](const solid<T> * a, const solid<T> * b) { return a->solve_id_ < b->solve_id_; });
+			for (size_t i = 0; i < awake_.size(); ++i)
+				awake_[i]->awake_index_ = static_cast<int>(i);
+			awake_sorted_ = true;
+		}
+		return awake_;
+	}
+	// Drop every solver_bodies_ slot claimed this tick, once Pass B has folded in
+	// the position corrections.
+	void release_solver_bodies() {
+		for (auto * s : solver_solids_)
+			s->solver_body_index_ = -1;
+	}
+	// Give s a solver_bodies_ slot for this solve if it has none yet.
+	int claim_solver_body(solid<T> * s) {
+		if (s->solver_body_index_ < 0) {
+			s->solver_body_index_ = static_cast<int>(solver_solids_.size());
+			solver_solids_.push_back(s);
+			solver_body b;
+			b.velocity = s->velocity_;
+			b.angular_velocity = s->angular_velocity_;
+			b.inv_mass = s->inv_mass_;
+			b.anchored = s->inv_mass_ <= T {} || !s->active_;
+			solver_bodies_.push_back(b);
+		}
+		return s->solver_body_index_;
+	}
+
+	// An immovable body never takes an impulse, so it separates islands rather
+	// than joining them.
+	static bool is_island_breaker(const solid<T> * s) { return s->inv_mass_ <= T {} && !s->rotates_dynamically(); }
+	// Union-find over this tick's contact pairs and the constraints; fills islands_
+	// and island_solids_ and regroups contact_pairs_ by island. Called by
+	// solve_contacts once the pair list is built.
+	void build_islands();
+	// Run fn(island) for every island, spread across threads in contiguous runs of
+	// roughly equal contact count.
+	template <typename Fn> void for_each_island(Fn && fn);
+	// Run fn(pair) for every contact of a colored island: color by color (last to
+	// first when reverse), each color split across threads, then the overflow
+	// group serially. fn may run concurrently for contacts of one color.
+	template <typename Fn> void for_each_colored_pair(const island & isl, bool reverse, Fn && fn);
+
 	void report_collisions();
+	// The boxes trace_segment and trace_solid search.
+	static aa_box<T> segment_box(const segment<T> & seg);
+	static aa_box<T> solid_trace_box(solid<T> * s, const segment<T> & seg);
+	// The narrow phases of trace_segment, trace_segment_any and trace_solid over
+	// candidates[0, count). With shared set, the manager's geometry comes from
+	// its read-only query_segment / query_solid. pair_normal receives what
+	// solid_trace_pair_normal_ describes.
+	void trace_segment_among(collision<T> & result, const segment<T> & seg, solid<T> * const candidates[], int count,
+	                         int collide_with_bits, solid<T> * ignore, bool shared) const;
+	bool trace_segment_any_among(const segment<T> & seg, solid<T> * const candidates[], int count,
+	                             int collide_with_bits, solid<T> * ignore, bool with_manager, bool shared) const;
+	void trace_solid_among(collision<T> & result, solid<T> * s, const segment<T> & seg, solid<T> * const candidates[],
+	                       int count, int collide_with_bits, vec3<T> & pair_normal, bool shared) const;
 	void trace_segment_with_current_spacials(collision<T> & result,
 	                                         const segment<T> & seg,
 	                                         int collide_with_bits,
-	                                         solid<T> * ignore);
+	                                         solid<T> * ignore) {
+		trace_segment_among(result, seg, spacial_collection_.data(), num_spacial_collection_, collide_with_bits, ignore,
+		                    false);
+	}
 	void trace_solid_with_current_spacials(collision<T> & result,
 	                                       solid<T> * s,
 	                                       const segment<T> & seg,
-	                                       int collide_with_bits);
+	                                       int collide_with_bits) {
+		trace_solid_among(result, s, seg, spacial_collection_.data(), num_spacial_collection_, collide_with_bits,
+		                  solid_trace_pair_normal_, false);
+	}
 
 	void constraint_link(vec3<T> & result, solid<T> * s, const vec3<T> & solid_pos, const vec3<T> & solid_vel);
 	// Force one active constraint exerts on `s` at the given trial pos/vel, plus the
@@ -588,10 +1040,19 @@ private:
 	T max_force_component_ {};
 	std::vector<collision<T>> collisions_;
 	int num_collisions_ = 0;
+	object_pool<solid<T>> solid_pool_;  // see create_solid; outlives solids_, which may point into it
 	std::vector<std::shared_ptr<solid<T>>> solids_;
+	std::vector<solid<T> *> removing_;  // remove_solids scratch
 	std::vector<typename constraint<T>::ptr> constraints_;
 	std::vector<solid<T> *> spacial_collection_;
 	int num_spacial_collection_ = 0;
+	// trace_segments scratch: the segments' boxes (in curve order once
+	// sorted), sort keys and a group's broad-phase result.
+	std::vector<aa_box<T>> trace_boxes_;
+	std::vector<std::pair<std::uint32_t, int>> trace_order_;
+	std::vector<solid<T> *> trace_group_;
+	// Most segments trace_segments serves with one broad-phase query.
+	static constexpr int trace_group_size = 16;
 	bool reporting_collisions_ = false;
 	T micro_collision_threshold_ = tr::one();
 	T deactivate_speed_ {};
@@ -649,18 +1110,28 @@ private:
 		typename solid<T>::touch * slot_b = nullptr;
 	};
 	std::vector<contact_pair> contact_pairs_;
+	// The per-tick solver state of one body, kept densely by slot so the velocity
+	// sweeps, the shock walk and the NGS position pass stream one array instead
+	// of loading each pair's two solids. A slot lives from solve_contacts to the
+	// end of Pass B (see release_solver_bodies).
 	struct solver_body {
 		vec3<T> velocity;
 		vec3<T> angular_velocity;
+		vec3<T> pos_correction;  // NGS pseudo-position correction, folded in by commit_solid
+		T inv_mass {};
+		bool anchored = false;   // immovable or asleep: a standing shock-propagation anchor
+		bool frozen = false;     // shock-propagation scratch: a rigid support for this pass
+		bool corrects = false;   // absorbs NGS position correction (see correct_positions)
 	};
 	std::vector<solver_body> solver_bodies_;
 	// Shock-propagation scratch, all reused per tick (no steady-state alloc):
 	// shock_order_ is pair indices sorted support-end-first; shock_key_[k] is pair
-	// k's gravity-depth sort key; shock_lo_[k] is its deeper (anchor) body. Depths
-	// are computed once per tick since positions don't move during the solve.
+	// k's gravity-depth sort key; shock_lo_[k] is the slot of its deeper (anchor)
+	// body. Depths are computed once per tick since positions don't move during
+	// the solve.
 	std::vector<int> shock_order_;
 	std::vector<T> shock_key_;
-	std::vector<solid<T> *> shock_lo_;
+	std::vector<int> shock_lo_;
 	// Default contact mode stamped onto bodies in add_solid (per-body overridable;
 	// see set_default_contact_mode / solid::set_contact_mode).
 	contact_mode default_contact_mode_ = contact_mode::sweep_slide;
@@ -689,6 +1160,37 @@ private:
 	// hard-coded 5; raised to give a fast body room to resolve more colliders
 	// along a long step before the loop gives up (see set_max_collision_iterations).
 	int max_collision_iterations_ = 16;
+	bool parallel_pass_a_ = false;  // see set_parallel_pass_a
+	int thread_count_ = 1;
+	task_scheduler * scheduler_ = nullptr;     // see set_task_scheduler
+	std::unique_ptr<thread_pool> pool_;       // the built-in scheduler, started on first use
+	std::vector<pass_a_scratch> pass_a_scratch_;  // one per split Pass A chunk
+	std::vector<solid<T> *> pass_a_list_;         // the split phases' bodies, in iteration order
+	// Awake list: every added solid with active_ set, in no particular order
+	// (see internal_add_awake / sorted_awake). tick_order_ is the current walk.
+	std::vector<solid<T> *> awake_;
+	bool awake_sorted_ = true;
+	std::vector<solid<T> *> tick_order_;
+	// solver_bodies_ slot -> solid for the current solve: the awake bodies, then
+	// the partners they touch or are constrained to.
+	std::vector<solid<T> *> solver_solids_;
+	// Island partition (see get_island_count), rebuilt by build_islands each solve.
+	// island_parent_ and island_of_ are indexed by solver_bodies_ slot.
+	std::vector<island> islands_;
+	std::vector<solid<T> *> island_solids_;
+	std::vector<int> island_parent_;
+	std::vector<int> island_of_;                  // island id, or -1 for a non-member
+	std::vector<int> island_cursor_;
+	// Colored solve (see set_colored_solve). A colored island's colors are
+	// color_first_[isl.first_color + c] .. [+ c + 1], absolute contact_pairs_
+	// ranges; the entry after the last color starts the overflow group.
+	bool colored_solve_ = false;
+	std::vector<int> color_first_;
+	std::vector<std::uint64_t> color_mask_;  // per slot: colors its contacts hold
+	std::vector<int> pair_color_;
+	std::vector<contact_pair> island_pair_scratch_;
+
+	friend class solid<T>;
 };
 
 // ============================================================================
@@ -780,6 +1282,138 @@ template <typename T> void simulator<T>::integrate_angular(solid<T> * solid_ptr,
 	solid_ptr->clear_torque();
 }
 
+template <typename T> bool simulator<T>::pass_a_body(solid<T> * s, T dt) {
+	// Each integration path accumulates into this (the angular-CCD loop below
+	// calls update_solid several times), so it starts the tick at zero.
+	s->ext_dv_.reset();
+	if (manager_) manager_->pre_update(s, dt);
+	if (s->uses_speculative_solve()) {
+		integrate_and_discover(s, dt);
+		link_touches(s);
+		return true;
+	}
+	int nsub = angular_substeps(s, dt);
+	if (nsub == 1) {
+		update_solid(s, dt); // the common, bit-identical path
+	} else {
+		// Angular CCD: re-run the integrate+trace at dt/N, so the body is
+		// traced at N interpolated orientations. update_solid clears force_
+		// and torque_ each call (and integrate_angular clears torque_), so
+		// re-apply the frame's external force/torque before each sub-step —
+		// each then acts over dt/N and they sum to the full-frame impulse.
+		// Gravity, drag, and constraints recompute per sub-step already.
+		const vec3<T> ext_force = s->force_;
+		const vec3<T> ext_torque = s->torque_;
+		const T sub = dt / tr::from_int(nsub);
+		for (int k = 0; k < nsub && s->active_; ++k) {
+			if (k > 0) {
+				s->force_ = ext_force;
+				s->torque_ = ext_torque;
+			}
+			update_solid(s, sub);
+		}
+	}
+	link_touches(s);
+	if (manager_) manager_->post_update(s, dt);
+	return false;
+}
+
+template <typename T>
+template <typename Select>
+bool simulator<T>::split_pass_a(size_t num, Select && select, T dt) {
+	// A speculative body without constraints reads its partners but writes only
+	// itself, so it can run in the split phases. Everything else — sweep_slide
+	// bodies (they move, and push partners out of overlap) and constrained bodies
+	// (integration reads the far end of every constraint) — runs serially first,
+	// in iteration order, exactly as the default walk would run it.
+	auto splittable = [](const solid<T> * s) { return s->uses_speculative_solve() && s->constraints_.empty(); };
+	bool any_speculative = false;
+	for (size_t ii = 0; ii < num; ++ii) {
+		solid<T> * s = select(ii);
+		if (!s || splittable(s)) continue;
+		if (pass_a_body(s, dt))
+			any_speculative = true;
+	}
+	// Gathered after the serial bodies, which may have put a breaker to sleep.
+	pass_a_list_.clear();
+	for (size_t ii = 0; ii < num; ++ii) {
+		solid<T> * s = select(ii);
+		if (s && splittable(s))
+			pass_a_list_.push_back(s);
+	}
+	const int n = static_cast<int>(pass_a_list_.size());
+	if (n == 0)
+		return any_speculative;
+
+	// Contiguous chunks of the iteration order, one per thread. Concatenating the
+	// chunks' deferred effects in chunk order reproduces iteration order, so the
+	// merge below is the same whatever the chunk count.
+	const int nchunks = thread_count_ < n ? thread_count_ : n;
+	pass_a_scratch_.resize(nchunks);
+	for (auto & sc : pass_a_scratch_) {
+		sc.spacials.resize(solids_.size());
+		sc.events.clear();
+		sc.wakes.clear();
+		sc.relocations.clear();
+	}
+	auto chunk_begin = [n, nchunks](int c) { return static_cast<int>(static_cast<long long>(n) * c / nchunks); };
+
+	// Phase 1: integrate. Every body's velocity, orientation and bound are final
+	// for the tick before any body discovers against them.
+	parallel_for(nchunks, [&](int c) {
+		for (int i = chunk_begin(c), end = chunk_begin(c + 1); i < end; ++i) {
+			solid<T> * s = pass_a_list_[i];
+			s->ext_dv_.reset();
+			if (manager_) manager_->pre_update(s, dt);
+			integrate_speculative(s, dt);
+		}
+	});
+	// Phase 2: discover against that frozen state.
+	parallel_for(nchunks, [&](int c) {
+		pass_a_scratch & sc = pass_a_scratch_[c];
+		for (int i = chunk_begin(c), end = chunk_begin(c + 1); i < end; ++i)
+			discover_contacts(pass_a_list_[i], dt, &sc);
+	});
+
+	// Apply the deferred effects in iteration order.
+	for (auto * s : pass_a_list_)
+		link_touches(s);
+	for (auto & sc : pass_a_scratch_) {
+		for (auto & r : sc.relocations)
+			r.first->set_position_direct(r.second);
+		for (auto & col : sc.events) {
+			if (num_collisions_ >= static_cast<int>(collisions_.size()))
+				break;
+			collisions_[num_collisions_].set(col);
+			num_collisions_++;
+		}
+		for (auto * w : sc.wakes)
+			w->activate();
+	}
+	return true;
+}
+
+template <typename T>
+template <typename Fn>
+void simulator<T>::parallel_for(int count, Fn && fn) {
+	if (count <= 1 || thread_count_ <= 1) {
+		for (int i = 0; i < count; ++i)
+			fn(i);
+		return;
+	}
+	task_scheduler * sched = scheduler_;
+	if (!sched) {
+		// More threads than cores only adds contention; the parts still number
+		// thread_count_, so the split (and the result) is unchanged.
+		if (!pool_) {
+			const int cores = static_cast<int>(std::thread::hardware_concurrency());
+			pool_.reset(new thread_pool(cores > 0 && cores < thread_count_ ? cores : thread_count_));
+		}
+		sched = pool_.get();
+	}
+	sched->parallel_for(count, [&fn](int i) { fn(i); });
+}
+
 template <typename T> void simulator<T>::update_solid(solid<T> * solid_ptr, T dt) {
 	vec3<T> old_pos;
 	vec3<T> new_pos;
@@ -912,7 +1546,7 @@ template <typename T> void simulator<T>::update_solid(solid<T> * solid_ptr, T dt
 		box.maxs.z += m;
 
 		num_spacial_collection_ =
-		    find_solids_in_aa_box(box, spacial_collection_.data(), static_cast<int>(spacial_collection_.size()));
+		    find_solids(solid_ptr, box, spacial_collection_.data(), static_cast<int>(spacial_collection_.size()));
 	}
 
 	// Collision loop. Each iteration sweeps the body's integrated trajectory,
@@ -1043,11 +1677,14 @@ template <typename T> void simulator<T>::update_solid(solid<T> * solid_ptr, T dt
 				// participating in the solver to redistribute force properly. On the
 				// approach the pair actually had: this tick's own gravity increment is
 				// not an impact (see the speculative path's copy of this rule).
+				// A first touch on a sleeping island wakes it whatever the speed, so
+				// the island re-settles around its new member (see sleep_islands).
 				vec3<T> wake_dv(solid_ptr->ext_dv_);
 				sub(wake_dv, hit_solid->ext_dv_);
 				if ((hit_solid->collide_with_scope_ & solid_ptr->collision_scope_) != 0 &&
 				    hit_solid->should_collide(solid_ptr) &&
-				    impact_speed + dot(wake_dv, pair_normal) > deactivate_speed_) {
+				    (impact_speed + dot(wake_dv, pair_normal) > deactivate_speed_ ||
+				     (!sustained && !hit_solid->active_ && !is_island_breaker(hit_solid)))) {
 					hit_solid->activate();
 				}
 			}
@@ -1191,8 +1828,15 @@ template <typename T> void simulator<T>::try_deactivate(solid<T> * solid_ptr, co
 								break;
 						}
 					}
-					if (j < 0)
-						solid_ptr->deactivate();
+					// An island member does not sleep alone: it is marked ready, and
+					// sleep_islands puts it to sleep with the rest of its island once
+					// every member is ready. An immovable body belongs to no island.
+					if (j < 0) {
+						if (is_island_breaker(solid_ptr))
+							solid_ptr->deactivate();
+						else
+							solid_ptr->sleep_ready_tick_ = current_tick_;
+					}
 				}
 			} else {
 				solid_ptr->deactivate_count_ = 0;
@@ -1212,13 +1856,11 @@ template <typename T> void simulator<T>::try_deactivate(solid<T> * solid_ptr, co
 // manager's collision_response hook, which can claim it (excluding it from the
 // solver) exactly as in the legacy update_solid path.
 template <typename T> void simulator<T>::integrate_and_discover(solid<T> * solid_ptr, T dt) {
-	const T zero = T {};
-	const T one = tr::one();
-
-	// Reset this tick's NGS position correction (commit_solid folds it in for every
-	// body, so it must start at zero whether or not the body gets contacts).
-	solid_ptr->pos_correction_.reset();
+	integrate_speculative(solid_ptr, dt);
+	discover_contacts(solid_ptr, dt, nullptr);
+}
 
+template <typename T> void simulator<T>::integrate_speculative(solid<T> * solid_ptr, T dt) {
 	// Semi-implicit (symplectic) Euler: v += a(x, v)·dt, committed now; position
 	// is integrated in Pass B from the *solved* velocity. The high-order
 	// integrators (Heun/RK) target accurate ballistic free flight; a contact
@@ -1245,10 +1887,21 @@ template <typename T> void simulator<T>::integrate_and_discover(solid<T> * solid
 
 	if (manager_)
 		manager_->intra_update(solid_ptr, dt);
+}
+
+// The discovery half of speculative Pass A. Reads only this body's integrated state
+// and its partners' — which the split Pass A has frozen for the phase — and writes
+// only this body's touch cache. Everything it does to another body goes through
+// `scratch` when one is given (the split Pass A) and is applied directly otherwise.
+template <typename T> void simulator<T>::discover_contacts(solid<T> * solid_ptr, T dt, pass_a_scratch * scratch) {
+	const T zero = T {};
+	const T one = tr::one();
 
 	if (solid_ptr->collide_with_scope_ == 0)
 		return;
 
+	const vec3<T> & v = solid_ptr->velocity_;
+
 	// Predicted motion this frame (pre-solve), used only to aim the discovery
 	// sweep — the body is NOT moved here.
 	vec3<T> old_pos(solid_ptr->position_);
@@ -1270,8 +1923,10 @@ template <typename T> void simulator<T>::integrate_and_discover(solid<T> * solid
 	box.maxs.x += reach;
 	box.maxs.y += reach;
 	box.maxs.z += reach;
-	num_spacial_collection_ =
-	    find_solids_in_aa_box(box, spacial_collection_.data(), static_cast<int>(spacial_collection_.size()));
+	std::vector<solid<T> *> & spacials = scratch ? scratch->spacials : spacial_collection_;
+	const int num_spacials = find_solids(solid_ptr, box, spacials.data(), static_cast<int>(spacials.size()));
+	if (!scratch)
+		num_spacial_collection_ = num_spacials;
 
 	// Sweep the predicted motion. The speculative margin is applied as a uniform
 	// shape inflation in the test below (margin-shell discovery), not as a
@@ -1341,7 +1996,9 @@ template <typename T> void simulator<T>::integrate_and_discover(solid<T> * solid
 		if (!sustained && (solid_ptr->collision_callback_ != nullptr ||
 		                   (!partner_is_world && partner->collision_callback_ != nullptr))) {
 			col.collidee = solid_ptr;
-			if (num_collisions_ < static_cast<int>(collisions_.size())) {
+			if (scratch) {
+				scratch->events.push_back(col);
+			} else if (num_collisions_ < static_cast<int>(collisions_.size())) {
 				collisions_[num_collisions_].set(col);
 				num_collisions_++;
 			}
@@ -1355,7 +2012,11 @@ template <typename T> void simulator<T>::integrate_and_discover(solid<T> * solid
 			if (manager_->collision_response(solid_ptr, position, remainder, col)) {
 				if (position != old_pos) {
 					old_pos.set(position);
-					solid_ptr->set_position_direct(position);
+					// Other workers are reading this body's bound; move it after the join.
+					if (scratch)
+						scratch->relocations.push_back({ solid_ptr, position });
+					else
+						solid_ptr->set_position_direct(position);
 				}
 				return;  // claimed: no solver touch, no wake
 			}
@@ -1375,16 +2036,23 @@ template <typename T> void simulator<T>::integrate_and_discover(solid<T> * solid
 		vec3<T> wake_dv(solid_ptr->ext_dv_);
 		if (!partner_is_world)
 			sub(wake_dv, partner->ext_dv_);
+		//
+		// A first touch on a sleeping island wakes it whatever the speed, so the
+		// island re-settles around its new member (see sleep_islands).
 		const T wake_speed = impact_speed + dot(wake_dv, n);
 		if (!partner_is_world &&
 		    (partner->collide_with_scope_ & solid_ptr->collision_scope_) != 0 &&
-		    partner->should_collide(solid_ptr) && wake_speed > deactivate_speed_) {
-			partner->activate();
+		    partner->should_collide(solid_ptr) &&
+		    (wake_speed > deactivate_speed_ || (!sustained && !partner->active_ && !is_island_breaker(partner)))) {
+			if (scratch)
+				scratch->wakes.push_back(partner);
+			else
+				partner->activate();
 		}
 	};
 
-	for (int i = 0; i < num_spacial_collection_; ++i) {
-		auto * s2 = spacial_collection_[i];
+	for (int i = 0; i < num_spacials; ++i) {
+		auto * s2 = spacials[i];
 		if (s2 == solid_ptr)
 			continue;
 		if ((bits & s2->collision_scope_) == 0)
@@ -1433,7 +2101,10 @@ template <typename T> void simulator<T>::commit_solid(solid<T> * solid_ptr, T dt
 	mul(delta, solid_ptr->velocity_, dt);
 	vec3<T> new_pos;
 	add(new_pos, old_pos, delta);
-	add(new_pos, solid_ptr->pos_correction_);  // NGS pseudo-position correction
+	// NGS pseudo-position correction. A body with no slot had no contacts solved
+	// this tick, so nothing to fold.
+	if (solid_ptr->solver_body_index_ >= 0)
+		add(new_pos, solver_bodies_[solid_ptr->solver_body_index_].pos_correction);
 	cap_vec3(new_pos, max_position_component_);
 
 	try_deactivate(solid_ptr, new_pos, dt);
@@ -1441,8 +2112,8 @@ template <typename T> void simulator<T>::commit_solid(solid<T> * solid_ptr, T dt
 }
 
 // Iterative non-linear Gauss–Seidel position solver. Accumulates a per-body
-// pseudo-position correction (solid::pos_correction_, zeroed in Pass A and folded
-// into the commit), never touching velocity — so it removes penetration without
+// pseudo-position correction (solver_body::pos_correction, zero from the slot's
+// claim and folded into the commit), never touching velocity — so it removes penetration without
 // adding energy, unlike a velocity-level Baumgarte term. "Non-linear" because each
 // pair's separation is re-derived from the running correction every visit, so the
 // corrections from a body's several contacts converge (a floor pushing up and a
@@ -1450,57 +2121,353 @@ template <typename T> void simulator<T>::commit_solid(solid<T> * solid_ptr, T dt
 // mode of a one-shot projection, which over-displaced and ejected bodies.
 template <typename T> void simulator<T>::correct_positions() {
 	const T zero = T {};
-	// Start every participating body from a zero correction. Active bodies were
-	// already zeroed in Pass A; this additionally clears sleeping partners (skipped
-	// in Pass A) whose stale correction would otherwise corrupt the re-derivation.
+	// Only an awake speculative body absorbs correction here: sleeping/static
+	// bodies and sweep_slide bodies are immovable supports (a sweep_slide body
+	// never folds the correction — it placed itself in Pass A — so giving it a
+	// share would silently drop that correction). Decided per slot once, after the
+	// velocity solve has woken whatever it perturbed.
+	for (size_t i = 0; i < solver_solids_.size(); ++i) {
+		const solid<T> * s = solver_solids_[i];
+		solver_bodies_[i].corrects = s->active_ && s->uses_speculative_solve();
+	}
+	// Island by island: a correction only moves awake bodies, and those belong to
+	// exactly one island. Pairs outside every island join two immovable bodies and
+	// have nothing to correct.
+	auto correct_island = [&](const island & isl) {
+		for (int iter = 0; iter < spec_pos_iters_; ++iter) {
+			// With unchanged pseudo-positions, a later NGS pass would visit the
+			// exact same separations. Once a full pass applies no correction, the
+			// remaining iterations cannot make progress. Islands are independent, so
+			// each stops on its own.
+			std::atomic<bool> corrected { false };  // set from several threads when colored
+			auto correct_pair = [&](contact_pair & p) {
+				solver_body & sa = solver_bodies_[p.index_a];
+				solver_body & sb = solver_bodies_[p.index_b];
+				// A support takes no share: a speculative body takes the whole
+				// correction against it.
+				T inv_a = sa.corrects ? p.inv_ma : zero;
+				T inv_b = sb.corrects ? p.inv_mb : zero;
+				T inv_sum = inv_a + inv_b;
+				if (inv_sum <= zero)
+					return;
+				// Current separation = the gap at discovery plus how far the running
+				// corrections have already separated this pair along the normal.
+				vec3<T> rel;
+				sub(rel, sb.pos_correction, sa.pos_correction);
+				T cur_sep = p.separation + dot(rel, p.normal);
+				// Only penetration beyond the slop band is corrected.
+				T pen = -cur_sep - spec_slop_;
+				if (pen <= zero)
+					return;
+				T corr = pen * spec_pos_baumgarte_;
+				if (corr <= zero)
+					return;
+				corrected.store(true, std::memory_order_relaxed);
+				// p.normal points from a toward b: push b along +normal and a along
+				// -normal, each by its share of the inverse mass.
+				if (inv_b > zero) {
+					vec3<T> d;
+					mul(d, p.normal, corr * (inv_b / inv_sum));
+					add(sb.pos_correction, d);
+				}
+				if (inv_a > zero) {
+					vec3<T> d;
+					mul(d, p.normal, corr * (inv_a / inv_sum));
+					sub(sa.pos_correction, d);
+				}
+			};
+			if (isl.num_colors > 0) {
+				for_each_colored_pair(isl, false, correct_pair);
+			} else {
+				for (int k = 0; k < isl.num_contacts; ++k)
+					correct_pair(contact_pairs_[isl.first_contact + k]);
+			}
+			if (!corrected.load(std::memory_order_relaxed))
+				break;
+		}
+	};
+	// As in solve_contacts, a colored island splits its own work across threads.
+	for_each_island([&](const island & isl) {
+		if (isl.num_colors == 0)
+			correct_island(isl);
+	});
+	for (auto & isl : islands_)
+		if (isl.num_colors > 0)
+			correct_island(isl);
+}
+
+template <typename T> void simulator<T>::sleep_islands() {
+	// Splice ring `r` into the ring at `head`. Swapping one next pointer from each
+	// of two distinct rings joins them into one; the two successors then take
+	// their new predecessors.
+	auto splice = [](solid<T> *& head, solid<T> * r) {
+		if (!head) {
+			head = r;
+		} else {
+			std::swap(head->sleep_next_, r->sleep_next_);
+			head->sleep_next_->sleep_prev_ = head;
+			r->sleep_next_->sleep_prev_ = r;
+		}
+	};
+	for (auto & isl : islands_) {
+		const int end = isl.first_solid + isl.num_solids;
+		bool ready = true;
+		for (int k = isl.first_solid; k < end && ready; ++k) {
+			const solid<T> * s = island_solids_[k];
+			ready = !s->active_ || s->sleep_ready_tick_ == current_tick_;
+		}
+		if (!ready)
+			continue;
+
+		solid<T> * head = nullptr;
+		for (int k = isl.first_solid; k < end; ++k) {
+			solid<T> * s = island_solids_[k];
+			if (s->active_) {
+				s->deactivate();
+				s->sleep_next_ = s->sleep_prev_ = s;
+				splice(head, s);
+			} else if (!s->sleep_next_) {
+				// Asleep but in no ring (put to sleep by the caller): join as is.
+				s->sleep_next_ = s->sleep_prev_ = s;
+				splice(head, s);
+			} else if (s->sleep_ready_tick_ != current_tick_) {
+				// Asleep in the ring of an island it fell asleep with earlier. Stamp
+				// that whole ring so a second member of it is not spliced twice
+				// (splicing a ring into itself would split it).
+				solid<T> * r = s;
+				do {
+					r->sleep_ready_tick_ = current_tick_;
+					r = r->sleep_next_;
+				} while (r != s);
+				splice(head, s);
+			}
+		}
+	}
+}
+
+template <typename T> void simulator<T>::build_islands() {
+	const int nslots = static_cast<int>(solver_solids_.size());
+	island_parent_.resize(nslots);
+	for (int i = 0; i < nslots; ++i)
+		island_parent_[i] = i;
+	// Path halving; the root of a set is its lowest slot, so island ids below come
+	// out in slot order (awake bodies first, by solve_id_) whatever order the
+	// edges were found in.
+	auto find = [this](int i) {
+		while (island_parent_[i] != i) {
+			island_parent_[i] = island_parent_[island_parent_[i]];
+			i = island_parent_[i];
+		}
+		return i;
+	};
+	auto unite = [&](int i, int j) {
+		i = find(i);
+		j = find(j);
+		if (i < j)
+			island_parent_[j] = i;
+		else if (j < i)
+			island_parent_[i] = j;
+	};
+
+	// Membership: every movable body with a slot — the awake ones, a sleeping one
+	// an awake body is touching this tick (the solve can move it, so it belongs
+	// with its toucher), and the constraint partners of either.
+	const int member = -2;
+	island_of_.assign(nslots, -1);
+	for (int i = 0; i < nslots; ++i) {
+		if (!is_island_breaker(solver_solids_[i]))
+			island_of_[i] = member;
+	}
 	for (auto & p : contact_pairs_) {
-		p.a->pos_correction_.reset();
-		p.b->pos_correction_.reset();
-	}
-	for (int iter = 0; iter < spec_pos_iters_; ++iter) {
-		// With unchanged pseudo-positions, a later NGS pass would visit the
-		// exact same separations. Once a full pass applies no correction, the
-		// remaining iterations cannot make progress.
-		bool corrected = false;
-		for (auto & p : contact_pairs_) {
-			// Only an awake speculative body absorbs correction here: sleeping/static
-			// bodies and sweep_slide bodies are immovable supports (a sweep_slide body
-			// never folds pos_correction_ — it placed itself in Pass A — so giving it a
-			// share would silently drop that correction). Zero their inverse mass so a
-			// speculative body takes the whole correction against such a partner.
-			T inv_a = (p.a->active_ && p.a->uses_speculative_solve()) ? p.inv_ma : zero;
-			T inv_b = (p.b->active_ && p.b->uses_speculative_solve()) ? p.inv_mb : zero;
-			T inv_sum = inv_a + inv_b;
-			if (inv_sum <= zero)
-				continue;
-			// Current separation = the gap at discovery plus how far the running
-			// corrections have already separated this pair along the normal.
-			vec3<T> rel;
-			sub(rel, p.b->pos_correction_, p.a->pos_correction_);
-			T cur_sep = p.separation + dot(rel, p.normal);
-			// Only penetration beyond the slop band is corrected.
-			T pen = -cur_sep - spec_slop_;
-			if (pen <= zero)
+		if (!is_island_breaker(p.a) && !is_island_breaker(p.b))
+			unite(p.index_a, p.index_b);
+	}
+	// A constraint holds its two ends together whether or not they touch. Both
+	// ends of a member's constraints have slots (see solve_contacts).
+	for (int i = 0; i < nslots; ++i) {
+		if (island_of_[i] == -1)
+			continue;
+		for (auto * c : solver_solids_[i]->constraints_) {
+			solid<T> * a = c->start_solid_.get();
+			solid<T> * b = c->end_solid_.get();
+			if (!a || !b || a->simulator_ != this || b->simulator_ != this)
 				continue;
-			T corr = pen * spec_pos_baumgarte_;
-			if (corr <= zero)
+			if (is_island_breaker(a) || is_island_breaker(b))
 				continue;
-			corrected = true;
-			// p.normal points from a toward b: push b along +normal and a along
-			// -normal, each by its share of the inverse mass.
-			if (inv_b > zero) {
-				vec3<T> d;
-				mul(d, p.normal, corr * (inv_b / inv_sum));
-				add(p.b->pos_correction_, d);
-			}
-			if (inv_a > zero) {
-				vec3<T> d;
-				mul(d, p.normal, corr * (inv_a / inv_sum));
-				sub(p.a->pos_correction_, d);
+			unite(a->solver_body_index_, b->solver_body_index_);
+		}
+	}
+
+	// Number the islands in order of their lowest member, then bucket the members
+	// and pairs by island. Both buckets keep their input order, so each island's
+	// pairs are in the order the single global solve would have visited them.
+	islands_.clear();
+	for (int i = 0; i < nslots; ++i) {
+		if (island_of_[i] == -1)
+			continue;
+		const int root = find(i);
+		if (root == i) {
+			island_of_[i] = static_cast<int>(islands_.size());
+			islands_.push_back(island {});
+		} else {
+			island_of_[i] = island_of_[root];
+		}
+		islands_[island_of_[i]].num_solids++;
+	}
+	auto pair_island = [this](const contact_pair & p) {
+		if (!is_island_breaker(p.a))
+			return island_of_[p.index_a];
+		if (!is_island_breaker(p.b))
+			return island_of_[p.index_b];
+		return -1;
+	};
+	for (auto & p : contact_pairs_) {
+		const int id = pair_island(p);
+		if (id >= 0)
+			islands_[id].num_contacts++;
+	}
+	int next_solid = 0;
+	int next_contact = 0;
+	for (auto & isl : islands_) {
+		isl.first_solid = next_solid;
+		isl.first_contact = next_contact;
+		next_solid += isl.num_solids;
+		next_contact += isl.num_contacts;
+	}
+
+	island_solids_.resize(next_solid);
+	island_cursor_.resize(islands_.size());
+	for (size_t k = 0; k < islands_.size(); ++k)
+		island_cursor_[k] = islands_[k].first_solid;
+	for (int i = 0; i < nslots; ++i) {
+		if (island_of_[i] >= 0)
+			island_solids_[island_cursor_[island_of_[i]]++] = solver_solids_[i];
+	}
+
+	island_pair_scratch_.resize(contact_pairs_.size());
+	for (size_t k = 0; k < islands_.size(); ++k)
+		island_cursor_[k] = islands_[k].first_contact;
+	int next_rest = next_contact;  // pairs in no island trail the last island
+	for (auto & p : contact_pairs_) {
+		const int id = pair_island(p);
+		island_pair_scratch_[id >= 0 ? island_cursor_[id]++ : next_rest++] = p;
+	}
+	contact_pairs_.swap(island_pair_scratch_);
+
+	// Color the large islands (see set_colored_solve). Greedy, in the pair order
+	// above: each contact takes the lowest color neither of its movable bodies
+	// already has. A body in one island never appears in another, so the masks are
+	// cleared once for all of them.
+	color_first_.clear();
+	if (!colored_solve_)
+		return;
+	color_mask_.assign(nslots, 0);
+	int counts[max_colors + 1];
+	int cursor[max_colors + 1];
+	for (auto & isl : islands_) {
+		if (isl.num_contacts < colored_solve_min_contacts)
+			continue;
+		contact_pair * const pairs = contact_pairs_.data() + isl.first_contact;
+		pair_color_.resize(isl.num_contacts);
+		std::fill(counts, counts + max_colors + 1, 0);
+		int ncolors = 0;
+		for (int k = 0; k < isl.num_contacts; ++k) {
+			const contact_pair & p = pairs[k];
+			const bool move_a = !is_island_breaker(p.a);
+			const bool move_b = !is_island_breaker(p.b);
+			const std::uint64_t used = (move_a ? color_mask_[p.index_a] : 0) | (move_b ? color_mask_[p.index_b] : 0);
+			int c = 0;
+			while (c < max_colors && (used >> c) & 1)
+				++c;
+			if (c < max_colors) {
+				const std::uint64_t bit = std::uint64_t(1) << c;
+				if (move_a)
+					color_mask_[p.index_a] |= bit;
+				if (move_b)
+					color_mask_[p.index_b] |= bit;
+				if (c + 1 > ncolors)
+					ncolors = c + 1;
 			}
+			pair_color_[k] = c;  // max_colors is the overflow group
+			counts[c]++;
 		}
-		if (!corrected)
-			break;
+		isl.num_colors = ncolors;
+		isl.first_color = static_cast<int>(color_first_.size());
+		int offset = isl.first_contact;
+		for (int c = 0; c < ncolors; ++c) {
+			color_first_.push_back(offset);
+			cursor[c] = offset;
+			offset += counts[c];
+		}
+		color_first_.push_back(offset);
+		cursor[max_colors] = offset;
+		// Stable bucket by color, then copy the island's range back in color order.
+		for (int k = 0; k < isl.num_contacts; ++k)
+			island_pair_scratch_[cursor[pair_color_[k]]++] = pairs[k];
+		std::copy(island_pair_scratch_.begin() + isl.first_contact,
+		          island_pair_scratch_.begin() + isl.first_contact + isl.num_contacts, pairs);
+	}
+}
+
+template <typename T>
+template <typename Fn>
+void simulator<T>::for_each_island(Fn && fn) {
+	const int nislands = static_cast<int>(islands_.size());
+	const int nchunks = thread_count_ < nislands ? thread_count_ : nislands;
+	if (nchunks <= 1) {
+		for (auto & isl : islands_)
+			fn(isl);
+		return;
+	}
+	// Cut the island list into contiguous runs holding about the same number of
+	// contacts, the unit of solver work.
+	island_cursor_.resize(nchunks + 1);
+	const long long total = islands_.back().first_contact + islands_.back().num_contacts;
+	int i = 0;
+	for (int c = 0; c < nchunks; ++c) {
+		island_cursor_[c] = i;
+		const long long limit = total * (c + 1) / nchunks;
+		while (i < nislands && islands_[i].first_contact + islands_[i].num_contacts <= limit)
+			++i;
+	}
+	island_cursor_[nchunks] = nislands;
+	parallel_for(nchunks, [&](int c) {
+		for (int k = island_cursor_[c]; k < island_cursor_[c + 1]; ++k)
+			fn(islands_[k]);
+	});
+}
+
+template <typename T>
+template <typename Fn>
+void simulator<T>::for_each_colored_pair(const island & isl, bool reverse, Fn && fn) {
+	// Below this many contacts per thread, a color is not worth splitting.
+	const int min_chunk = 64;
+	auto run_color = [&](int c) {
+		const int begin = color_first_[isl.first_color + c];
+		const int n = color_first_[isl.first_color + c + 1] - begin;
+		int nchunks = n / min_chunk;
+		if (nchunks > thread_count_)
+			nchunks = thread_count_;
+		if (nchunks < 1)
+			nchunks = 1;
+		parallel_for(nchunks, [&](int k) {
+			const int end = begin + static_cast<int>(static_cast<long long>(n) * (k + 1) / nchunks);
+			for (int i = begin + static_cast<int>(static_cast<long long>(n) * k / nchunks); i < end; ++i)
+				fn(contact_pairs_[i]);
+		});
+	};
+	const int overflow = color_first_[isl.first_color + isl.num_colors];
+	const int end = isl.first_contact + isl.num_contacts;
+	if (reverse) {
+		for (int i = end - 1; i >= overflow; --i)
+			fn(contact_pairs_[i]);
+		for (int c = isl.num_colors - 1; c >= 0; --c)
+			run_color(c);
+	} else {
+		for (int c = 0; c < isl.num_colors; ++c)
+			run_color(c);
+		for (int i = overflow; i < end; ++i)
+			fn(contact_pairs_[i]);
 	}
 }
 
@@ -1533,23 +2500,189 @@ void simulator<T>::trace_segment(collision<T> & result,
                                  const segment<T> & seg,
                                  int collide_with_bits,
                                  solid<T> * ignore) {
-	vec3<T> ep;
-	seg.get_end_point(ep);
-	aa_box<T> total;
-	total.set(seg.origin, seg.origin);
-	total.merge(ep);
-	num_spacial_collection_ =
-	    find_solids_in_aa_box(total, spacial_collection_.data(), static_cast<int>(spacial_collection_.size()));
+	num_spacial_collection_ = find_solids_on_segment(seg, spacial_collection_.data(),
+	                                                 static_cast<int>(spacial_collection_.size()), collide_with_bits);
 	trace_segment_with_current_spacials(result, seg, collide_with_bits, ignore);
 }
 
+template <typename T>
+void simulator<T>::trace_segment(collision<T> & result, const segment<T> & seg, query_scratch & scratch,
+                                 int collide_with_bits, solid<T> * ignore) const {
+	scratch.solids.resize(solids_.size());
+	const int found = find_solids(nullptr, segment_box(seg), scratch.solids.data(),
+	                              static_cast<int>(scratch.solids.size()), collide_with_bits, true);
+	trace_segment_among(result, seg, scratch.solids.data(), found, collide_with_bits, ignore, true);
+}
+
+template <typename T>
+void simulator<T>::for_each_solid_in_aa_box(const aa_box<T> & box, const std::function<bool(solid<T> *)> & fn,
+                                            int collide_with_bits) const {
+	aa_box<T> expanded(box);
+	expanded.mins -= vec3<T>(epsilon_, epsilon_, epsilon_);
+	expanded.maxs += vec3<T>(epsilon_, epsilon_, epsilon_);
+	if (manager_ && manager_->for_each_solid_in_aa_box(expanded, fn, collide_with_bits))
+		return;
+	for (auto & s : solids_) {
+		// -1 means "no filter", as in find_solids.
+		if (collide_with_bits != -1 && (collide_with_bits & s->collision_scope_) == 0)
+			continue;
+		if (test_intersection(expanded, s->world_bound_) && !fn(s.get()))
+			return;
+	}
+}
+
+template <typename T>
+bool simulator<T>::trace_segment_any(const segment<T> & seg, int collide_with_bits, solid<T> * ignore,
+                                     bool with_manager) {
+	// Each candidate is tested as the broad phase meets it, so the first hit
+	// also ends the tree walk.
+	bool hit = false;
+	for_each_solid_in_aa_box(
+	    segment_box(seg),
+	    [&](solid<T> * s2) {
+		    hit = trace_segment_any_among(seg, &s2, 1, collide_with_bits, ignore, false, false);
+		    return !hit;
+	    },
+	    collide_with_bits);
+	return hit || trace_segment_any_among(seg, nullptr, 0, collide_with_bits, ignore, with_manager, false);
+}
+
+template <typename T>
+bool simulator<T>::trace_segment_any(const segment<T> & seg, query_scratch & scratch, int collide_with_bits,
+                                     solid<T> * ignore, bool with_manager) const {
+	scratch.solids.resize(solids_.size());
+	const int found = find_solids(nullptr, segment_box(seg), scratch.solids.data(),
+	                              static_cast<int>(scratch.solids.size()), collide_with_bits, true);
+	return trace_segment_any_among(seg, scratch.solids.data(), found, collide_with_bits, ignore, with_manager, true);
+}
+
+template <typename T>
+void simulator<T>::trace_segments(collision<T> results[], const segment<T> segs[], int count, int collide_with_bits,
+                                  solid<T> * ignore) {
+	if (count <= 0)
+		return;
+	// Each segment's box, grown by epsilon_ as find_solids grows a query.
+	auto box_of = [&](int i) {
+		vec3<T> ep;
+		segs[i].get_end_point(ep);
+		aa_box<T> box;
+		box.set(segs[i].origin, segs[i].origin);
+		box.merge(ep);
+		box.mins -= vec3<T>(epsilon_, epsilon_, epsilon_);
+		box.maxs += vec3<T>(epsilon_, epsilon_, epsilon_);
+		return box;
+	};
+	trace_boxes_.resize(count);
+	aa_box<T> all = box_of(0);
+	for (int i = 0; i < count; ++i) {
+		trace_boxes_[i] = box_of(i);
+		all.merge(trace_boxes_[i]);
+	}
+
+	// Morton order of the box centers, 10 bits an axis across all the boxes, in
+	// float since only the order matters.
+	auto spread = [](std::uint32_t v) {
+		v = (v | (v << 16)) & 0x030000FFu;
+		v = (v | (v << 8)) & 0x0300F00Fu;
+		v = (v | (v << 4)) & 0x030C30C3u;
+		return (v | (v << 2)) & 0x09249249u;
+	};
+	float lo[3], scale[3];
+	for (int axis = 0; axis < 3; ++axis) {
+		lo[axis] = tr::to_float(all.mins[axis]);
+		const float extent = tr::to_float(all.maxs[axis]) - lo[axis];
+		scale[axis] = extent > 0 ? 1023.0f / extent : 0.0f;
+	}
+	trace_order_.resize(count);
+	for (int i = 0; i < count; ++i) {
+		std::uint32_t key = 0;
+		for (int axis = 0; axis < 3; ++axis) {
+			const float c = (tr::to_float(trace_boxes_[i].mins[axis]) + tr::to_float(trace_boxes_[i].maxs[axis])) * 0.5f;
+			key |= spread(static_cast<std::uint32_t>((c - lo[axis]) * scale[axis])) << axis;
+		}
+		trace_order_[i] = { key, i };
+	}
+	std::sort(trace_order_.begin(), trace_order_.end());
+	for (int k = 0; k < count; ++k)
+		trace_boxes_[k] = box_of(trace_order_[k].second);
+
+	// The broad phase runs once per group of neighbouring segments, for the
+	// group's box: the manager's for_each_solid_in_aa_box, or a scan of
+	// solids_. Each segment keeps the part its own box overlaps, in the order
+	// the query found them, which for a tree walk or the scan is the order its
+	// own query would have them.
+	auto half_perimeter = [](const aa_box<T> & b) {
+		return tr::to_float(b.maxs.x - b.mins.x) + tr::to_float(b.maxs.y - b.mins.y) + tr::to_float(b.maxs.z - b.mins.z);
+	};
+	trace_group_.resize(solids_.size());
+	const int capacity = static_cast<int>(solids_.size());
+	for (int start = 0; start < count;) {
+		aa_box<T> group = trace_boxes_[start];
+		float separate = half_perimeter(group);
+		int end = start + 1;
+		for (; end < count && end - start < trace_group_size; ++end) {
+			aa_box<T> merged = group;
+			merged.merge(trace_boxes_[end]);
+			const float size = half_perimeter(trace_boxes_[end]);
+			if (half_perimeter(merged) > separate + size)
+				break;
+			group = merged;
+			separate += size;
+		}
+		int found = 0;
+		auto collect = [&](solid<T> * sp) {
+			if (found < capacity)
+				trace_group_[found++] = sp;
+			return found < capacity;
+		};
+		if (!manager_ || !manager_->for_each_solid_in_aa_box(group, collect, collide_with_bits)) {
+			for (auto & sp : solids_) {
+				if (collide_with_bits != -1 && (collide_with_bits & sp->collision_scope_) == 0)
+					continue;
+				if (test_intersection(group, sp->world_bound_))
+					trace_group_[found++] = sp.get();
+			}
+		}
+		for (int k = start; k < end; ++k) {
+			num_spacial_collection_ = 0;
+			for (int j = 0; j < found; ++j)
+				if (test_intersection(trace_boxes_[k], trace_group_[j]->world_bound_))
+					spacial_collection_[num_spacial_collection_++] = trace_group_[j];
+			const int i = trace_order_[k].second;
+			trace_segment_with_current_spacials(results[i], segs[i], collide_with_bits, ignore);
+		}
+		start = end;
+	}
+}
+
 template <typename T>
 void simulator<T>::trace_solid(collision<T> & result, solid<T> * s, const segment<T> & seg, int collide_with_bits) {
-	vec3<T> end;
-	seg.get_end_point(end);
+	num_spacial_collection_ = find_solids_in_aa_box(solid_trace_box(s, seg), spacial_collection_.data(),
+	                                                static_cast<int>(spacial_collection_.size()), collide_with_bits);
+	trace_solid_with_current_spacials(result, s, seg, collide_with_bits);
+}
+
+template <typename T>
+void simulator<T>::trace_solid(collision<T> & result, solid<T> * s, const segment<T> & seg, query_scratch & scratch,
+                               int collide_with_bits) const {
+	scratch.solids.resize(solids_.size());
+	const int found = find_solids(nullptr, solid_trace_box(s, seg), scratch.solids.data(),
+	                              static_cast<int>(scratch.solids.size()), collide_with_bits, true);
+	vec3<T> pair_normal;
+	trace_solid_among(result, s, seg, scratch.solids.data(), found, collide_with_bits, pair_normal, true);
+}
+
+template <typename T> aa_box<T> simulator<T>::segment_box(const segment<T> & seg) {
+	vec3<T> ep;
+	seg.get_end_point(ep);
 	aa_box<T> box;
 	box.set(seg.origin, seg.origin);
-	box.merge(end);
+	box.merge(ep);
+	return box;
+}
+
+template <typename T> aa_box<T> simulator<T>::solid_trace_box(solid<T> * s, const segment<T> & seg) {
+	aa_box<T> box = segment_box(seg);
 	// Grow by the mover's ORIENTED extent. Adding local_bound_ raw (as this did) gives a
 	// rotated solid a box too small and pointing the wrong way, so a shape whose contact
 	// sits away from the trace origin is rejected before the oriented narrowphase ever
@@ -1558,32 +2691,35 @@ void simulator<T>::trace_solid(collision<T> & result, solid<T> * s, const segmen
 	s->get_bound_about_position(lb);
 	add(box.mins, lb.mins);
 	add(box.maxs, lb.maxs);
-	num_spacial_collection_ =
-	    find_solids_in_aa_box(box, spacial_collection_.data(), static_cast<int>(spacial_collection_.size()));
-	trace_solid_with_current_spacials(result, s, seg, collide_with_bits);
+	return box;
 }
 
-
 template <typename T>
-void simulator<T>::trace_segment_with_current_spacials(collision<T> & result,
-                                                       const segment<T> & seg,
-                                                       int collide_with_bits,
-                                                       solid<T> * ignore) {
+void simulator<T>::trace_segment_among(collision<T> & result,
+                                       const segment<T> & seg,
+                                       solid<T> * const candidates[],
+                                       int count,
+                                       int collide_with_bits,
+                                       solid<T> * ignore,
+                                       bool shared) const {
 	result.reset();
 
 	collision<T> col;
-	for (int i = 0; i < num_spacial_collection_; ++i) {
-		auto * s2 = spacial_collection_[i];
+	for (int i = 0; i < count; ++i) {
+		auto * s2 = candidates[i];
 		if (s2 != ignore && (collide_with_bits & s2->collision_scope_) != 0) {
 			col.time = tr::one();
-			test_segment(col, seg, s2);
+			hop::test_segment(col, seg, s2, epsilon_);
 			hop::merge_collision(result, col, epsilon_, average_normals_);
 		}
 	}
 
 	if (manager_) {
 		col.time = tr::one();
-		manager_->trace_segment(col, seg, collide_with_bits);
+		if (shared)
+			manager_->query_segment(col, seg, collide_with_bits);
+		else
+			manager_->trace_segment(col, seg, collide_with_bits);
 		hop::merge_collision(result, col, epsilon_, average_normals_);
 	}
 
@@ -1594,29 +2730,64 @@ void simulator<T>::trace_segment_with_current_spacials(collision<T> & result,
 }
 
 template <typename T>
-void simulator<T>::trace_solid_with_current_spacials(collision<T> & result,
-                                                     solid<T> * s,
-                                                     const segment<T> & seg,
-                                                     int collide_with_bits) {
+bool simulator<T>::trace_segment_any_among(const segment<T> & seg,
+                                           solid<T> * const candidates[],
+                                           int count,
+                                           int collide_with_bits,
+                                           solid<T> * ignore,
+                                           bool with_manager,
+                                           bool shared) const {
+	collision<T> col;
+	for (int i = 0; i < count; ++i) {
+		auto * s2 = candidates[i];
+		if (s2 != ignore && (collide_with_bits & s2->collision_scope_) != 0) {
+			col.time = tr::one();
+			hop::test_segment(col, seg, s2, epsilon_, true);
+			if (col.time < tr::one())
+				return true;
+		}
+	}
+	if (!with_manager || !manager_)
+		return false;
+	if (!shared)
+		return manager_->trace_segment_any(seg, collide_with_bits);
+	col.time = tr::one();
+	manager_->query_segment(col, seg, collide_with_bits);
+	return col.time < tr::one();
+}
+
+template <typename T>
+void simulator<T>::trace_solid_among(collision<T> & result,
+                                     solid<T> * s,
+                                     const segment<T> & seg,
+                                     solid<T> * const candidates[],
+                                     int count,
+                                     int collide_with_bits,
+                                     vec3<T> & pair_normal,
+                                     bool shared) const {
 	result.reset();
 	if (collide_with_bits == 0)
 		return;
 
 	collision<T> col;
-	for (int i = 0; i < num_spacial_collection_; ++i) {
-		auto * s2 = spacial_collection_[i];
+	for (int i = 0; i < count; ++i) {
+		auto * s2 = candidates[i];
 		if (s != s2 && (collide_with_bits & s2->collision_scope_) != 0 && s->should_collide(s2) &&
 		    s2->should_collide(s)) {
 			col.time = tr::one();
-			test_solid(col, s, seg, s2);
-			hop::merge_collision(result, col, epsilon_, average_normals_, &solid_trace_pair_normal_);
+			hop::test_solid(col, s, seg, s2, epsilon_, T {}, accurate_narrowphase_);
+			hop::merge_collision(result, col, epsilon_, average_normals_, &pair_normal);
 		}
 	}
 
 	if (manager_) {
 		col.time = tr::one();
-		manager_->trace_solid(col, s, seg, collide_with_bits, T {});  // exact: swept query / public API
-		hop::merge_collision(result, col, epsilon_, average_normals_, &solid_trace_pair_normal_);
+		// exact: swept query / public API
+		if (shared)
+			manager_->query_solid(col, s, seg, collide_with_bits, T {});
+		else
+			manager_->trace_solid(col, s, seg, collide_with_bits, T {});
+		hop::merge_collision(result, col, epsilon_, average_normals_, &pair_normal);
 	}
 
 	if (result.time == tr::one()) {
@@ -1855,20 +3026,17 @@ void simulator<T>::solve_contacts(T dt, bool has_speculative) {
 	contact_pairs_.clear();
 	// The iterative solve revisits a body through many contacts. Snapshot the
 	// mutable velocity state into one dense array and let pairs address it by
-	// index, avoiding scattered solid loads/stores in every GS iteration.
-	const int nsolids = static_cast<int>(solids_.size());
-	solver_bodies_.resize(static_cast<size_t>(nsolids) + 1);
-	for (int i = 0; i < nsolids; ++i) {
-		auto * s = solids_[i].get();
-		s->solver_body_index_ = i;
-		solver_bodies_[i].velocity.set(s->velocity_);
-		solver_bodies_[i].angular_velocity.set(s->angular_velocity_);
-	}
-	// Manager-owned geometry resolves through static_world_, which is not in
-	// solids_ but still needs a valid immutable solver-state slot.
-	static_world_.solver_body_index_ = nsolids;
-	solver_bodies_[nsolids].velocity.set(static_world_.velocity_);
-	solver_bodies_[nsolids].angular_velocity.set(static_world_.angular_velocity_);
+	// index, avoiding scattered solid loads/stores in every GS iteration. Only
+	// the awake bodies get a slot up front, in canonical order; a sleeping or
+	// static partner (static_world_ included, for manager-owned geometry)
+	// claims one when its first pair is built below, and a constraint partner
+	// after that. A pile of sleeping bodies nothing touches costs nothing here.
+	solver_bodies_.clear();
+	solver_solids_.clear();
+	const auto & awake = sorted_awake();
+	const int nawake = static_cast<int>(awake.size());
+	for (auto * s : awake)
+		claim_solver_body(s);
 
 	// --- 1. Build the canonical pair list ---
 	// Walk every active solid's cache exactly once. For each refreshed slot,
@@ -1883,10 +3051,8 @@ void simulator<T>::solve_contacts(T dt, bool has_speculative) {
 	// order-induced directional drift; the canonical a<b pair convention is
 	// unaffected — only the build/solve order changes).
 	const bool flip = (current_tick_ & 1) != 0;
-	for (int si = 0; si < nsolids; ++si) {
-		auto * s = solids_[flip ? nsolids - 1 - si : si].get();
-		if (!s->active_)
-			continue;
+	for (int si = 0; si < nawake; ++si) {
+		auto * s = awake[flip ? nawake - 1 - si : si];
 		for (int i = 0; i < s->touch_count_; ++i) {
 			auto & slot = s->touches_[i];
 			if (slot.last_tick != current_tick_)
@@ -1915,8 +3081,8 @@ void simulator<T>::solve_contacts(T dt, bool has_speculative) {
 			contact_pair p;
 			p.a = a;
 			p.b = b;
-			p.index_a = a->solver_body_index_;
-			p.index_b = b->solver_body_index_;
+			p.index_a = claim_solver_body(a);
+			p.index_b = claim_solver_body(b);
 			// pair.normal: points from a's free side toward b (i.e., the
 			// direction that pushes b away from a when we apply +λ to b's
 			// velocity along it).
@@ -2054,6 +3220,25 @@ void simulator<T>::solve_contacts(T dt, bool has_speculative) {
 		}
 	}
 
+	// A constraint holds its ends in one island whether or not they touch, so
+	// the far end of every movable body's constraints needs a slot too. The list
+	// grows as it is walked, which follows constraint chains to their ends.
+	for (size_t k = 0; k < solver_solids_.size(); ++k) {
+		solid<T> * s = solver_solids_[k];
+		if (is_island_breaker(s))
+			continue;
+		for (auto * c : s->constraints_) {
+			solid<T> * a = c->start_solid_.get();
+			solid<T> * b = c->end_solid_.get();
+			if (!a || !b || a->simulator_ != this || b->simulator_ != this)
+				continue;
+			solid<T> * other = a == s ? b : a;
+			if (!is_island_breaker(other))
+				claim_solver_body(other);
+		}
+	}
+
+	build_islands();
 	if (contact_pairs_.empty())
 		return;
 
@@ -2085,117 +3270,6 @@ void simulator<T>::solve_contacts(T dt, bool has_speculative) {
 		}
 	};
 
-	// --- 2. Snapshot pre-solver velocities ---
-	// Snapshot vn0 (relative normal velocity before any impulses run this tick)
-	// to guard restitution. The restitution target is only activated for pairs
-	// that were closing at this moment; a pair that another constraint (or the
-	// warm-start boost) has already separated should not receive a bounce
-	// impulse based on stale data.
-	for (auto & p : contact_pairs_) {
-		vec3<T> vrel0;
-		contact_point_vrel(p, vrel0);
-		p.vn0 = dot(vrel0, p.normal);
-		// Restitution is paid on the speed the bodies were ALREADY closing at, not on
-		// the speed this tick's gravity just handed them. Pass A integrates v += a·dt
-		// before the solve, so vn0 arrives g·dt hotter than the approach really was, and
-		// bouncing back cor·|vn0| returns a slice of that increment as free energy —
-		// every bounce, forever. It converges: the ball settles at exactly
-		// v = cor·g·dt/(1-cor) and hops there for good. Under the micro threshold
-		// (cor < ~0.86 at 60Hz and 1g) restitution switches off before the ball reaches
-		// the fixed point and it sleeps, which is why only the bounciest bodies hung.
-		// Subtracting the tick's own external increment makes the reference the approach
-		// the bodies arrived with, so |target| <= |approach| holds against gravity too.
-		vec3<T> dv_ext;
-		sub(dv_ext, p.b->ext_dv_, p.a->ext_dv_); // same b − a convention as vrel
-		const T vn_rest = p.vn0 - dot(dv_ext, p.normal);
-		// Restitution target and the λ mass-scale are constant across all GS
-		// sweeps for this pair, so derive them once here rather than per
-		// iteration in the hot loop below.
-		// Unified speculative target, by collision class. It is mode-agnostic: a
-		// sweep_slide body has already been snapped to its contact, so its recorded
-		// gap is <= slop and only the first and third branches can fire — exactly the
-		// legacy `(-vn0 > micro) ? -cor*vn0 : 0` target. A speculative body can also
-		// carry a positive gap (margin-shell discovery) and take the middle branch.
-		//  - genuinely closing (vn0 below -micro): restitution bounce, even with a
-		//    gap still remaining (discovery is speculative, so a fast body is found
-		//    before it reaches the surface);
-		//  - slow approach with a gap: cap so the body closes at most the gap this
-		//    tick (vn >= -(gap - slop)/dt), stopping fast bodies short of tunneling,
-		//    with no bounce;
-		//  - at/inside the contact and not closing (resting pile): drive vn to 0.
-		// Existing penetration is removed positionally by correct_positions (NGS),
-		// not here, so the velocity solve adds no energy.
-		const T gap = p.separation;
-		if (-vn_rest > micro_collision_threshold_) {
-			// Genuine closing collision: bounce at cor times the inbound speed even
-			// when a speculative gap still remains. Withholding restitution until
-			// gap<=slop (as this once did) let the approach cap below bleed off the
-			// entire inbound velocity first, so the body reached the surface with
-			// ~zero closing speed and never bounced. cor<=1 keeps |target|<=|vn_rest|,
-			// so restitution stays dissipative; the micro threshold lets a slow,
-			// settling body fall through to the cap.
-			p.target = -p.cor * vn_rest;
-		} else if (gap > spec_slop_) {
-			p.target = -(gap - spec_slop_) * inv_dt;
-		} else {
-			p.target = zero_val;
-		}
-		p.friction_scale = (p.inv_m_sum > zero_val) ? -one / p.inv_m_sum : zero_val;
-		// Tangent λ scale. The linear path reuses friction_scale; the angular path
-		// needs the tangent effective mass, but only when the pair actually has
-		// friction (the friction sweep below skips mu_s<=0 && mu_d<=0 pairs, so an
-		// angular-but-frictionless pair never reads friction_scale_t — leave it 0).
-		if (!p.has_angular) {
-			p.friction_scale_t = p.friction_scale;
-		} else if (p.mu_s > zero_val || p.mu_d > zero_val) {
-			// Tangent direction: the current slip, or — when the contact isn't
-			// sliding — an arbitrary unit perpendicular of n.
-			vec3<T> vt0, vn_vec;
-			mul(vn_vec, p.normal, p.vn0);
-			sub(vt0, vrel0, vn_vec);
-			vec3<T> t0;
-			if (!normalize_carefully(t0, vt0, epsilon_)) {
-				// |n.x| < 0.7 ⇒ (1,0,0)×n = (0, n.z, -n.y); else (0,1,0)×n = (-n.z, 0, n.x).
-				if (std::abs(tr::to_float(p.normal.x)) < 0.7f)
-					t0.set(zero_val, p.normal.z, -p.normal.y);
-				else
-					t0.set(-p.normal.z, zero_val, p.normal.x);
-				normalize(t0);
-			}
-			T eff_t = angular_eff_mass<T>(p, t0);
-			p.friction_scale_t = eff_t > zero_val ? -one / eff_t : zero_val;
-		}
-	}
-
-	// --- 3. Warm-start ---
-	// In hop bodies are stateful; their velocity already includes the effect of
-	// last tick's impulses. Warm-starting is therefore incremental: we keep
-	// p.accum_n / p.accum_t from the cache as GS starting points but DO NOT
-	// re-apply them to velocity (that would double-count).
-	//
-	// Exception: a pair that is *separating* this tick (vn0 > 0) carries no
-	// sustained load — typically the tick right after a bounce. The clamp
-	// new_acc >= 0 normally stops the normal constraint from pulling bodies
-	// together, but a non-zero warm-started accum_n gives the GS a budget it can
-	// spend pulling the pair back: with target 0 and a separating vn, lambda_n is
-	// negative, and as long as accum_n stays >= 0 that negative impulse is applied
-	// — cancelling the separation and freezing the body it just bounced off of.
-	// (Most visible in fixed-point, where the post-bounce snap can land a hair
-	// inside the contact, so it gets re-recorded while separating.) Drop the warm
-	// start for separating pairs so they can only push, never pull back.
-	for (auto & p : contact_pairs_) {
-		if (p.vn0 > zero_val) {
-			p.accum_n = zero_val;
-			p.accum_t.reset();
-		}
-	}
-
-	// --- 4. Gauss–Seidel sweeps ---
-	// Each iteration solves the normal constraint (clamped accumulated
-	// impulse ≥ 0 → no sticky pull) and then the friction constraint
-	// (Coulomb cone clamped to the current accumulated normal). Order is
-	// normal-then-friction so friction sees a meaningful normal load even
-	// on the very first iteration.
 	// Split a constraint impulse `delta` (a-side convention) across the pair's
 	// linear velocities by inverse mass — the shared linear half of both impulse
 	// appliers below. The inverse masses are passed explicitly (rather than read
@@ -2287,154 +3361,307 @@ void simulator<T>::solve_contacts(T dt, bool has_speculative) {
 			apply_normal_impulse(p, effective, inv_a, inv_b);
 	};
 
-	// Restitution note: p.target separates the pair at `cor` times the relative
-	// normal velocity it was *actually* closing at when the solver began (vn0,
-	// measured along this same pair normal). Because |target| = cor·|vn0| ≤ |vn0|
-	// for cor ≤ 1, the post-solve separation can never exceed the approach —
-	// restitution is guaranteed dissipative. Earlier this targeted cor·impact_speed
-	// (max approach over the tick's sub-steps, per-contact TOI normal); that can
-	// exceed |vn0|, giving an effective COR > 1 that compounded across a deep
-	// frictionless pile and ran energy away (KE → 1e7, balls flung through the
-	// floor). impact_speed is still recorded for wake/callback logic; it must not
-	// drive the restitution target.
-	const int npairs = static_cast<int>(contact_pairs_.size());
-	for (int iter = 0; iter < solver_iterations_; ++iter) {
-		// Normal sweep (flip direction each tick — see the build-loop comment).
-		// eff_n == inv_m_sum on the non-angular path, so the guard/solve are
-		// bit-identical there; the angular path folds in the lever-arm mass.
-		for (int k = 0; k < npairs; ++k) {
-			auto & p = contact_pairs_[flip ? npairs - 1 - k : k];
-			if (p.eff_n <= zero_val)
-				continue;
-			solve_normal(p, p.inv_ma, p.inv_mb, p.eff_n);
-		}
-		// Friction sweep (same per-tick flip)
-		for (int k = 0; k < npairs; ++k) {
-			auto & p = contact_pairs_[flip ? npairs - 1 - k : k];
-			if (p.eff_n <= zero_val)
-				continue;
-			if (p.accum_n <= zero_val || (p.mu_s <= zero_val && p.mu_d <= zero_val))
-				continue;
-			vec3<T> vrel;
-			contact_point_vrel(p, vrel);  // (v + ω×r) at the contact, or v_b−v_a+v_bias on the linear path
-			T vn = dot(vrel, p.normal);
-			vec3<T> vn_vec;
-			mul(vn_vec, p.normal, vn);
-			vec3<T> vt;
-			sub(vt, vrel, vn_vec);  // tangential relative velocity
-			// λ_t = −v_t / m_t. Non-angular: m_t = inv_m_sum (cached friction_scale).
-			// Angular (Phase 9): the tangent effective mass along the slip direction,
-			// so a tangential contact also torques the body (rolling).
-			vec3<T> lambda_t;
-			mul(lambda_t, vt, p.friction_scale_t);
-			vec3<T> new_accum_t;
-			add(new_accum_t, p.accum_t, lambda_t);
-			// Coulomb stick/slip: the contact holds (static) as long as the
-			// tangential impulse needed to cancel sliding stays within the
-			// static cone mu_s·N. Once that's exceeded the contact slips and
-			// friction drops to the kinetic cone mu_d·N. The `max_d < mag` guard
-			// scales down only — it skips the degenerate mu_d > mu_s case, which
-			// would otherwise scale the impulse *up* and inject energy.
-			T mag = length(new_accum_t);
-			T max_s = p.mu_s * p.accum_n;
-			if (mag > max_s && mag > zero_val) {
-				T max_d = p.mu_d * p.accum_n;
-				if (max_d < mag)
-					mul(new_accum_t, max_d / mag);
-			}
-			vec3<T> delta;
-			sub(delta, new_accum_t, p.accum_t);
-			p.accum_t.set(new_accum_t);
-			if (length_squared(delta) > zero_val) {
-				apply_pair_impulse(p, delta, p.inv_ma, p.inv_mb);
-			}
-		}
-	}
-
-	// --- 4b. Shock propagation ---
-	// Plain Gauss–Seidel transmits one layer of support per sweep, so an N-deep
-	// pile needs ~N sweeps before the bottom contacts carry the weight above them.
-	// With a fixed iteration budget a tall pile stays under-supported: it
-	// compresses into penetration (sinks), and the never-zeroed normal velocities
-	// keep the bottom layer churning instead of sleeping. Shock propagation fixes
-	// this in O(1) sweeps: walk the contacts from the support end up the gravity
-	// chain and, as each body's support-from-below is resolved, freeze it into a
-	// rigid anchor (effective inverse mass 0) so the body above solves against firm
-	// ground and its reaction can't shove the support back down. Normal-only —
-	// friction and restitution are already handled by the GS loop above.
-	// Speculative path only; needs a gravity direction to define "down" (a zero-g
-	// gas has no stacking chain to propagate, so skip it).
 	const bool have_gravity =
 	    gravity_.x != zero_val || gravity_.y != zero_val || gravity_.z != zero_val;
-	if (has_speculative && spec_shock_iters_ > 0 && npairs > 0 && have_gravity) {
-		// A body is a standing anchor from the outset if it can't move (static /
-		// infinite mass) or is asleep (a settled lower layer supporting the rest).
-		auto pre_frozen = [zero_val](const solid<T> * s, T inv_m) {
-			return inv_m <= zero_val || !s->active_;
+
+	// Steps 2-5 run island by island (see build_islands). An island shares no
+	// movable body with another, so solving them one after another — or at the same
+	// time — gives the same result as one sweep over every pair.
+	auto solve_island = [&](const island & isl) {
+		contact_pair * const pairs = contact_pairs_.data() + isl.first_contact;
+		const int npairs = isl.num_contacts;
+		// Visit every pair of the island: in pair order (reversed when asked), or
+		// color by color for a colored island (see set_colored_solve).
+		auto for_pairs = [&](bool reverse, auto && fn) {
+			if (isl.num_colors > 0) {
+				for_each_colored_pair(isl, reverse, fn);
+				return;
+			}
+			for (int k = 0; k < npairs; ++k)
+				fn(pairs[reverse ? npairs - 1 - k : k]);
 		};
-		// "Support depth" along gravity: dot(position, gravity_) grows the further a
-		// body sits down the gravity vector, so the deeper body of a pair is the one
-		// nearer the anchor (it supports the other). Raw dot — unnormalized gravity
-		// scales every depth equally, leaving the ordering unchanged. Positions are
-		// frozen during the velocity solve, so each pair's depth key and deeper-body
-		// ("lo") are computed once here and reused by both the sort and every pass.
-		shock_order_.resize(npairs);
-		shock_key_.resize(npairs);
-		shock_lo_.resize(npairs);
-		for (int k = 0; k < npairs; ++k) {
-			const contact_pair & p = contact_pairs_[k];
-			T da = dot(p.a->position_, gravity_);
-			T db = dot(p.b->position_, gravity_);
-			shock_order_[k] = k;
-			shock_key_[k] = tr::max_val(da, db);
-			shock_lo_[k] = da >= db ? p.a : p.b;
-		}
-		// Order contacts support-end-first: descending depth, so a body's contacts
-		// from below are visited before the contacts it supports from above.
-		// stable_sort keeps the canonical pair order for equal depths, so the sweep
-		// stays deterministic (fixed-point included).
-		std::stable_sort(shock_order_.begin(), shock_order_.end(),
-		                 [this](int i, int j) { return shock_key_[i] > shock_key_[j]; });
-		for (int pass = 0; pass < spec_shock_iters_; ++pass) {
-			// Re-seed the freeze state each pass: only the standing anchors start
-			// frozen; the support-end-first walk re-freezes the rest against the
-			// updated velocities.
-			for (auto & p : contact_pairs_) {
-				p.a->solve_frozen_ = pre_frozen(p.a, p.inv_ma);
-				p.b->solve_frozen_ = pre_frozen(p.b, p.inv_mb);
+
+		// --- 2. Snapshot pre-solver velocities ---
+		// Snapshot vn0 (relative normal velocity before any impulses run this tick)
+		// to guard restitution. The restitution target is only activated for pairs
+		// that were closing at this moment; a pair that another constraint (or the
+		// warm-start boost) has already separated should not receive a bounce
+		// impulse based on stale data.
+		for_pairs(false, [&](contact_pair & p) {
+			vec3<T> vrel0;
+			contact_point_vrel(p, vrel0);
+			p.vn0 = dot(vrel0, p.normal);
+			// Restitution is paid on the speed the bodies were ALREADY closing at, not on
+			// the speed this tick's gravity just handed them. Pass A integrates v += a·dt
+			// before the solve, so vn0 arrives g·dt hotter than the approach really was, and
+			// bouncing back cor·|vn0| returns a slice of that increment as free energy —
+			// every bounce, forever. It converges: the ball settles at exactly
+			// v = cor·g·dt/(1-cor) and hops there for good. Under the micro threshold
+			// (cor < ~0.86 at 60Hz and 1g) restitution switches off before the ball reaches
+			// the fixed point and it sleeps, which is why only the bounciest bodies hung.
+			// Subtracting the tick's own external increment makes the reference the approach
+			// the bodies arrived with, so |target| <= |approach| holds against gravity too.
+			vec3<T> dv_ext;
+			sub(dv_ext, p.b->ext_dv_, p.a->ext_dv_); // same b − a convention as vrel
+			const T vn_rest = p.vn0 - dot(dv_ext, p.normal);
+			// Restitution target and the λ mass-scale are constant across all GS
+			// sweeps for this pair, so derive them once here rather than per
+			// iteration in the hot loop below.
+			// Unified speculative target, by collision class. It is mode-agnostic: a
+			// sweep_slide body has already been snapped to its contact, so its recorded
+			// gap is <= slop and only the first and third branches can fire — exactly the
+			// legacy `(-vn0 > micro) ? -cor*vn0 : 0` target. A speculative body can also
+			// carry a positive gap (margin-shell discovery) and take the middle branch.
+			//  - genuinely closing (vn0 below -micro): restitution bounce, even with a
+			//    gap still remaining (discovery is speculative, so a fast body is found
+			//    before it reaches the surface);
+			//  - slow approach with a gap: cap so the body closes at most the gap this
+			//    tick (vn >= -(gap - slop)/dt), stopping fast bodies short of tunneling,
+			//    with no bounce;
+			//  - at/inside the contact and not closing (resting pile): drive vn to 0.
+			// Existing penetration is removed positionally by correct_positions (NGS),
+			// not here, so the velocity solve adds no energy.
+			const T gap = p.separation;
+			if (-vn_rest > micro_collision_threshold_) {
+				// Genuine closing collision: bounce at cor times the inbound speed even
+				// when a speculative gap still remains. Withholding restitution until
+				// gap<=slop (as this once did) let the approach cap below bleed off the
+				// entire inbound velocity first, so the body reached the surface with
+				// ~zero closing speed and never bounced. cor<=1 keeps |target|<=|vn_rest|,
+				// so restitution stays dissipative; the micro threshold lets a slow,
+				// settling body fall through to the cap.
+				p.target = -p.cor * vn_rest;
+			} else if (gap > spec_slop_) {
+				p.target = -(gap - spec_slop_) * inv_dt;
+			} else {
+				p.target = zero_val;
 			}
-			for (int oi = 0; oi < npairs; ++oi) {
-				int idx = shock_order_[oi];
-				contact_pair & p = contact_pairs_[idx];
-				// The deeper (more-anchored) body has had its support-from-below
-				// resolved by now — earlier in the walk — so freeze it: it anchors
-				// this contact and everything above it. Frozen bodies contribute zero
-				// effective inverse mass, so the solve drives the free body alone and
-				// its reaction can't shove the support back down.
-				shock_lo_[idx]->solve_frozen_ = true;
-				T inv_a = p.a->solve_frozen_ ? zero_val : p.inv_ma;
-				T inv_b = p.b->solve_frozen_ ? zero_val : p.inv_mb;
-				T inv_sum = inv_a + inv_b;
-				if (inv_sum <= zero_val)
-					continue;
-				solve_normal(p, inv_a, inv_b, inv_sum);
+			p.friction_scale = (p.inv_m_sum > zero_val) ? -one / p.inv_m_sum : zero_val;
+			// Tangent λ scale. The linear path reuses friction_scale; the angular path
+			// needs the tangent effective mass, but only when the pair actually has
+			// friction (the friction sweep below skips mu_s<=0 && mu_d<=0 pairs, so an
+			// angular-but-frictionless pair never reads friction_scale_t — leave it 0).
+			if (!p.has_angular) {
+				p.friction_scale_t = p.friction_scale;
+			} else if (p.mu_s > zero_val || p.mu_d > zero_val) {
+				// Tangent direction: the current slip, or — when the contact isn't
+				// sliding — an arbitrary unit perpendicular of n.
+				vec3<T> vt0, vn_vec;
+				mul(vn_vec, p.normal, p.vn0);
+				sub(vt0, vrel0, vn_vec);
+				vec3<T> t0;
+				if (!normalize_carefully(t0, vt0, epsilon_)) {
+					// |n.x| < 0.7 ⇒ (1,0,0)×n = (0, n.z, -n.y); else (0,1,0)×n = (-n.z, 0, n.x).
+					if (std::abs(tr::to_float(p.normal.x)) < 0.7f)
+						t0.set(zero_val, p.normal.z, -p.normal.y);
+					else
+						t0.set(-p.normal.z, zero_val, p.normal.x);
+					normalize(t0);
+				}
+				T eff_t = angular_eff_mass<T>(p, t0);
+				p.friction_scale_t = eff_t > zero_val ? -one / eff_t : zero_val;
 			}
-		}
-	}
+		});
 
-	// --- 5. Writeback ---
-	// Store the converged per-pair impulses back into both sides' cache slots
-	// so next tick's warm-start picks up where we left off.
-	for (auto & p : contact_pairs_) {
-		if (p.slot_a) {
-			p.slot_a->accum_n = p.accum_n;
-			neg(p.slot_a->accum_t, p.accum_t);
+		// --- 3. Warm-start ---
+		// In hop bodies are stateful; their velocity already includes the effect of
+		// last tick's impulses. Warm-starting is therefore incremental: we keep
+		// p.accum_n / p.accum_t from the cache as GS starting points but DO NOT
+		// re-apply them to velocity (that would double-count).
+		//
+		// Exception: a pair that is *separating* this tick (vn0 > 0) carries no
+		// sustained load — typically the tick right after a bounce. The clamp
+		// new_acc >= 0 normally stops the normal constraint from pulling bodies
+		// together, but a non-zero warm-started accum_n gives the GS a budget it can
+		// spend pulling the pair back: with target 0 and a separating vn, lambda_n is
+		// negative, and as long as accum_n stays >= 0 that negative impulse is applied
+		// — cancelling the separation and freezing the body it just bounced off of.
+		// (Most visible in fixed-point, where the post-bounce snap can land a hair
+		// inside the contact, so it gets re-recorded while separating.) Drop the warm
+		// start for separating pairs so they can only push, never pull back.
+		for_pairs(false, [&](contact_pair & p) {
+			if (p.vn0 > zero_val) {
+				p.accum_n = zero_val;
+				p.accum_t.reset();
+			}
+		});
+
+		// --- 4. Gauss–Seidel sweeps ---
+		// Each iteration solves the normal constraint (clamped accumulated
+		// impulse ≥ 0 → no sticky pull) and then the friction constraint
+		// (Coulomb cone clamped to the current accumulated normal). Order is
+		// normal-then-friction so friction sees a meaningful normal load even
+		// on the very first iteration.
+		// Restitution note: p.target separates the pair at `cor` times the relative
+		// normal velocity it was *actually* closing at when the solver began (vn0,
+		// measured along this same pair normal). Because |target| = cor·|vn0| ≤ |vn0|
+		// for cor ≤ 1, the post-solve separation can never exceed the approach —
+		// restitution is guaranteed dissipative. Earlier this targeted cor·impact_speed
+		// (max approach over the tick's sub-steps, per-contact TOI normal); that can
+		// exceed |vn0|, giving an effective COR > 1 that compounded across a deep
+		// frictionless pile and ran energy away (KE → 1e7, balls flung through the
+		// floor). impact_speed is still recorded for wake/callback logic; it must not
+		// drive the restitution target.
+		for (int iter = 0; iter < solver_iterations_; ++iter) {
+			// Normal sweep (flip direction each tick — see the build-loop comment).
+			// eff_n == inv_m_sum on the non-angular path, so the guard/solve are
+			// bit-identical there; the angular path folds in the lever-arm mass.
+			for_pairs(flip, [&](contact_pair & p) {
+				if (p.eff_n <= zero_val)
+					return;
+				solve_normal(p, p.inv_ma, p.inv_mb, p.eff_n);
+			});
+			// Friction sweep (same per-tick flip)
+			for_pairs(flip, [&](contact_pair & p) {
+				if (p.eff_n <= zero_val)
+					return;
+				if (p.accum_n <= zero_val || (p.mu_s <= zero_val && p.mu_d <= zero_val))
+					return;
+				vec3<T> vrel;
+				contact_point_vrel(p, vrel);  // (v + ω×r) at the contact, or v_b−v_a+v_bias on the linear path
+				T vn = dot(vrel, p.normal);
+				vec3<T> vn_vec;
+				mul(vn_vec, p.normal, vn);
+				vec3<T> vt;
+				sub(vt, vrel, vn_vec);  // tangential relative velocity
+				// λ_t = −v_t / m_t. Non-angular: m_t = inv_m_sum (cached friction_scale).
+				// Angular (Phase 9): the tangent effective mass along the slip direction,
+				// so a tangential contact also torques the body (rolling).
+				vec3<T> lambda_t;
+				mul(lambda_t, vt, p.friction_scale_t);
+				vec3<T> new_accum_t;
+				add(new_accum_t, p.accum_t, lambda_t);
+				// Coulomb stick/slip: the contact holds (static) as long as the
+				// tangential impulse needed to cancel sliding stays within the
+				// static cone mu_s·N. Once that's exceeded the contact slips and
+				// friction drops to the kinetic cone mu_d·N. The `max_d < mag` guard
+				// scales down only — it skips the degenerate mu_d > mu_s case, which
+				// would otherwise scale the impulse *up* and inject energy.
+				T mag = length(new_accum_t);
+				T max_s = p.mu_s * p.accum_n;
+				if (mag > max_s && mag > zero_val) {
+					T max_d = p.mu_d * p.accum_n;
+					if (max_d < mag)
+						mul(new_accum_t, max_d / mag);
+				}
+				vec3<T> delta;
+				sub(delta, new_accum_t, p.accum_t);
+				p.accum_t.set(new_accum_t);
+				if (length_squared(delta) > zero_val) {
+					apply_pair_impulse(p, delta, p.inv_ma, p.inv_mb);
+				}
+			});
 		}
-		if (p.slot_b) {
-			p.slot_b->accum_n = p.accum_n;
-			p.slot_b->accum_t.set(p.accum_t);
+
+		// --- 4b. Shock propagation ---
+		// Plain Gauss–Seidel transmits one layer of support per sweep, so an N-deep
+		// pile needs ~N sweeps before the bottom contacts carry the weight above them.
+		// With a fixed iteration budget a tall pile stays under-supported: it
+		// compresses into penetration (sinks), and the never-zeroed normal velocities
+		// keep the bottom layer churning instead of sleeping. Shock propagation fixes
+		// this in O(1) sweeps: walk the contacts from the support end up the gravity
+		// chain and, as each body's support-from-below is resolved, freeze it into a
+		// rigid anchor (effective inverse mass 0) so the body above solves against firm
+		// ground and its reaction can't shove the support back down. Normal-only —
+		// friction and restitution are already handled by the GS loop above.
+		// Speculative path only; needs a gravity direction to define "down" (a zero-g
+		// gas has no stacking chain to propagate, so skip it).
+		if (has_speculative && spec_shock_iters_ > 0 && npairs > 0 && have_gravity) {
+			// A body is a standing anchor from the outset if it can't move (static /
+			// infinite mass) or is asleep (a settled lower layer supporting the rest):
+			// solver_body::anchored, set when the slot was claimed.
+			// "Support depth" along gravity: dot(position, gravity_) grows the further a
+			// body sits down the gravity vector, so the deeper body of a pair is the one
+			// nearer the anchor (it supports the other). Raw dot — unnormalized gravity
+			// scales every depth equally, leaving the ordering unchanged. Positions are
+			// frozen during the velocity solve, so each pair's depth key and deeper-body
+			// ("lo") are computed once here and reused by both the sort and every pass.
+			// The scratch arrays are sized for every pair; each island uses its own span.
+			int * const order = shock_order_.data() + isl.first_contact;
+			T * const key = shock_key_.data() + isl.first_contact;
+			int * const lo = shock_lo_.data() + isl.first_contact;
+			for (int k = 0; k < npairs; ++k) {
+				const contact_pair & p = pairs[k];
+				T da = dot(p.a->position_, gravity_);
+				T db = dot(p.b->position_, gravity_);
+				order[k] = k;
+				key[k] = tr::max_val(da, db);
+				lo[k] = da >= db ? p.index_a : p.index_b;
+			}
+			// Order contacts support-end-first: descending depth, so a body's contacts
+			// from below are visited before the contacts it supports from above.
+			// stable_sort keeps the canonical pair order for equal depths, so the sweep
+			// stays deterministic (fixed-point included).
+			std::stable_sort(order, order + npairs, [key](int i, int j) { return key[i] > key[j]; });
+			for (int pass = 0; pass < spec_shock_iters_; ++pass) {
+				// Re-seed the freeze state each pass: only the standing anchors start
+				// frozen; the support-end-first walk re-freezes the rest against the
+				// updated velocities. An immovable body's flag is never consulted (its
+				// inverse mass is already zero) and is shared between islands, so it
+				// is left alone.
+				for (int k = 0; k < npairs; ++k) {
+					const contact_pair & p = pairs[k];
+					solver_body & sa = solver_bodies_[p.index_a];
+					solver_body & sb = solver_bodies_[p.index_b];
+					if (p.inv_ma > zero_val)
+						sa.frozen = sa.anchored;
+					if (p.inv_mb > zero_val)
+						sb.frozen = sb.anchored;
+				}
+				for (int oi = 0; oi < npairs; ++oi) {
+					int idx = order[oi];
+					contact_pair & p = pairs[idx];
+					// The deeper (more-anchored) body has had its support-from-below
+					// resolved by now — earlier in the walk — so freeze it: it anchors
+					// this contact and everything above it. Frozen bodies contribute zero
+					// effective inverse mass, so the solve drives the free body alone and
+					// its reaction can't shove the support back down.
+					solver_body & anchor = solver_bodies_[lo[idx]];
+					if (anchor.inv_mass > zero_val)
+						anchor.frozen = true;
+					T inv_a = solver_bodies_[p.index_a].frozen ? zero_val : p.inv_ma;
+					T inv_b = solver_bodies_[p.index_b].frozen ? zero_val : p.inv_mb;
+					T inv_sum = inv_a + inv_b;
+					if (inv_sum <= zero_val)
+						continue;
+					solve_normal(p, inv_a, inv_b, inv_sum);
+				}
+			}
 		}
-	}
+
+		// --- 5. Writeback ---
+		// Store the converged per-pair impulses back into both sides' cache slots
+		// so next tick's warm-start picks up where we left off.
+		for_pairs(false, [](contact_pair & p) {
+			if (p.slot_a) {
+				p.slot_a->accum_n = p.accum_n;
+				neg(p.slot_a->accum_t, p.accum_t);
+			}
+			if (p.slot_b) {
+				p.slot_b->accum_n = p.accum_n;
+				p.slot_b->accum_t.set(p.accum_t);
+			}
+		});
+	};
+	shock_order_.resize(contact_pairs_.size());
+	shock_key_.resize(contact_pairs_.size());
+	shock_lo_.resize(contact_pairs_.size());
+	// A colored island splits its own solve across the threads, so it runs on its
+	// own after the others.
+	for_each_island([&](const island & isl) {
+		if (isl.num_colors == 0)
+			solve_island(isl);
+	});
+	for (auto & isl : islands_)
+		if (isl.num_colors > 0)
+			solve_island(isl);
+	// Pairs between two immovable bodies take no impulse, but they still get the
+	// warm-start reset and writeback, as the single global solve gave them.
+	island rest;
+	rest.first_contact = islands_.empty() ? 0 : islands_.back().first_contact + islands_.back().num_contacts;
+	rest.num_contacts = static_cast<int>(contact_pairs_.size()) - rest.first_contact;
+	if (rest.num_contacts > 0)
+		solve_island(rest);
 
 	// --- 6. Cap solver-mutated velocities, then wake perturbed partners ---
 	// Cap: the per-body velocity cap in update_solid runs at integration time —
@@ -2478,11 +3705,14 @@ void simulator<T>::solve_contacts(T dt, bool has_speculative) {
 		finalize(p.b, p.index_b, p.inv_mb);
 	}
 	// Commit the dense scratch state once the iterative solve, cap, and wake
-	// decisions are complete. static_world_ has no entry in solids_ and remains
-	// immutable.
-	for (int i = 0; i < nsolids; ++i) {
-		solids_[i]->velocity_.set(solver_bodies_[i].velocity);
-		solids_[i]->angular_velocity_.set(solver_bodies_[i].angular_velocity);
+	// decisions are complete. static_world_ remains immutable. The slots stay
+	// claimed for correct_positions and Pass B.
+	for (size_t i = 0; i < solver_solids_.size(); ++i) {
+		solid<T> * s = solver_solids_[i];
+		if (s != &static_world_) {
+			s->velocity_.set(solver_bodies_[i].velocity);
+			s->angular_velocity_.set(solver_bodies_[i].angular_velocity);
+		}
 	}
 }
 
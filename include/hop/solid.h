@@ -65,6 +65,8 @@ public:
 		T          separation {};     // signed gap along normal at discovery: 0 touching, <0 penetrating (speculative target)
 		int        last_tick = -1;    // refresh marker; stale slots are skipped by the solver
 		int        pair_built_tick = -1; // bumped to current_tick when the solver has already built a pair via this slot's twin (dedup)
+		solid<T> * linked = nullptr;  // the partner whose touched_by_ lists this solid for this slot (see simulator::link_touches)
+		int        linked_index = -1; // that entry's position in linked->touched_by_
 	};
 	static constexpr int max_touches = 12;
 
@@ -85,7 +87,11 @@ public:
 		shapes_.clear();
 	}
 
+	// Restore the default state. Refused while the solid is added to a
+	// simulator, whose solid and awake lists still index it: remove it first.
 	void reset() {
+		if (simulator_)
+			return;
 		destroy();
 		scope_ = -1;
 		collision_scope_ = -1;
@@ -115,12 +121,19 @@ public:
 		world_bound_.reset();
 		collision_callback_ = nullptr;
 		user_data_ = nullptr;
+		manager_proxy_ = -1;
 		active_ = true;
 		deactivate_count_ = 0;
 		touch_count_ = 0;
 		for (auto & slot : touches_)
 			slot = touch{};  // restore every slot to its in-class defaults
-		simulator_ = nullptr;
+		touched_by_.clear();
+		solids_index_ = -1;
+		awake_index_ = -1;
+		solver_body_index_ = -1;
+		sleep_ready_tick_ = 0;
+		sleep_next_ = nullptr;
+		sleep_prev_ = nullptr;
 	}
 
 	// Scope bitmasks. Four independent ints with different roles:
@@ -351,11 +364,31 @@ public:
 	void set_user_data(void * d) { user_data_ = d; }
 	void * get_user_data() const { return user_data_; }
 
+	// A slot the broad-phase manager may use to find this solid in its own
+	// structures in O(1) (bvh_manager's dynamic tree keeps its leaf index here).
+	// -1 while unused; hop itself never reads it.
+	void set_manager_proxy(int p) { manager_proxy_ = p; }
+	int get_manager_proxy() const { return manager_proxy_; }
+
 	void activate() {
 		if (deactivate_count_ > 0)
 			deactivate_count_ = 0;
 		if (!active_) {
 			active_ = true;
+			if (simulator_) {
+				simulator_->internal_add_awake(this);
+				simulator_->internal_activated(this);
+			}
+			// Wake the island this body fell asleep with. Unlink the ring first, so
+			// each member's own activate() finds nothing left to walk.
+			solid<T> * s = sleep_next_;
+			sleep_next_ = sleep_prev_ = nullptr;
+			while (s && s != this) {
+				solid<T> * next = s->sleep_next_;
+				s->sleep_next_ = s->sleep_prev_ = nullptr;
+				s->activate();
+				s = next;
+			}
 			for (auto * c : constraints_) {
 				if (c->start_solid_.get() != this && c->start_solid_)
 					c->start_solid_->activate();
@@ -370,6 +403,9 @@ public:
 		activate();
 	}
 	void deactivate() {
+		const bool was_active = active_;
+		if (simulator_)
+			simulator_->internal_remove_awake(this);
 		active_ = false;
 		deactivate_count_ = 0;
 		// A sleeping body is at rest by definition. The deactivation test gates on
@@ -380,6 +416,8 @@ public:
 		// instant a neighbour wakes the body. Zero it so sleep means rest.
 		velocity_.reset();
 		ext_dv_.reset();
+		if (simulator_ && was_active)
+			simulator_->internal_deactivated(this);
 	}
 	bool active() const { return active_ && simulator_ != nullptr; }
 
@@ -439,9 +477,7 @@ private:
 	vec3<T> inertia_;             // principal-axis diagonal (Ix,Iy,Iz) in the body frame; for the I·ω gyroscopic term
 	vec3<T> inv_inertia_;         // per-component reciprocal of inertia_ (0 where a component is 0). PRIMARY marker: inv_inertia_==0 ⇒ never spins dynamically. Zero by default ⇒ rotation is opt-in
 	mat3<T> inv_inertia_world_;   // cached R·diag(inv_inertia_)·Rᵀ; see get_inv_inertia_world/update_inv_inertia_world. Zero for a non-rotating body
-	vec3<T> pos_correction_;      // speculative NGS position solver scratch (pseudo-position, not velocity)
 	vec3<T> ext_dv_;              // velocity this tick's integration added from external acceleration (gravity, drag, force_); solve_contacts subtracts it out of the restitution reference. Zero for a body that didn't integrate
-	bool solve_frozen_ = false;   // shock-propagation scratch: treated as a rigid support for this tick's velocity solve
 	contact_mode contact_mode_ = contact_mode::sweep_slide;  // positioning strategy (see contact_mode)
 	aa_box<T> world_bound_;       // broad phase reads this
 	aa_box<T> local_bound_;
@@ -469,9 +505,22 @@ private:
 	// different trajectories. An insertion id makes the solve order — and thus
 	// the result — reproducible across runs.
 	std::size_t solve_id_ = 0;
-	// Dense solver_bodies_ slot for this body. Valid only during solve_contacts
-	// (rewritten each call); -1 and stale otherwise.
+	// Dense solver_bodies_ slot for this body. Valid from solve_contacts to the
+	// end of Pass B (rewritten each tick); -1 otherwise.
 	int solver_body_index_ = -1;
+	// Island sleep (see simulator::sleep_islands). try_deactivate stamps the tick
+	// this body was last still long enough to sleep; the island sleeps only once
+	// every member carries the current stamp. Members that fell asleep together
+	// are linked in a ring through sleep_next_ (null while awake), so waking any
+	// one of them wakes them all. sleep_prev_ runs the other way, so a removed
+	// member unlinks itself in O(1).
+	int sleep_ready_tick_ = 0;
+	solid<T> * sleep_next_ = nullptr;
+	solid<T> * sleep_prev_ = nullptr;
+	// Slot in the simulator's awake list while active_ and added; -1 otherwise.
+	int awake_index_ = -1;
+	// Position in the simulator's solid list while added; -1 otherwise.
+	int solids_index_ = -1;
 
 	// -- Cold: rarely accessed in the hot path --
 	// Persistent per-pair contact cache. Each slot remembers a body this solid
@@ -489,12 +538,16 @@ private:
 	// last_tick.
 	touch touches_[max_touches];
 	int touch_count_ = 0;
+	// Back-references: every solid holding a touch slot for this one, once per
+	// holder, so removing this solid visits only the caches that point at it.
+	std::vector<solid<T> *> touched_by_;
 
 	std::vector<constraint<T> *> constraints_;
 
 	collision_fn collision_callback_;
 	collision_filter_fn collision_filter_;
 	void * user_data_ = nullptr;
+	int manager_proxy_ = -1;
 
 	friend class constraint<T>;
 	friend class shape<T>;
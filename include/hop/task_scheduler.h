@@ -0,0 +1,28 @@
+#pragma once
+
+#include <functional>
+
+namespace hop {
+
+// Pluggable parallel-for interface. The simulator runs every parallel phase
+// (split Pass A, the per-island solve, the colored solve) through one of these,
+// so a host engine can route hop's work into its own job system instead of
+// letting hop own threads: implement parallel_for on top of the engine's jobs
+// and hand it to simulator::set_task_scheduler. With none set, the simulator
+// uses a built-in thread_pool (see thread_pool.h).
+//
+// The simulator decides how many parts a phase splits into (set_thread_count),
+// and the parts never share written state, so results do not depend on which
+// thread runs which part, in what order, or how many run at once.
+class task_scheduler {
+public:
+	virtual ~task_scheduler() = default;
+
+	// Run fn(i) for every i in [0, count), and return only once all of them have
+	// finished. The calls may run in any order and concurrently, on any thread,
+	// the calling thread included. fn may itself call parallel_for; an
+	// implementation that cannot nest should run the inner loop serially.
+	virtual void parallel_for(int count, const std::function<void(int)> & fn) = 0;
+};
+
+} // namespace hop
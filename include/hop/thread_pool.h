@@ -0,0 +1,186 @@
+#pragma once
+
+#include <hop/task_scheduler.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+namespace hop {
+
+// The default task_scheduler: a fixed set of persistent worker threads. A tick
+// issues a few dozen short parallel_for calls back to back, so neither creating
+// threads per call nor waking parked ones through a condition variable each time
+// is affordable at 60-120 Hz. Idle workers therefore spin on the job counter for
+// a few microseconds before parking, which catches the next phase of the same
+// tick; only between ticks do they sleep. Within a call, the caller and every worker claim
+// indices from one shared atomic cursor, so a thread that finishes early takes
+// the remaining work of slower ones (the load balancing work stealing buys,
+// without per-thread queues).
+//
+// One parallel_for runs at a time; concurrent callers queue. A parallel_for
+// issued from inside a task runs serially on the calling thread. If a task
+// throws, the indices not yet started are skipped and parallel_for rethrows the
+// first exception once every thread has left the job.
+class thread_pool : public task_scheduler {
+public:
+	// Pause instructions an idle worker spins through before parking: tens of
+	// microseconds, which spans the gap between phases of one tick but not the
+	// gap between ticks.
+	static constexpr int spin_limit = 1 << 11;
+
+	// `threads` counts the calling thread, so the pool starts threads - 1 workers.
+	explicit thread_pool(int threads) {
+		for (int i = 1; i < threads; ++i)
+			workers_.emplace_back([this] { worker_loop(); });
+	}
+
+	~thread_pool() override {
+		{
+			std::lock_guard<std::mutex> lock(park_mutex_);
+			stop_.store(true);
+		}
+		park_cv_.notify_all();
+		for (auto & w : workers_)
+			w.join();
+	}
+
+	thread_pool(const thread_pool &) = delete;
+	thread_pool & operator=(const thread_pool &) = delete;
+
+	// Threads that run tasks, including the caller.
+	int get_thread_count() const { return static_cast<int>(workers_.size()) + 1; }
+
+	void parallel_for(int count, const std::function<void(int)> & fn) override {
+		if (count <= 0)
+			return;
+		if (count == 1 || workers_.empty() || running_pool() == this) {
+			for (int i = 0; i < count; ++i)
+				fn(i);
+			return;
+		}
+		std::lock_guard<std::mutex> submit(submit_mutex_);
+		running_pool() = this;
+
+		// Publish the job. Nothing below reads it until open_ is set, and no worker
+		// is still inside the previous one (see the wait at the end).
+		fn_ = &fn;
+		count_ = count;
+		next_.store(0, std::memory_order_relaxed);
+		done_.store(0, std::memory_order_relaxed);
+		failed_.store(false, std::memory_order_relaxed);
+		open_.store(true);
+		generation_.fetch_add(1);
+		if (parked_.load() > 0) {
+			std::lock_guard<std::mutex> lock(park_mutex_);
+			park_cv_.notify_all();
+		}
+
+		run_tasks();
+		while (done_.load(std::memory_order_acquire) < count)
+			std::this_thread::yield();
+		// Close the job and wait out any worker still between claiming its last
+		// index and leaving, so the next job can overwrite fn_ and count_.
+		open_.store(false);
+		while (active_.load() > 0)
+			std::this_thread::yield();
+		running_pool() = nullptr;
+		if (error_) {
+			std::exception_ptr e = std::move(error_);
+			error_ = nullptr;
+			std::rethrow_exception(e);
+		}
+	}
+
+private:
+	// The pool whose job the current thread is running, to serialize nested calls.
+	static thread_pool *& running_pool() {
+		static thread_local thread_pool * pool = nullptr;
+		return pool;
+	}
+
+	// Spin-wait hint: tells the core this is a busy-wait loop, without giving
+	// up the time slice as yield() does.
+	static void cpu_relax() {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__("yield");
+#endif
+	}
+
+	// Claim and run indices until none are left. A throwing task is caught here,
+	// so every claimed index is still counted done and the caller's wait ends;
+	// the first exception is kept for the caller to rethrow.
+	void run_tasks() {
+		for (;;) {
+			const int i = next_.fetch_add(1, std::memory_order_relaxed);
+			if (i >= count_)
+				return;
+			if (!failed_.load(std::memory_order_relaxed)) {
+				try {
+					(*fn_)(i);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(error_mutex_);
+					if (!error_)
+						error_ = std::current_exception();
+					failed_.store(true, std::memory_order_relaxed);
+				}
+			}
+			done_.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	void worker_loop() {
+		running_pool() = this;
+		unsigned seen = generation_.load();
+		for (;;) {
+			int spins = 0;
+			while (generation_.load() == seen && !stop_.load()) {
+				if (++spins < spin_limit) {
+					cpu_relax();
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(park_mutex_);
+				parked_.fetch_add(1);
+				park_cv_.wait(lock, [&] { return generation_.load() != seen || stop_.load(); });
+				parked_.fetch_sub(1);
+			}
+			if (stop_.load())
+				return;
+			seen = generation_.load();
+			// Register before looking at the job, so the caller cannot retire it
+			// while this worker reads fn_ and count_.
+			active_.fetch_add(1);
+			if (open_.load())
+				run_tasks();
+			active_.fetch_sub(1);
+		}
+	}
+
+	std::vector<std::thread> workers_;
+	std::mutex submit_mutex_;
+	std::mutex park_mutex_;
+	std::condition_variable park_cv_;
+	std::atomic<unsigned> generation_ { 0 };  // bumped once per job; what idle workers watch
+	std::atomic<int> parked_ { 0 };
+	std::atomic<int> active_ { 0 };           // workers inside a job
+	std::atomic<bool> open_ { false };        // fn_ / count_ describe a live job
+	std::atomic<bool> stop_ { false };
+	const std::function<void(int)> * fn_ = nullptr;
+	int count_ = 0;
+	std::atomic<int> next_ { 0 };
+	std::atomic<int> done_ { 0 };
+	std::atomic<bool> failed_ { false };      // a task of the live job threw
+	std::mutex error_mutex_;
+	std::exception_ptr error_;                // the first exception thrown, rethrown by parallel_for
+};
+
+} // namespace hop
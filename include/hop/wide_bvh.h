@@ -0,0 +1,397 @@
+#pragma once
+
+#include <hop/bvh.h>
+#include <hop/fixed16.h>
+#include <hop/math/aa_box.h>
+#include <hop/math/intersect.h>
+#include <hop/scalar_traits.h>
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// SSE2 is part of every x86-64 target, so the 4-wide child tests are vectorized
+// there without extra compiler flags. The 8-wide ones need AVX2 (-mavx2, or
+// /arch:AVX2 with MSVC). Other targets (WebAssembly, ARM), widths without their
+// instruction set, and builds defining HOP_NO_SIMD take the scalar loops, which
+// report the same items.
+#if !defined(HOP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HOP_WIDE_BVH_SSE 1
+#include <emmintrin.h>
+#endif
+#if !defined(HOP_NO_SIMD) && defined(__AVX2__)
+#define HOP_WIDE_BVH_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace hop {
+
+// The widest node the target tests in one go: 8 with AVX2, else 4.
+#if HOP_WIDE_BVH_AVX2
+inline constexpr int wide_bvh_native_width = 8;
+#else
+inline constexpr int wide_bvh_native_width = 4;
+#endif
+
+// A wide BVH: a binary bvh collapsed so each node holds up to Width children
+// (4, a "QBVH", or 8), their bounds stored axis by axis — the children's min x,
+// then their min y, and so on. A query tests all of a node's children at once
+// (with SSE2 for four, AVX2 for eight: one compare per bound, float compares
+// for float, integer compares on fixed16's raw values for box queries; fixed16
+// rays run the scalar slabs) and descends a half (a third) as many levels as in
+// the binary tree, so a walk through a large static world touches far fewer
+// cache lines.
+//
+// build() runs the binary builder (set_build_method, see bvh_build) and then
+// collapses the tree: each wide node takes its binary node's two children and
+// keeps opening the one with the largest surface area (by bvh_cost) until it
+// has Width. There is no refit; rebuild after the items move.
+//
+// query_ray visits each node's children nearest first, by where the ray enters
+// their boxes, so a callback that lowers best_t on a hit (line of sight, the
+// first thing a shot meets) skips the farther subtrees as soon as it can.
+//
+// Usage:
+//   wide_bvh<float, int> tree;  // or wide_bvh<float, int, 8>
+//   tree.build(entries);
+//   tree.query_aabb(box, [](int item) { ... });
+//   tree.query_ray(origin, direction, [](int item, float &best_t) { ... });
+//
+// Reports the same items as a bvh of the same entries, in a different order.
+
+template <typename T, typename Item, int Width = 4> class wide_bvh {
+public:
+	using tr = scalar_traits<T>;
+
+	static_assert(Width == 4 || Width == 8, "wide_bvh is 4 or 8 wide");
+	static constexpr int width = Width;
+
+	// Bounds of the children, axis by axis. child[k] is a node index, or ~i for
+	// a leaf holding get_items()[i]. Slots from count on are unused; their
+	// bounds repeat slot 0's, so the vector tests read defined values.
+	struct alignas(64) node {
+		T mins[3][width];
+		T maxs[3][width];
+		int child[width] = {};
+		int count = 0;
+	};
+
+	void set_build_method(bvh_build m) { build_method_ = m; }
+	bvh_build get_build_method() const { return build_method_; }
+
+	// Build from a list of (AABB, item) pairs. The input vector may be reordered.
+	void build(std::vector<std::pair<aa_box<T>, Item>> & entries) {
+		bvh<T, Item> binary;
+		binary.set_build_method(build_method_);
+		binary.build(entries);
+		build(binary);
+	}
+
+	// Build by collapsing an existing binary tree.
+	void build(const bvh<T, Item> & binary) {
+		nodes_.clear();
+		items_.clear();
+		if (binary.empty())
+			return;
+		nodes_.reserve(binary.get_items().size() / 2 + 1);
+		items_.reserve(binary.get_items().size());
+		collapse(binary, 0);
+	}
+
+	// Find all items whose AABBs overlap the given box; a callback returning
+	// false ends the walk, as in bvh::query_aabb.
+	template <typename Callback> void query_aabb(const aa_box<T> & box, Callback && cb) const {
+		if (nodes_.empty())
+			return;
+		int stack[stack_size];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0) {
+			const node & n = nodes_[stack[--top]];
+			unsigned hits = overlap_mask(n, box);
+			for (int k = 0; hits != 0; ++k, hits >>= 1) {
+				if ((hits & 1) == 0)
+					continue;
+				if (n.child[k] < 0) {
+					if (!visit_item(cb, items_[~n.child[k]]))
+						return;
+				} else {
+					stack[top++] = n.child[k];
+				}
+			}
+		}
+	}
+
+	// Find items along a ray (segment), as bvh::query_ray: the callback receives
+	// (item, best_t) and may lower best_t to prune everything beyond it.
+	template <typename Callback>
+	void query_ray(const vec3<T> & origin, const vec3<T> & direction, Callback && cb) const {
+		query_ray(origin, direction, T {}, cb);
+	}
+
+	// The same, with every box grown by pad on each side: the items whose boxes
+	// the segment passes within pad of, as a query of the segment's box grown by
+	// pad would test them.
+	template <typename Callback>
+	void query_ray(const vec3<T> & origin, const vec3<T> & direction, T pad, Callback && cb) const {
+		if (nodes_.empty())
+			return;
+		const ray r(origin, direction, pad);
+		T best_t = tr::one();
+		struct entry {
+			int child;
+			T t;  // where the ray enters the child's box
+		};
+		entry stack[stack_size];
+		int top = 0;
+		stack[top++] = { 0, T {} };
+		while (top > 0) {
+			const entry e = stack[--top];
+			if (!(e.t < best_t))
+				continue;  // a hit nearer than this box was found since it was pushed
+			if (e.child < 0) {
+				cb(items_[~e.child], best_t);
+				continue;
+			}
+			const node & n = nodes_[e.child];
+			T t[width];
+			unsigned hits = slab_mask(n, r, best_t, t);
+			// Push the hit children farthest first, so the nearest is popped next.
+			entry sorted[width];
+			int count = 0;
+			for (int k = 0; hits != 0; ++k, hits >>= 1) {
+				if ((hits & 1) == 0)
+					continue;
+				int i = count++;
+				for (; i > 0 && sorted[i - 1].t < t[k]; --i)
+					sorted[i] = sorted[i - 1];
+				sorted[i] = { n.child[k], t[k] };
+			}
+			for (int i = 0; i < count; ++i)
+				stack[top++] = sorted[i];
+		}
+	}
+
+	const std::vector<node> & get_nodes() const { return nodes_; }
+	const std::vector<Item> & get_items() const { return items_; }
+	bool empty() const { return nodes_.empty(); }
+	int size() const { return static_cast<int>(nodes_.size()); }
+
+private:
+	// A walk holds at most width - 1 entries per level plus one, and the binary
+	// builders stop short of 80 levels (sah_max_depth, then median splits of
+	// at most 2^31 items), which collapsing cannot deepen.
+	static constexpr int stack_size = (width - 1) * 80 + 1;
+
+	std::vector<node> nodes_;
+	std::vector<Item> items_;
+	bvh_build build_method_ = bvh_build::median;
+
+	// A ray's reciprocal direction, computed once per query rather than per box.
+	// Zero components are handled by containment, as in bvh::ray_hits_aabb.
+	struct ray {
+		vec3<T> origin;
+		T inv[3];
+		T pad;
+		bool moves[3];
+		ray(const vec3<T> & o, const vec3<T> & d, T p) : origin(o), pad(p) {
+			for (int axis = 0; axis < 3; ++axis) {
+				moves[axis] = d[axis] != T {};
+				inv[axis] = moves[axis] ? tr::one() / d[axis] : T {};
+			}
+		}
+	};
+
+	// Make the wide node for binary node bi and, recursively, its subtree.
+	int collapse(const bvh<T, Item> & binary, int bi) {
+		const auto & bnodes = binary.get_nodes();
+		int kids[width];
+		int n = 0;
+		if (bnodes[bi].is_leaf()) {
+			kids[n++] = bi;  // a one-item tree
+		} else {
+			kids[n++] = bi + 1;
+			kids[n++] = binary.right_child(bi);
+		}
+		// Every box opened lies within binary node bi's.
+		const int shift = bvh_cost<T>::shift_for(bnodes[bi].box, 1);
+		while (n < width) {
+			int open = -1;
+			typename bvh_cost<T>::type open_area {};
+			for (int k = 0; k < n; ++k) {
+				if (bnodes[kids[k]].is_leaf())
+					continue;
+				const auto a = bvh_cost<T>::area(bnodes[kids[k]].box, shift);
+				if (open < 0 || a > open_area) {
+					open = k;
+					open_area = a;
+				}
+			}
+			if (open < 0)
+				break;
+			const int parent = kids[open];
+			kids[open] = parent + 1;
+			kids[n++] = binary.right_child(parent);
+		}
+
+		// Children are collapsed after this node is placed, so they follow it
+		// depth-first; nodes_ may reallocate meanwhile, hence the index.
+		const int idx = static_cast<int>(nodes_.size());
+		nodes_.emplace_back();
+		nodes_[idx].count = n;
+		for (int k = 0; k < width; ++k) {
+			const aa_box<T> & box = bnodes[kids[k < n ? k : 0]].box;
+			for (int axis = 0; axis < 3; ++axis) {
+				nodes_[idx].mins[axis][k] = box.mins[axis];
+				nodes_[idx].maxs[axis][k] = box.maxs[axis];
+			}
+		}
+		for (int k = 0; k < n; ++k) {
+			const auto & kid = bnodes[kids[k]];
+			int c;
+			if (kid.is_leaf()) {
+				c = ~static_cast<int>(items_.size());
+				items_.push_back(binary.get_items()[kid.leaf]);
+			} else {
+				c = collapse(binary, kids[k]);
+			}
+			nodes_[idx].child[k] = c;
+		}
+		return idx;
+	}
+
+	// Bit k set if child k's box overlaps box (touching counts, as in
+	// test_intersection).
+	static unsigned overlap_mask(const node & n, const aa_box<T> & box) {
+		const unsigned used = (1u << n.count) - 1;
+#if HOP_WIDE_BVH_AVX2
+		if constexpr (width == 8 && std::is_same<T, float>::value) {
+			auto le = [](__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); };
+			__m256 m = _mm256_and_ps(le(_mm256_load_ps(n.mins[0]), _mm256_set1_ps(box.maxs.x)),
+			                         le(_mm256_set1_ps(box.mins.x), _mm256_load_ps(n.maxs[0])));
+			m = _mm256_and_ps(m, le(_mm256_load_ps(n.mins[1]), _mm256_set1_ps(box.maxs.y)));
+			m = _mm256_and_ps(m, le(_mm256_set1_ps(box.mins.y), _mm256_load_ps(n.maxs[1])));
+			m = _mm256_and_ps(m, le(_mm256_load_ps(n.mins[2]), _mm256_set1_ps(box.maxs.z)));
+			m = _mm256_and_ps(m, le(_mm256_set1_ps(box.mins.z), _mm256_load_ps(n.maxs[2])));
+			return static_cast<unsigned>(_mm256_movemask_ps(m)) & used;
+		} else if constexpr (width == 8 && std::is_same<T, fixed16>::value) {
+			auto load = [](const T * v) { return _mm256_load_si256(reinterpret_cast<const __m256i *>(v)); };
+			__m256i miss = _mm256_or_si256(_mm256_cmpgt_epi32(load(n.mins[0]), _mm256_set1_epi32(box.maxs.x.raw)),
+			                               _mm256_cmpgt_epi32(_mm256_set1_epi32(box.mins.x.raw), load(n.maxs[0])));
+			miss = _mm256_or_si256(miss, _mm256_cmpgt_epi32(load(n.mins[1]), _mm256_set1_epi32(box.maxs.y.raw)));
+			miss = _mm256_or_si256(miss, _mm256_cmpgt_epi32(_mm256_set1_epi32(box.mins.y.raw), load(n.maxs[1])));
+			miss = _mm256_or_si256(miss, _mm256_cmpgt_epi32(load(n.mins[2]), _mm256_set1_epi32(box.maxs.z.raw)));
+			miss = _mm256_or_si256(miss, _mm256_cmpgt_epi32(_mm256_set1_epi32(box.mins.z.raw), load(n.maxs[2])));
+			return ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(miss))) & used;
+		}
+#endif
+#if HOP_WIDE_BVH_SSE
+		if constexpr (width == 4 && std::is_same<T, float>::value) {
+			__m128 m = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(n.mins[0]), _mm_set1_ps(box.maxs.x)),
+			                      _mm_cmpge_ps(_mm_load_ps(n.maxs[0]), _mm_set1_ps(box.mins.x)));
+			m = _mm_and_ps(m, _mm_cmple_ps(_mm_load_ps(n.mins[1]), _mm_set1_ps(box.maxs.y)));
+			m = _mm_and_ps(m, _mm_cmpge_ps(_mm_load_ps(n.maxs[1]), _mm_set1_ps(box.mins.y)));
+			m = _mm_and_ps(m, _mm_cmple_ps(_mm_load_ps(n.mins[2]), _mm_set1_ps(box.maxs.z)));
+			m = _mm_and_ps(m, _mm_cmpge_ps(_mm_load_ps(n.maxs[2]), _mm_set1_ps(box.mins.z)));
+			return static_cast<unsigned>(_mm_movemask_ps(m)) & used;
+		} else if constexpr (width == 4 && std::is_same<T, fixed16>::value) {
+			// fixed16 orders as its raw int32, so integer compares do.
+			auto load = [](const T * v) { return _mm_load_si128(reinterpret_cast<const __m128i *>(v)); };
+			__m128i miss = _mm_or_si128(_mm_cmpgt_epi32(load(n.mins[0]), _mm_set1_epi32(box.maxs.x.raw)),
+			                            _mm_cmpgt_epi32(_mm_set1_epi32(box.mins.x.raw), load(n.maxs[0])));
+			miss = _mm_or_si128(miss, _mm_cmpgt_epi32(load(n.mins[1]), _mm_set1_epi32(box.maxs.y.raw)));
+			miss = _mm_or_si128(miss, _mm_cmpgt_epi32(_mm_set1_epi32(box.mins.y.raw), load(n.maxs[1])));
+			miss = _mm_or_si128(miss, _mm_cmpgt_epi32(load(n.mins[2]), _mm_set1_epi32(box.maxs.z.raw)));
+			miss = _mm_or_si128(miss, _mm_cmpgt_epi32(_mm_set1_epi32(box.mins.z.raw), load(n.maxs[2])));
+			return ~static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(miss))) & used;
+		}
+#endif
+		unsigned mask = 0;
+		for (int k = 0; k < n.count; ++k) {
+			bool hit = true;
+			for (int axis = 0; axis < 3; ++axis)
+				hit = hit && !(n.mins[axis][k] > box.maxs[axis] || box.mins[axis] > n.maxs[axis][k]);
+			mask |= hit ? 1u << k : 0u;
+		}
+		return mask & used;
+	}
+
+	// Bit k set if the ray meets child k's box before best_t, with t[k] where it
+	// enters. The same slab arithmetic as bvh::ray_hits_aabb, lane by lane.
+	static unsigned slab_mask(const node & n, const ray & r, T best_t, T t[width]) {
+		const unsigned used = (1u << n.count) - 1;
+#if HOP_WIDE_BVH_AVX2
+		if constexpr (width == 8 && std::is_same<T, float>::value) {
+			__m256 tmin = _mm256_setzero_ps();
+			__m256 tmax = _mm256_set1_ps(best_t);
+			unsigned mask = used;
+			for (int axis = 0; axis < 3; ++axis) {
+				const __m256 lo = _mm256_sub_ps(_mm256_load_ps(n.mins[axis]), _mm256_set1_ps(r.pad));
+				const __m256 hi = _mm256_add_ps(_mm256_load_ps(n.maxs[axis]), _mm256_set1_ps(r.pad));
+				const __m256 o = _mm256_set1_ps(r.origin[axis]);
+				if (r.moves[axis]) {
+					const __m256 inv = _mm256_set1_ps(r.inv[axis]);
+					const __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(lo, o), inv);
+					const __m256 t2 = _mm256_mul_ps(_mm256_sub_ps(hi, o), inv);
+					tmin = _mm256_max_ps(tmin, _mm256_min_ps(t1, t2));
+					tmax = _mm256_min_ps(tmax, _mm256_max_ps(t1, t2));
+				} else {
+					const __m256 inside = _mm256_and_ps(_mm256_cmp_ps(lo, o, _CMP_LE_OQ), _mm256_cmp_ps(o, hi, _CMP_LE_OQ));
+					mask &= static_cast<unsigned>(_mm256_movemask_ps(inside));
+				}
+			}
+			const __m256 hit = _mm256_and_ps(_mm256_cmp_ps(tmin, tmax, _CMP_LE_OQ),
+			                                 _mm256_cmp_ps(tmin, _mm256_set1_ps(best_t), _CMP_LT_OQ));
+			_mm256_storeu_ps(t, tmin);
+			return static_cast<unsigned>(_mm256_movemask_ps(hit)) & mask;
+		}
+#endif
+#if HOP_WIDE_BVH_SSE
+		if constexpr (width == 4 && std::is_same<T, float>::value) {
+			__m128 tmin = _mm_setzero_ps();
+			__m128 tmax = _mm_set1_ps(best_t);
+			unsigned mask = used;
+			for (int axis = 0; axis < 3; ++axis) {
+				const __m128 lo = _mm_sub_ps(_mm_load_ps(n.mins[axis]), _mm_set1_ps(r.pad));
+				const __m128 hi = _mm_add_ps(_mm_load_ps(n.maxs[axis]), _mm_set1_ps(r.pad));
+				const __m128 o = _mm_set1_ps(r.origin[axis]);
+				if (r.moves[axis]) {
+					const __m128 inv = _mm_set1_ps(r.inv[axis]);
+					const __m128 t1 = _mm_mul_ps(_mm_sub_ps(lo, o), inv);
+					const __m128 t2 = _mm_mul_ps(_mm_sub_ps(hi, o), inv);
+					tmin = _mm_max_ps(tmin, _mm_min_ps(t1, t2));
+					tmax = _mm_min_ps(tmax, _mm_max_ps(t1, t2));
+				} else {
+					mask &= static_cast<unsigned>(_mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(lo, o), _mm_cmpge_ps(hi, o))));
+				}
+			}
+			const __m128 hit = _mm_and_ps(_mm_cmpge_ps(tmax, tmin), _mm_cmplt_ps(tmin, _mm_set1_ps(best_t)));
+			_mm_storeu_ps(t, tmin);
+			return static_cast<unsigned>(_mm_movemask_ps(hit)) & mask;
+		}
+#endif
+		unsigned mask = 0;
+		for (int k = 0; k < n.count; ++k) {
+			T tmin {};
+			T tmax = best_t;
+			bool hit = true;
+			for (int axis = 0; axis < 3 && hit; ++axis) {
+				const T lo = n.mins[axis][k] - r.pad, hi = n.maxs[axis][k] + r.pad;
+				if (r.moves[axis]) {
+					const T t1 = (lo - r.origin[axis]) * r.inv[axis];
+					const T t2 = (hi - r.origin[axis]) * r.inv[axis];
+					tmin = tr::max_val(tmin, tr::min_val(t1, t2));
+					tmax = tr::min_val(tmax, tr::max_val(t1, t2));
+				} else {
+					hit = !(r.origin[axis] < lo || r.origin[axis] > hi);
+				}
+			}
+			t[k] = tmin;
+			if (hit && tmax >= tmin && tmin < best_t)
+				mask |= 1u << k;
+		}
+		return mask;
+	}
+};
+
+} // namespace hop
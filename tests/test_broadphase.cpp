@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <vector>
+#include <hop/hop.h>
+
+using namespace hop;
+
+// Broad-phase managers other than bvh_manager (see test_bvh.cpp). Each is
+// checked against a brute-force overlap scan over the same solids. The callback
+// query every manager offers is checked here for all of them.
+
+template <typename T> static std::shared_ptr<solid<T>> make_ball(const vec3<T> & pos, T radius) {
+	auto s = std::make_shared<solid<T>>();
+	s->set_position(pos);
+	s->add_shape(std::make_shared<shape<T>>(hop::sphere<T> { vec3<T> {}, radius }));
+	return s;
+}
+
+// Every solid overlapping box, except `skip`.
+template <typename T>
+static std::set<solid<T> *> brute_force(const std::vector<std::shared_ptr<solid<T>>> & solids, const aa_box<T> & box,
+                                        const solid<T> * skip = nullptr) {
+	std::set<solid<T> *> out;
+	for (auto & s : solids)
+		if (s.get() != skip && !s->get_shapes().empty() && test_intersection(box, s->get_world_bound()))
+			out.insert(s.get());
+	return out;
+}
+
+// ============================================================
+// sap_manager
+// ============================================================
+
+template <typename T> static void test_sap_pairs(const char * label) {
+	using tr = scalar_traits<T>;
+	unsigned seed = 4242;
+	auto rnd = [&](int lo, int hi) {
+		seed = seed * 1103515245u + 12345u;
+		return lo + static_cast<int>((seed >> 8) % static_cast<unsigned>(hi - lo));
+	};
+	auto random_point = [&] {
+		return vec3<T>(tr::from_milli(rnd(-15000, 15000)), tr::from_milli(rnd(-15000, 15000)), tr::from_milli(rnd(0, 3000)));
+	};
+
+	sap_manager<T> mgr;
+	std::vector<std::shared_ptr<solid<T>>> solids;
+	auto floor = std::make_shared<solid<T>>();
+	floor->set_infinite_mass();
+	floor->add_shape(std::make_shared<shape<T>>(aa_box<T>(vec3<T>(-tr::from_int(20), -tr::from_int(20), -tr::one()),
+	                                                      vec3<T>(tr::from_int(20), tr::from_int(20), T {}))));
+	mgr.add_solid(floor.get(), true);
+	solids.push_back(floor);
+	for (int i = 0; i < 200; i++) {
+		solids.push_back(make_ball(random_point(), tr::from_milli(rnd(200, 900))));
+		mgr.add_solid(solids.back().get(), false);
+	}
+	const T dt = tr::from_milli(16);
+	mgr.pre_update(dt);
+
+	auto check = [&] {
+		// The pair set holds every overlapping pair (bar static-static), once.
+		std::set<std::pair<solid<T> *, solid<T> *>> pairs;
+		int visited = 0;
+		mgr.for_each_pair([&](solid<T> * a, solid<T> * b) {
+			pairs.insert(a < b ? std::make_pair(a, b) : std::make_pair(b, a));
+			visited++;
+		});
+		assert(visited == mgr.get_pair_count());
+		assert(static_cast<int>(pairs.size()) == visited);
+		for (size_t i = 0; i < solids.size(); i++) {
+			for (size_t j = i + 1; j < solids.size(); j++) {
+				solid<T> * a = solids[i].get();
+				solid<T> * b = solids[j].get();
+				if (test_intersection(a->get_world_bound(), b->get_world_bound()))
+					assert(pairs.count(a < b ? std::make_pair(a, b) : std::make_pair(b, a)) == 1);
+			}
+		}
+		// A solid's own sweep box is answered from its partners.
+		solid<T> * found[256];
+		for (size_t i = 1; i < solids.size(); i++) {
+			solid<T> * s = solids[i].get();
+			aa_box<T> box = s->get_world_bound();
+			box.mins -= vec3<T>(tr::from_milli(20), tr::from_milli(20), tr::from_milli(20));
+			box.maxs += vec3<T>(tr::from_milli(20), tr::from_milli(20), tr::from_milli(20));
+			const int n = mgr.find_solids_near(s, box, found, 256);
+			std::set<solid<T> *> got(found, found + n);
+			got.erase(s);
+			assert(got == brute_force(solids, box, s));
+		}
+		for (int q = 0; q < 20; q++) {
+			const vec3<T> c = random_point();
+			aa_box<T> box(c, c);
+			box.maxs += vec3<T>(tr::from_int(3), tr::from_int(3), tr::from_int(3));
+			const int n = mgr.find_solids_in_aa_box(box, found, 256);
+			assert(std::set<solid<T> *>(found, found + n) == brute_force(solids, box));
+		}
+	};
+	check();
+	assert(mgr.get_pair_count() > 0);
+
+	for (int step = 0; step < 40; step++) {
+		// Most balls drift a little, a few jump across the field.
+		for (size_t i = 1; i < solids.size(); i++) {
+			solid<T> * s = solids[i].get();
+			const vec3<T> v(tr::from_milli(rnd(-3000, 3000)), tr::from_milli(rnd(-3000, 3000)), T {});
+			s->set_velocity(v);
+			s->set_position(rnd(0, 50) == 0 ? random_point() : s->get_position() + v * dt);
+		}
+		if (step % 10 == 5) {
+			// Despawn a batch, spawn a few more, and move the floor.
+			solid<T> * dead[] = { solids[3].get(), solids[50].get(), solids[51].get() };
+			mgr.remove_solids(dead, 3);
+			solids.erase(solids.begin() + 50, solids.begin() + 52);
+			solids.erase(solids.begin() + 3);
+			for (int k = 0; k < 4; k++) {
+				solids.push_back(make_ball(random_point(), tr::half()));
+				mgr.add_solid(solids.back().get(), false);
+			}
+			floor->set_position(vec3<T>(tr::from_int(step % 3), T {}, T {}));
+			mgr.mark_moved();
+		}
+		mgr.pre_update(dt);
+		check();
+	}
+	assert(mgr.get_dynamic_count() == static_cast<int>(solids.size()) - 1);
+
+	printf("  sap pairs[%s]: OK\n", label);
+}
+
+// A settling pile run through the simulator with the SAP manager: contacts come
+// from find_solids_near, and must keep every ball above the floor.
+template <typename T> static void test_sap_simulator(const char * label) {
+	using tr = scalar_traits<T>;
+	auto sim = std::make_shared<simulator<T>>();
+	sim->set_gravity(vec3<T>(T {}, T {}, -tr::from_milli(9810)));
+	sap_manager<T> mgr;
+	sim->set_manager(&mgr);
+
+	std::vector<std::shared_ptr<solid<T>>> solids;
+	auto floor = std::make_shared<solid<T>>();
+	floor->set_infinite_mass();
+	floor->set_coefficient_of_gravity(T {});
+	floor->add_shape(std::make_shared<shape<T>>(aa_box<T>(vec3<T>(-tr::from_int(10), -tr::from_int(10), -tr::one()),
+	                                                      vec3<T>(tr::from_int(10), tr::from_int(10), T {}))));
+	sim->add_solid(floor);
+	mgr.add_solid(floor.get(), true);
+	solids.push_back(floor);
+	for (int i = 0; i < 48; i++) {
+		auto b = make_ball(vec3<T>(tr::from_milli(1100 * (i % 4) - 1650 + i % 3 * 40), tr::from_milli(1100 * (i / 4 % 4) - 1650),
+		                           tr::from_milli(600 + 1100 * (i / 16))),
+		                   tr::half());
+		b->set_mass(tr::one());
+		sim->add_solid(b);
+		if (i % 2)
+			b->set_contact_mode(contact_mode::speculative);
+		mgr.add_solid(b.get(), false);
+		solids.push_back(b);
+	}
+
+	solid<T> * found[128];
+	for (int t = 0; t < 200; t++) {
+		sim->update(tr::from_milli(16));
+		for (size_t i = 1; i < solids.size(); i++) {
+			solid<T> * s = solids[i].get();
+			aa_box<T> box = s->get_world_bound();
+			box.mins -= vec3<T>(tr::from_milli(10), tr::from_milli(10), tr::from_milli(10));
+			box.maxs += vec3<T>(tr::from_milli(10), tr::from_milli(10), tr::from_milli(10));
+			const int n = mgr.find_solids_near(s, box, found, 128);
+			std::set<solid<T> *> got(found, found + n);
+			got.erase(s);
+			assert(got == brute_force(solids, box, s));
+		}
+	}
+	for (size_t i = 1; i < solids.size(); i++)
+		assert(solids[i]->get_position().z > tr::from_milli(300));
+
+	printf("  sap simulator[%s]: pairs=%d OK\n", label, mgr.get_pair_count());
+}
+
+// ============================================================
+// grid_manager
+// ============================================================
+
+template <typename T> static void test_grid_queries(const char * label) {
+	using tr = scalar_traits<T>;
+	unsigned seed = 777;
+	auto rnd = [&](int lo, int hi) {
+		seed = seed * 1103515245u + 12345u;
+		return lo + static_cast<int>((seed >> 8) % static_cast<unsigned>(hi - lo));
+	};
+	// Negative coordinates included, so cells on both sides of zero are hit.
+	auto random_point = [&] {
+		return vec3<T>(tr::from_milli(rnd(-12000, 12000)), tr::from_milli(rnd(-12000, 12000)), tr::from_milli(rnd(-2000, 3000)));
+	};
+
+	grid_manager<T> mgr;
+	mgr.set_cell_size(tr::one());
+	std::vector<std::shared_ptr<solid<T>>> solids;
+	auto floor = std::make_shared<solid<T>>();
+	floor->set_infinite_mass();
+	floor->add_shape(std::make_shared<shape<T>>(aa_box<T>(vec3<T>(-tr::from_int(20), -tr::from_int(20), -tr::from_int(3)),
+	                                                      vec3<T>(tr::from_int(20), tr::from_int(20), -tr::from_int(2)))));
+	mgr.add_solid(floor.get(), true);
+	solids.push_back(floor);
+	for (int i = 0; i < 1500; i++) {
+		solids.push_back(make_ball(random_point(), tr::from_milli(rnd(200, 500))));
+		mgr.add_solid(solids.back().get(), false);
+	}
+	assert(mgr.get_oversize_count() == 1);
+	assert(mgr.get_bucket_count() >= 1501);
+	const T dt = tr::from_milli(16);
+	mgr.pre_update(dt);
+
+	auto check = [&] {
+		solid<T> * found[2048];
+		for (int q = 0; q < 40; q++) {
+			const vec3<T> c = random_point();
+			aa_box<T> box(c, c);
+			// Mostly small boxes, and one a tick covering the whole field.
+			const T size = q == 0 ? tr::from_int(30) : tr::from_milli(rnd(0, 2500));
+			box.mins -= vec3<T>(size, size, size);
+			box.maxs += vec3<T>(size, size, size);
+			const int n = mgr.find_solids_in_aa_box(box, found, 2048);
+			assert(static_cast<int>(std::set<solid<T> *>(found, found + n).size()) == n);  // no duplicates
+			assert(std::set<solid<T> *>(found, found + n) == brute_force(solids, box));
+		}
+		const auto * order = mgr.get_iteration_order();
+		assert(order->size() == solids.size());
+		assert(std::set<solid<T> *>(order->begin(), order->end()).size() == solids.size());
+	};
+	check();
+
+	for (int step = 0; step < 30; step++) {
+		for (size_t i = 1; i < solids.size(); i++) {
+			solid<T> * s = solids[i].get();
+			const vec3<T> v(tr::from_milli(rnd(-4000, 4000)), tr::from_milli(rnd(-4000, 4000)), T {});
+			s->set_position(rnd(0, 50) == 0 ? random_point() : s->get_position() + v * dt);
+			// Half the solids are re-hashed after their own tick, the rest by
+			// the next pre_update.
+			if (i % 2)
+				mgr.post_update(s, dt);
+		}
+		if (step % 10 == 5) {
+			solid<T> * dead[] = { solids[7].get(), solids[80].get(), solids[81].get() };
+			mgr.remove_solids(dead, 3);
+			solids.erase(solids.begin() + 80, solids.begin() + 82);
+			solids.erase(solids.begin() + 7);
+			assert(mgr.get_iteration_order()->size() == solids.size());
+			for (int k = 0; k < 5; k++) {
+				solids.push_back(make_ball(random_point(), tr::half()));
+				mgr.add_solid(solids.back().get(), false);
+			}
+			floor->set_position(vec3<T>(T {}, tr::from_int(step % 4), T {}));
+			mgr.mark_moved();
+		}
+		mgr.pre_update(dt);
+		check();
+	}
+	assert(mgr.get_dynamic_count() == static_cast<int>(solids.size()) - 1);
+
+	printf("  grid queries[%s]: OK\n", label);
+}
+
+// Cells far from the origin and smaller than a unit: in fixed16 the quotient
+// coordinate / cell_size would overflow without the clamp to the grid's extent.
+template <typename T> static void test_grid_range(const char * label) {
+	using tr = scalar_traits<T>;
+	grid_manager<T> mgr;
+	mgr.set_cell_size(tr::quarter());
+	std::vector<std::shared_ptr<solid<T>>> solids;
+	const T far = tr::from_int(30000);
+	for (int i = 0; i < 6; i++) {
+		const T x = (i % 2 ? far : -far) + tr::from_milli(300 * i);
+		solids.push_back(make_ball(vec3<T>(x, -far, far), tr::from_milli(100)));
+		mgr.add_solid(solids.back().get(), false);
+	}
+	mgr.pre_update(tr::from_milli(16));
+	solid<T> * found[16];
+	for (auto & s : solids) {
+		const int n = mgr.find_solids_in_aa_box(s->get_world_bound(), found, 16);
+		assert(std::set<solid<T> *>(found, found + n) == brute_force(solids, s->get_world_bound()));
+	}
+
+	// Morton order: solids sharing a cell are walked one after another, even
+	// when added interleaved with solids of a far cell.
+	grid_manager<T> near_mgr;
+	near_mgr.set_cell_size(tr::two());
+	std::vector<std::shared_ptr<solid<T>>> pair;
+	for (int i = 0; i < 16; i++) {
+		const T x = i % 2 ? tr::from_int(40) : T {};
+		pair.push_back(make_ball(vec3<T>(x + tr::from_milli(100 * i), T {}, T {}) + vec3<T>(tr::half(), tr::half(), tr::half()),
+		                         tr::from_milli(100)));
+		near_mgr.add_solid(pair.back().get(), false);
+	}
+	near_mgr.pre_update(tr::from_milli(16));
+	const auto * order = near_mgr.get_iteration_order();
+	assert(order->size() == 16);
+	int switches = 0;
+	for (size_t i = 1; i < order->size(); i++)
+		if (((*order)[i]->get_position().x > tr::from_int(20)) != ((*order)[i - 1]->get_position().x > tr::from_int(20)))
+			switches++;
+	assert(switches == 1);
+
+	printf("  grid range[%s]: OK\n", label);
+}
+
+// The pile of test_sap_simulator with the grid, which also drives the
+// simulator's iteration order.
+template <typename T> static void test_grid_simulator(const char * label) {
+	using tr = scalar_traits<T>;
+	auto sim = std::make_shared<simulator<T>>();
+	sim->set_gravity(vec3<T>(T {}, T {}, -tr::from_milli(9810)));
+	grid_manager<T> mgr;
+	mgr.set_cell_size(tr::one());
+	sim->set_manager(&mgr);
+
+	std::vector<std::shared_ptr<solid<T>>> solids;
+	auto floor = std::make_shared<solid<T>>();
+	floor->set_infinite_mass();
+	floor->set_coefficient_of_gravity(T {});
+	floor->add_shape(std::make_shared<shape<T>>(aa_box<T>(vec3<T>(-tr::from_int(10), -tr::from_int(10), -tr::one()),
+	                                                      vec3<T>(tr::from_int(10), tr::from_int(10), T {}))));
+	sim->add_solid(floor);
+	mgr.add_solid(floor.get(), true);
+	solids.push_back(floor);
+	for (int i = 0; i < 48; i++) {
+		auto b = make_ball(vec3<T>(tr::from_milli(1100 * (i % 4) - 1650 + i % 3 * 40), tr::from_milli(1100 * (i / 4 % 4) - 1650),
+		                           tr::from_milli(600 + 1100 * (i / 16))),
+		                   tr::half());
+		b->set_mass(tr::one());
+		sim->add_solid(b);
+		if (i % 2)
+			b->set_contact_mode(contact_mode::speculative);
+		mgr.add_solid(b.get(), false);
+		solids.push_back(b);
+	}
+
+	solid<T> * found[128];
+	for (int t = 0; t < 200; t++) {
+		sim->update(tr::from_milli(16));
+		assert(mgr.get_iteration_order()->size() == solids.size());
+		for (size_t i = 1; i < solids.size(); i++) {
+			const aa_box<T> & box = solids[i]->get_world_bound();
+			const int n = mgr.find_solids_in_aa_box(box, found, 128);
+			assert(std::set<solid<T> *>(found, found + n) == brute_force(solids, box));
+		}
+	}
+	for (size_t i = 1; i < solids.size(); i++)
+		assert(solids[i]->get_position().z > tr::from_milli(300));
+
+	printf("  grid simulator[%s]: OK\n", label);
+}
+
+// ============================================================
+// for_each_solid_in_aa_box
+// ============================================================
+
+// Uses manager's default for_each_solid_in_aa_box, over bvh_manager's buffer.
+template <typename T> class buffered_bvh : public bvh_manager<T> {
+public:
+	bool for_each_solid_in_aa_box(const aa_box<T> & box, const std::function<bool(solid<T> *)> & fn,
+	                              int collide_with_bits = -1) override {
+		return manager<T>::for_each_solid_in_aa_box(box, fn, collide_with_bits);
+	}
+};
+
+// The callback query visits what find_solids_in_aa_box reports, in its order,
+// and stops where the callback does; a full buffer holds the head of the list.
+template <typename T> static void test_for_each_queries(const char * label) {
+	using tr = scalar_traits<T>;
+	unsigned seed = 4242;
+	auto rnd = [&](int lo, int hi) {
+		seed = seed * 1103515245u + 12345u;
+		return lo + static_cast<int>((seed >> 8) % static_cast<unsigned>(hi - lo));
+	};
+	auto random_point = [&] {
+		return vec3<T>(tr::from_milli(rnd(-12000, 12000)), tr::from_milli(rnd(-12000, 12000)), tr::from_milli(rnd(-2000, 3000)));
+	};
+	std::vector<std::shared_ptr<solid<T>>> solids;
+	for (int i = 0; i < 800; i++) {
+		solids.push_back(make_ball(random_point(), tr::from_milli(rnd(200, 500))));
+		solids.back()->set_collision_scope(i % 3 == 0 ? 2 : 1);
+	}
+
+	bvh_manager<T> refit, incremental;
+	incremental.set_incremental_dynamic(true);
+	buffered_bvh<T> buffered;
+	sap_manager<T> sap;
+	grid_manager<T> grid;
+	grid.set_cell_size(tr::one());
+	for (size_t i = 0; i < solids.size(); i++) {
+		const bool is_static = i % 4 == 0;
+		refit.add_solid(solids[i].get(), is_static);
+		incremental.add_solid(solids[i].get(), is_static);
+		buffered.add_solid(solids[i].get(), is_static);
+		sap.add_solid(solids[i].get(), is_static);
+		grid.add_solid(solids[i].get(), is_static);
+	}
+	manager<T> * managers[] = { &refit, &incremental, &buffered, &sap, &grid };
+	for (manager<T> * mgr : managers) {
+		mgr->pre_update(tr::from_milli(16));
+		solid<T> * found[1024];
+		int visited = 0;
+		for (int q = 0; q < 40; q++) {
+			const vec3<T> c = random_point();
+			aa_box<T> box(c, c);
+			const T size = q == 0 ? tr::from_int(30) : tr::from_milli(rnd(0, 4000));
+			box.mins -= vec3<T>(size, size, size);
+			box.maxs += vec3<T>(size, size, size);
+			for (int bits : { -1, 2 }) {
+				const int n = mgr->find_solids_in_aa_box(box, found, 1024, bits);
+				std::vector<solid<T> *> seen;
+				assert(mgr->for_each_solid_in_aa_box(box, [&](solid<T> * s) { seen.push_back(s); return true; }, bits));
+				assert(seen == std::vector<solid<T> *>(found, found + n));
+				visited += n;
+
+				int calls = 0;
+				mgr->for_each_solid_in_aa_box(box, [&](solid<T> *) { return ++calls < 2; }, bits);
+				assert(calls == std::min(n, 2));
+				solid<T> * head[3];
+				const int h = mgr->find_solids_in_aa_box(box, head, 3, bits);
+				assert(h == std::min(n, 3) && std::equal(head, head + h, found));
+			}
+		}
+		assert(visited > 800);
+	}
+
+	printf("  for_each queries[%s]: OK\n", label);
+}
+
+int main() {
+	printf("test_broadphase:\n");
+	test_sap_pairs<float>("float");
+	test_sap_pairs<fixed16>("fixed16");
+	test_sap_simulator<float>("float");
+	test_sap_simulator<fixed16>("fixed16");
+	test_grid_queries<float>("float");
+	test_grid_queries<fixed16>("fixed16");
+	test_grid_range<float>("float");
+	test_grid_range<fixed16>("fixed16");
+	test_grid_simulator<float>("float");
+	test_grid_simulator<fixed16>("fixed16");
+	test_for_each_queries<float>("float");
+	test_for_each_queries<fixed16>("fixed16");
+	printf("ALL PASSED\n");
+	return 0;
+}
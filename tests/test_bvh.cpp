@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <map>
 #include <vector>
 #include <set>
 #include <hop/hop.h>
@@ -184,6 +187,451 @@ static void test_bvh_ray_query_parallel_axis() {
 // BVH Manager tests
 // ============================================================
 
+// The SAH builder reorganizes the tree, never its contents: every query must
+// report exactly the items the median-split tree does, on a mixed-size world
+// (slabs, props, and coincident boxes that leave SAH nothing to split).
+template <typename T>
+static void test_bvh_sah() {
+	using tr = scalar_traits<T>;
+	unsigned seed = 12345;
+	auto rnd = [&](int lo, int hi) {
+		seed = seed * 1103515245u + 12345u;
+		return lo + static_cast<int>((seed >> 8) % static_cast<unsigned>(hi - lo));
+	};
+	std::vector<std::pair<aa_box<T>, int>> entries;
+	for (int i = 0; i < 16; i++) {  // 20x20 terrain slabs
+		T x = tr::from_int(20 * (i % 4) - 40), y = tr::from_int(20 * (i / 4) - 40);
+		entries.push_back({aa_box<T>(vec3<T>(x, y, -tr::one()), vec3<T>(x + tr::from_int(20), y + tr::from_int(20), T{})), i});
+	}
+	for (int i = 16; i < 400; i++) {  // small props
+		vec3<T> c(tr::from_milli(rnd(-40000, 40000)), tr::from_milli(rnd(-40000, 40000)), tr::from_milli(rnd(0, 4000)));
+		T h = tr::from_milli(rnd(100, 800));
+		entries.push_back({aa_box<T>(vec3<T>(c.x - h, c.y - h, c.z - h), vec3<T>(c.x + h, c.y + h, c.z + h)), i});
+	}
+	for (int i = 400; i < 410; i++)  // a stack of identical crates
+		entries.push_back({aa_box<T>(vec3<T>(T{}, T{}, T{}), vec3<T>(tr::one(), tr::one(), tr::one())), i});
+
+	auto median_entries = entries;
+	bvh<T, int> median, sah;
+	median.build(median_entries);
+	sah.set_build_method(bvh_build::sah);
+	sah.build(entries);
+	assert(sah.size() == 2 * 410 - 1);
+	std::vector<int> leaves;
+	sah.collect_leaves(leaves);
+	assert(std::set<int>(leaves.begin(), leaves.end()).size() == 410);
+
+	for (int q = 0; q < 200; q++) {
+		vec3<T> c(tr::from_milli(rnd(-45000, 45000)), tr::from_milli(rnd(-45000, 45000)), tr::from_milli(rnd(-2000, 5000)));
+		T h = tr::from_milli(rnd(200, 3000));
+		aa_box<T> box(vec3<T>(c.x - h, c.y - h, c.z - h), vec3<T>(c.x + h, c.y + h, c.z + h));
+		std::set<int> a, b;
+		median.query_aabb(box, [&](int item) { a.insert(item); });
+		sah.query_aabb(box, [&](int item) { b.insert(item); });
+		assert(a == b);
+
+		vec3<T> dir(tr::from_milli(rnd(-20000, 20000)), tr::from_milli(rnd(-20000, 20000)), tr::from_milli(rnd(-4000, 1000)));
+		a.clear();
+		b.clear();
+		median.query_ray(c, dir, [&](int item, T &) { a.insert(item); });
+		sah.query_ray(c, dir, [&](int item, T &) { b.insert(item); });
+		assert(a == b);
+	}
+
+	if constexpr (is_fixed_scalar_v<T>) {
+		// Fixed-point costs are integer on the raw values: they must still order
+		// boxes spanning most of T's range, whose areas overflow T, with a
+		// million items' worth of headroom.
+		using cost = bvh_cost<T>;
+		const T far = tr::from_int(30000);
+		const aa_box<T> world(vec3<T>(-far, -far, -far), vec3<T>(far, far, far));
+		const aa_box<T> half_world(vec3<T>(-far, -far, -far), vec3<T>(T{}, far, far));
+		const aa_box<T> crate(vec3<T>(T{}, T{}, T{}), vec3<T>(tr::one(), tr::one(), tr::one()));
+		const int shift = cost::shift_for(world, 1 << 20);
+		assert(cost::area(world, shift) > cost::area(half_world, shift));
+		assert(cost::area(half_world, shift) > cost::area(crate, shift) && cost::area(crate, shift) > 0);
+		assert(cost::area(world, shift) < (std::int64_t {1} << 62) / (1 << 20));
+		const auto lo = cost::centroid(half_world, 0), hi = cost::centroid(crate, 0);
+		assert(cost::bin(lo, lo, hi, 16) == 0 && cost::bin(hi, lo, hi, 16) == 15);
+		assert(cost::bin(cost::centroid(world, 0), lo, hi, 16) == 15);
+	}
+
+	printf("  bvh sah: OK\n");
+}
+
+// The flattened layout: depth-first nodes, a left child right after its
+// parent, a right child where the left subtree ends, items in leaf order.
+template <typename T>
+static void test_bvh_layout() {
+	using tr = scalar_traits<T>;
+	static_assert(sizeof(typename bvh<T, int>::node) == 32, "32-byte nodes");
+	std::vector<std::pair<aa_box<T>, int>> entries;
+	for (int i = 0; i < 100; i++) {
+		T x = tr::from_int((i * 37) % 50), y = tr::from_int((i * 11) % 20);
+		entries.push_back({aa_box<T>(vec3<T>(x, y, T{}), vec3<T>(x + tr::one(), y + tr::half(), tr::one())), i});
+	}
+	for (bvh_build method : {bvh_build::median, bvh_build::sah}) {
+		auto copy = entries;
+		bvh<T, int> tree;
+		tree.set_build_method(method);
+		tree.build(copy);
+		const auto & nodes = tree.get_nodes();
+		assert(tree.size() == 199 && tree.get_items().size() == 100);
+		assert(nodes[0].escape == tree.size());
+		int next_leaf = 0;
+		for (int i = 0; i < tree.size(); i++) {
+			const auto & n = nodes[i];
+			if (n.is_leaf()) {
+				assert(n.escape == i + 1 && n.leaf == next_leaf++);
+				continue;
+			}
+			const int l = i + 1, r = tree.right_child(i);
+			assert(r > l && nodes[r].escape == n.escape);
+			for (int c : {l, r})
+				assert(n.box.mins.x <= nodes[c].box.mins.x && nodes[c].box.maxs.z <= n.box.maxs.z);
+		}
+		assert(next_leaf == 100);
+	}
+	printf("  bvh layout: OK\n");
+}
+
+// A query_aabb callback returning false ends the walk, in each tree.
+template <typename T>
+static void test_bvh_early_out() {
+	using tr = scalar_traits<T>;
+	std::vector<std::pair<aa_box<T>, int>> entries;
+	for (int i = 0; i < 100; i++) {
+		T x = tr::from_int((i * 37) % 50), y = tr::from_int((i * 11) % 20);
+		entries.push_back({aa_box<T>(vec3<T>(x, y, T{}), vec3<T>(x + tr::one(), y + tr::half(), tr::one())), i});
+	}
+	const aa_box<T> all(vec3<T>(-tr::one(), -tr::one(), -tr::one()), vec3<T>(tr::from_int(60), tr::from_int(30), tr::from_int(2)));
+	bvh<T, int> tree;
+	wide_bvh<T, int> wide;
+	dynamic_tree<T, int> dyn;
+	auto copy = entries;
+	tree.build(copy);
+	wide.build(tree);
+	for (const auto & e : entries)
+		dyn.insert(e.first, vec3<T>{}, e.second);
+	auto stops_at = [&](auto & t, int limit) {
+		int calls = 0;
+		t.query_aabb(all, [&](int) { return ++calls < limit; });
+		return calls;
+	};
+	for (int limit : {1, 7, 100, 200}) {
+		const int expected = limit < 100 ? limit : 100;
+		assert(stops_at(tree, limit) == expected);
+		assert(stops_at(wide, limit) == expected);
+		assert(stops_at(dyn, limit) == expected);
+	}
+	printf("  bvh early out: OK\n");
+}
+
+// A masked query reports exactly the overlapping items whose mask shares a
+// bit, through build, refit and a mask change; without masks, every overlap.
+template <typename T>
+static void test_bvh_masks() {
+	using tr = scalar_traits<T>;
+	std::vector<std::pair<aa_box<T>, int>> entries;
+	std::vector<int> mask(200);
+	for (int i = 0; i < 200; i++) {
+		T x = tr::from_int((i * 37) % 80), y = tr::from_int((i * 11) % 30);
+		entries.push_back({aa_box<T>(vec3<T>(x, y, T{}), vec3<T>(x + tr::one(), y + tr::one(), tr::one())), i});
+		// Layers by region, as hitboxes and debris tend to be, plus a few
+		// solids on every layer and a few on none.
+		mask[i] = i % 17 == 0 ? -1 : i % 19 == 0 ? 0 : (i * 37) % 80 < 40 ? 1 : 2;
+	}
+	auto boxes = entries;  // by item
+	bvh<T, int> tree;
+	auto copy = entries;
+	tree.build(copy);
+	auto check = [&](int bits, bool masked) {
+		for (int q = 0; q < 40; q++) {
+			T x = tr::from_int((q * 13) % 80), y = tr::from_int((q * 7) % 30);
+			aa_box<T> box(vec3<T>(x - tr::two(), y - tr::two(), -tr::one()), vec3<T>(x + tr::from_int(6), y + tr::from_int(6), tr::two()));
+			std::set<int> expected, got;
+			for (const auto & e : boxes)
+				if (test_intersection(e.first, box) && (!masked || (mask[e.second] & bits) != 0))
+					expected.insert(e.second);
+			tree.query_aabb(box, bits, [&](int item) { got.insert(item); });
+			assert(got == expected);
+		}
+	};
+	auto get_mask = [&](int item) { return mask[item]; };
+	check(1, false);
+	tree.set_masks(get_mask);
+	assert(tree.has_masks());
+	check(1, true);
+	check(2, true);
+	check(3, true);
+
+	// Move everything and flip a few layers; the two-getter refit keeps both.
+	for (auto & e : boxes) {
+		e.first.mins.x += tr::half();
+		e.first.maxs.x += tr::half();
+	}
+	for (int i = 0; i < 200; i += 23)
+		mask[i] = mask[i] == 1 ? 2 : 1;
+	tree.refit([&](int item) { return boxes[item].first; }, get_mask);
+	check(1, true);
+	check(2, true);
+
+	copy = entries;
+	tree.build(copy);
+	assert(!tree.has_masks());
+	printf("  bvh masks: OK\n");
+}
+
+// wide_bvh reports what bvh does at either width: every overlap, every ray
+// hit without pruning, and the same nearest hit with it.
+template <typename T, int Width>
+static void test_wide_bvh() {
+	using tr = scalar_traits<T>;
+	unsigned seed = 4242;
+	auto rnd = [&](int lo, int hi) {
+		seed = seed * 1103515245u + 12345u;
+		return lo + static_cast<int>((seed >> 8) % static_cast<unsigned>(hi - lo));
+	};
+	std::vector<std::pair<aa_box<T>, int>> entries;
+	for (int i = 0; i < 600; i++) {
+		vec3<T> c(tr::from_milli(rnd(-30000, 30000)), tr::from_milli(rnd(-30000, 30000)), tr::from_milli(rnd(0, 4000)));
+		T h = tr::from_milli(rnd(100, i < 20 ? 6000 : 800));
+		entries.push_back({aa_box<T>(vec3<T>(c.x - h, c.y - h, c.z - h), vec3<T>(c.x + h, c.y + h, c.z + h)), i});
+	}
+	const auto boxes = entries;  // by item
+	// Where the ray enters item's box, for the pruning callbacks.
+	auto entry_t = [&](int item, const vec3<T> & o, const vec3<T> & d, T & t) {
+		T tmin {}, tmax = tr::one();
+		for (int axis = 0; axis < 3; axis++) {
+			const aa_box<T> & b = boxes[item].first;
+			if (d[axis] == T{}) {
+				if (o[axis] < b.mins[axis] || o[axis] > b.maxs[axis])
+					return false;
+				continue;
+			}
+			T inv = tr::one() / d[axis];
+			T t1 = (b.mins[axis] - o[axis]) * inv, t2 = (b.maxs[axis] - o[axis]) * inv;
+			tmin = tr::max_val(tmin, tr::min_val(t1, t2));
+			tmax = tr::min_val(tmax, tr::max_val(t1, t2));
+		}
+		t = tmin;
+		return tmax >= tmin;
+	};
+
+	for (bvh_build method : {bvh_build::median, bvh_build::sah}) {
+		auto a = entries, b = entries;
+		bvh<T, int> tree;
+		wide_bvh<T, int, Width> wide;
+		tree.set_build_method(method);
+		wide.set_build_method(method);
+		tree.build(a);
+		wide.build(b);
+		assert(wide.get_items().size() == 600 && wide.size() < tree.size() / 2);
+
+		for (int q = 0; q < 300; q++) {
+			vec3<T> c(tr::from_milli(rnd(-32000, 32000)), tr::from_milli(rnd(-32000, 32000)), tr::from_milli(rnd(-1000, 5000)));
+			T h = tr::from_milli(rnd(100, 4000));
+			aa_box<T> box(vec3<T>(c.x - h, c.y - h, c.z - h), vec3<T>(c.x + h, c.y + h, c.z + h));
+			std::multiset<int> x, y;
+			tree.query_aabb(box, [&](int item) { x.insert(item); });
+			wide.query_aabb(box, [&](int item) { y.insert(item); });
+			assert(x == y);
+
+			vec3<T> dir(tr::from_milli(rnd(-30000, 30000)), tr::from_milli(rnd(-30000, 30000)), tr::from_milli(rnd(-4000, 1000)));
+			if (q % 10 == 0)
+				dir.x = T{};  // parallel to a slab
+			x.clear();
+			y.clear();
+			tree.query_ray(c, dir, [&](int item, T &) { x.insert(item); });
+			wide.query_ray(c, dir, [&](int item, T &) { y.insert(item); });
+			assert(x == y);
+
+			T ta = tr::one(), tb = tr::one();
+			auto nearest = [&](T & found) {
+				return [&](int item, T & best_t) {
+					T t;
+					if (entry_t(item, c, dir, t) && t < best_t)
+						best_t = found = t;
+				};
+			};
+			tree.query_ray(c, dir, nearest(ta));
+			wide.query_ray(c, dir, nearest(tb));
+			assert(ta == tb);
+		}
+	}
+
+	wide_bvh<T, int, Width> one, none;
+	std::vector<std::pair<aa_box<T>, int>> single = {entries[0]};
+	one.build(single);
+	int count = 0;
+	one.query_aabb(entries[0].first, [&](int item) { assert(item == 0); count++; });
+	none.query_aabb(entries[0].first, [&](int) { count++; });
+	none.query_ray(vec3<T>{}, vec3<T>(tr::one(), T{}, T{}), [&](int, T &) { count++; });
+	assert(count == 1 && none.empty());
+
+	printf("  wide bvh %d: OK\n", Width);
+}
+
+template <typename T>
+static void test_bvh_pairs() {
+	using tr = scalar_traits<T>;
+	unsigned seed = 999;
+	auto rnd = [&](int lo, int hi) {
+		seed = seed * 1103515245u + 12345u;
+		return lo + static_cast<int>((seed >> 8) % static_cast<unsigned>(hi - lo));
+	};
+	auto random_boxes = [&](int n, int first) {
+		std::vector<std::pair<aa_box<T>, int>> entries;
+		for (int i = 0; i < n; i++) {
+			vec3<T> c(tr::from_milli(rnd(-20000, 20000)), tr::from_milli(rnd(-20000, 20000)), tr::from_milli(rnd(0, 5000)));
+			T h = tr::from_milli(rnd(100, 1500));
+			entries.push_back({aa_box<T>(vec3<T>(c.x - h, c.y - h, c.z - h), vec3<T>(c.x + h, c.y + h, c.z + h)), first + i});
+		}
+		return entries;
+	};
+	auto a_entries = random_boxes(300, 0), b_entries = random_boxes(120, 1000);
+	// A world-spanning slab, whose half-perimeter overflows fixed16: the walk
+	// must still pick which side to descend by a sound comparison.
+	const T far = tr::from_int(30000);
+	b_entries.push_back({aa_box<T>(vec3<T>(-far, -far, -tr::one()), vec3<T>(far, far, T{})), 2000});
+	const auto a_boxes = a_entries, b_boxes = b_entries;  // build() reorders
+	bvh<T, int> a, b;
+	a.build(a_entries);
+	b.set_build_method(bvh_build::sah);
+	b.build(b_entries);
+
+	std::set<std::pair<int, int>> got, expect;
+	a.query_pairs(b, [&](int x, int y) { assert(got.insert({x, y}).second); });
+	for (auto & x : a_boxes)
+		for (auto & y : b_boxes)
+			if (test_intersection(x.first, y.first))
+				expect.insert({x.second, y.second});
+	assert(got == expect && !got.empty());
+
+	got.clear();
+	expect.clear();
+	a.query_self_pairs([&](int x, int y) {
+		assert(x != y);
+		assert(got.insert({std::min(x, y), std::max(x, y)}).second);  // each pair once
+	});
+	for (size_t i = 0; i < a_boxes.size(); i++)
+		for (size_t j = i + 1; j < a_boxes.size(); j++)
+			if (test_intersection(a_boxes[i].first, a_boxes[j].first))
+				expect.insert({std::min(a_boxes[i].second, a_boxes[j].second), std::max(a_boxes[i].second, a_boxes[j].second)});
+	assert(got == expect && !got.empty());
+
+	bvh<T, int> empty;
+	int calls = 0;
+	a.query_pairs(empty, [&](int, int) { calls++; });
+	empty.query_self_pairs([&](int, int) { calls++; });
+	assert(calls == 0);
+
+	printf("  bvh pairs: OK\n");
+}
+
+template <typename T>
+static void test_dynamic_tree() {
+	using tr = scalar_traits<T>;
+	unsigned seed = 777;
+	auto rnd = [&](int lo, int hi) {
+		seed = seed * 1103515245u + 12345u;
+		return lo + static_cast<int>((seed >> 8) % static_cast<unsigned>(hi - lo));
+	};
+	auto random_box = [&](const vec3<T> & c) {
+		T h = tr::from_milli(rnd(100, 900));
+		return aa_box<T>(vec3<T>(c.x - h, c.y - h, c.z - h), vec3<T>(c.x + h, c.y + h, c.z + h));
+	};
+	auto random_point = [&] {
+		return vec3<T>(tr::from_milli(rnd(-30000, 30000)), tr::from_milli(rnd(-30000, 30000)), tr::from_milli(rnd(0, 10000)));
+	};
+
+	dynamic_tree<T, int> tree;
+	std::vector<aa_box<T>> tight(300);
+	std::vector<int> proxy(300, -1);
+	for (int i = 0; i < 300; i++) {
+		tight[i] = random_box(random_point());
+		proxy[i] = tree.insert(tight[i], vec3<T>{}, i);
+	}
+	assert(tree.size() == 300);
+
+	auto check = [&] {
+		for (int q = 0; q < 50; q++) {
+			aa_box<T> box = random_box(random_point());
+			box.mins -= vec3<T>(tr::two(), tr::two(), tr::two());
+			box.maxs += vec3<T>(tr::two(), tr::two(), tr::two());
+			std::set<int> got, expect;
+			tree.query_aabb(box, [&](int i) {
+				if (test_intersection(box, tight[i]))
+					got.insert(i);
+			});
+			for (int i = 0; i < 300; i++)
+				if (proxy[i] >= 0 && test_intersection(box, tight[i]))
+					expect.insert(i);
+			assert(got == expect);
+		}
+		std::vector<int> leaves;
+		tree.collect_leaves(leaves);
+		assert(static_cast<int>(leaves.size()) == tree.size());
+		assert(std::set<int>(leaves.begin(), leaves.end()).size() == leaves.size());
+		// Rotations keep the tree near log2(n) deep.
+		assert(tree.get_height() <= 20);
+	};
+	check();
+
+	// Small jitters stay inside the fat boxes; long moves reinsert.
+	int reinserted = 0;
+	for (int step = 0; step < 20; step++) {
+		for (int i = 0; i < 300; i++) {
+			if (proxy[i] < 0)
+				continue;
+			const bool jump = rnd(0, 10) == 0;
+			vec3<T> d = jump ? vec3<T>(tr::from_milli(rnd(-5000, 5000)), tr::from_milli(rnd(-5000, 5000)), T{})
+			                 : vec3<T>(tr::from_milli(rnd(-20, 20)), T{}, T{});
+			tight[i].mins += d;
+			tight[i].maxs += d;
+			if (tree.move(proxy[i], tight[i], d))
+				reinserted++;
+			const aa_box<T> & fat = tree.get_fat_box(proxy[i]);
+			assert(fat.mins.x <= tight[i].mins.x && tight[i].maxs.x <= fat.maxs.x);
+		}
+		for (int i = step; i < 300; i += 37) {
+			if (proxy[i] >= 0) {
+				tree.remove(proxy[i]);
+				proxy[i] = -1;
+			}
+		}
+		check();
+	}
+	assert(reinserted > 0 && reinserted < 20 * 300 / 2);
+
+	// Rays agree with a brute-force slab test over the fat boxes.
+	for (int q = 0; q < 50; q++) {
+		vec3<T> o = random_point();
+		vec3<T> dir(tr::from_milli(rnd(-20000, 20000)), tr::from_milli(rnd(-20000, 20000)), tr::from_milli(rnd(-4000, 4000)));
+		std::set<int> got, expect;
+		tree.query_ray(o, dir, [&](int i, T &) { got.insert(i); });
+		for (int i = 0; i < 300; i++)
+			if (proxy[i] >= 0 && bvh<T, int>::ray_hits_aabb(o, dir, tree.get_fat_box(proxy[i]), tr::one()))
+				expect.insert(i);
+		assert(got == expect);
+	}
+
+	// A world-spanning slab beside small boxes: the insertion costs (integer for
+	// the fixed-point types, where the slab's area overflows T) must still
+	// build a shallow tree that finds everything.
+	dynamic_tree<T, int> world;
+	const T far = tr::from_int(30000);
+	world.insert(aa_box<T>(vec3<T>(-far, -far, -tr::one()), vec3<T>(far, far, T{})), vec3<T>{}, 300);
+	for (int i = 0; i < 300; i++)
+		world.insert(tight[i], vec3<T>{}, i);
+	assert(world.get_height() <= 20);
+	std::set<int> all;
+	world.query_aabb(aa_box<T>(vec3<T>(-far, -far, -far), vec3<T>(far, far, far)), [&](int i) { all.insert(i); });
+	assert(all.size() == 301);
+
+	printf("  dynamic tree: OK\n");
+}
+
 template <typename T>
 static void test_bvh_manager_basic() {
 	using tr = scalar_traits<T>;
@@ -288,6 +736,68 @@ static void test_bvh_manager_mixed() {
 	printf("  bvh_manager mixed static+dynamic: OK\n");
 }
 
+// Scope pruning returns what the leaf filter does, for statics and dynamics,
+// and follows scope changes through mark_dirty() and the next tick.
+template <typename T>
+static void test_bvh_manager_scope_pruning() {
+	using tr = scalar_traits<T>;
+
+	auto sim = std::make_shared<simulator<T>>();
+	sim->set_gravity(vec3<T>{});
+	bvh_manager<T> mgr;
+	mgr.set_scope_pruning(true);
+	assert(mgr.get_scope_pruning());
+	sim->set_manager(&mgr);
+
+	std::vector<std::shared_ptr<solid<T>>> solids;
+	for (int i = 0; i < 120; i++) {
+		auto s = std::make_shared<solid<T>>();
+		const bool is_static = i % 2 == 0;
+		if (is_static)
+			s->set_infinite_mass();
+		else
+			s->set_mass(tr::one());
+		const int x = (i * 7) % 60 - 30;
+		s->set_position(vec3<T>(tr::from_int(x), tr::from_int((i * 3) % 20), T{}));
+		s->add_shape(std::make_shared<shape<T>>(aa_box<T>(tr::half())));
+		s->set_collision_scope(i % 13 == 0 ? -1 : i % 11 == 0 ? 0 : x < 0 ? 1 : 2);
+		sim->add_solid(s);
+		mgr.add_solid(s.get(), is_static);
+		solids.push_back(s);
+	}
+	sim->update(tr::from_milli(10));
+
+	auto check = [&]() {
+		for (int bits : {-1, 1, 2, 3, 4}) {
+			for (int q = 0; q < 12; q++) {
+				const T x = tr::from_int(q * 5 - 30);
+				aa_box<T> box(vec3<T>(x - tr::two(), -tr::one(), -tr::one()), vec3<T>(x + tr::from_int(8), tr::from_int(21), tr::one()));
+				std::set<solid<T> *> expected, got;
+				for (auto & s : solids)
+					if (test_intersection(box, s->get_world_bound()) && (bits == -1 || (bits & s->get_collision_scope()) != 0))
+						expected.insert(s.get());
+				solid<T> * found[128];
+				const int count = mgr.find_solids_in_aa_box(box, found, 128, bits);
+				got.insert(found, found + count);
+				assert(got == expected && count == static_cast<int>(expected.size()));
+			}
+		}
+	};
+	check();
+
+	// A static's new layer is seen once the static tree is marked dirty; a
+	// dynamic's, from the next tick.
+	solids[2]->set_collision_scope(4);
+	solids[3]->set_collision_scope(4);
+	mgr.mark_dirty();
+	sim->update(tr::from_milli(10));
+	check();
+
+	mgr.set_scope_pruning(false);
+	check();
+	printf("  bvh_manager scope pruning: OK\n");
+}
+
 template <typename T>
 static void test_bvh_manager_remove() {
 	using tr = scalar_traits<T>;
@@ -318,6 +828,402 @@ static void test_bvh_manager_remove() {
 	printf("  bvh_manager remove: OK\n");
 }
 
+// The scene the bvh_manager tests below share: a simulator run by mgr, the
+// solids added to both, and those since removed. check() runs 40 box queries
+// across the scene and compares each with a brute-force scan of the solids
+// still in it; with scoped set, two in three also filter by collision scope.
+template <typename T>
+struct manager_scene {
+	using tr = scalar_traits<T>;
+
+	bvh_manager<T> & mgr;
+	std::shared_ptr<simulator<T>> sim = std::make_shared<simulator<T>>();
+	std::vector<std::shared_ptr<solid<T>>> solids;
+	std::set<solid<T> *> removed;
+
+	explicit manager_scene(bvh_manager<T> & m) : mgr(m) {
+		sim->set_gravity(vec3<T>(T{}, T{}, -tr::from_milli(9810)));
+		sim->set_manager(&mgr);
+	}
+
+	void add(const std::shared_ptr<solid<T>> & s, bool is_static) {
+		sim->add_solid(s);
+		mgr.add_solid(s.get(), is_static);
+		solids.push_back(s);
+	}
+
+	void add_static(const aa_box<T> & box) {
+		auto s = std::make_shared<solid<T>>();
+		s->set_infinite_mass();
+		s->set_coefficient_of_gravity(T{});
+		s->add_shape(std::make_shared<shape<T>>(box));
+		add(s, true);
+	}
+
+	// A floor slab reaching half_width out from the origin, its top at z = 0.
+	void add_floor(int half_width) {
+		const T w = tr::from_int(half_width);
+		add_static(aa_box<T>(vec3<T>(-w, -w, -tr::one()), vec3<T>(w, w, T{})));
+	}
+
+	// A ball at the i'th point of an 8-wide grid spacing apart, centred on the
+	// origin; a zero radius leaves it without a shape.
+	std::shared_ptr<solid<T>> add_ball(int i, int spacing, T z, T radius = tr::half()) {
+		auto s = std::make_shared<solid<T>>();
+		s->set_position(vec3<T>(tr::from_int(spacing * (i % 8 - 4)), tr::from_int(spacing * (i / 8 - 4)), z));
+		if (radius > T{})
+			s->add_shape(std::make_shared<shape<T>>(hop::sphere<T>{vec3<T>{}, radius}));
+		add(s, false);
+		return s;
+	}
+
+	void remove(std::initializer_list<int> which) {
+		std::vector<solid<T> *> dead;
+		for (int i : which) {
+			sim->remove_solid(solids[i]);
+			removed.insert(solids[i].get());
+			dead.push_back(solids[i].get());
+		}
+		mgr.remove_solids(dead.data(), static_cast<int>(dead.size()));
+	}
+
+	void check(bool scoped = false) const {
+		solid<T> * found[128];
+		for (int q = 0; q < 40; q++) {
+			T x = tr::from_int(q % 8 * 5 - 20), y = tr::from_int(q / 8 * 8 - 20);
+			aa_box<T> box(vec3<T>(x, y, -tr::one()), vec3<T>(x + tr::from_int(5), y + tr::from_int(8), tr::from_int(6)));
+			const int bits = !scoped || q % 3 == 0 ? -1 : 1 << (q % 2);
+			int count = mgr.find_solids_in_aa_box(box, found, 128, bits);
+			std::set<solid<T> *> got(found, found + count), expect;
+			for (auto & s : solids)
+				if (!removed.count(s.get()) && !s->get_shapes().empty() && test_intersection(box, s->get_world_bound()) &&
+				    (bits == -1 || (bits & s->get_collision_scope()) != 0))
+					expect.insert(s.get());
+			assert(got == expect);
+		}
+	}
+};
+
+template <typename T>
+static void test_bvh_manager_incremental() {
+	using tr = scalar_traits<T>;
+
+	bvh_manager<T> mgr;
+	mgr.set_incremental_dynamic(true);
+	manager_scene<T> scene(mgr);
+	auto & solids = scene.solids;
+	scene.add_floor(20);
+	for (int i = 0; i < 64; i++) {
+		auto s = scene.add_ball(i, 3, tr::from_int(1 + i % 5), i != 5 ? tr::half() : T{});  // one body gets its shape late
+		s->set_velocity(vec3<T>(tr::from_int(i % 3 - 1), tr::from_int(i % 5 - 2), T{}));
+	}
+	assert(mgr.get_dynamic_tree().size() == 63);
+
+	auto check = [&] {
+		scene.check();
+		const auto * order = mgr.get_iteration_order();
+		assert(order && static_cast<int>(order->size()) == mgr.get_dynamic_count() + mgr.get_static_count());
+		assert(std::set<solid<T> *>(order->begin(), order->end()).size() == order->size());
+	};
+
+	for (int t = 0; t < 60; t++) {
+		if (t == 10)
+			solids[6]->add_shape(std::make_shared<shape<T>>(hop::sphere<T>{vec3<T>{}, tr::half()}));
+		if (t == 20)
+			scene.remove({ 1, 2, 40 });
+		if (t == 30) {  // moved outside the tick
+			solids[10]->set_position(vec3<T>(tr::from_int(15), tr::from_int(15), tr::from_int(3)));
+			mgr.mark_dynamic_moved();
+		}
+		scene.sim->update(tr::from_milli(16));
+		check();
+	}
+	assert(mgr.get_dynamic_tree().size() == 61);
+
+	// Switching back to the refit BVH leaves no proxies behind.
+	mgr.set_incremental_dynamic(false);
+	assert(mgr.get_dynamic_tree().size() == 0);
+	for (auto & s : solids)
+		assert(s->get_manager_proxy() == -1);
+	check();
+
+	printf("  bvh_manager incremental: OK\n");
+}
+
+// Dirty refit refits only moved solids' leaves, yet queries see every moved
+// solid, through a removal, a move outside the tick and bodies going to sleep.
+template <typename T>
+static void test_bvh_manager_dirty_refit() {
+	using tr = scalar_traits<T>;
+
+	bvh_manager<T> mgr;
+	mgr.set_dirty_refit(true);
+	assert(mgr.get_dirty_refit());
+	manager_scene<T> scene(mgr);
+	scene.add_floor(20);
+	for (int i = 0; i < 64; i++) {  // one in four moves, the rest rest on the floor
+		auto s = scene.add_ball(i, 3, i % 4 ? tr::half() : tr::from_int(1 + i % 5));
+		if (i % 4 == 0)
+			s->set_velocity(vec3<T>(tr::from_int(i % 3 - 1), tr::from_int(i % 5 - 2), T{}));
+	}
+
+	const T dt = tr::from_milli(16);
+	for (int t = 0; t < 60; t++) {
+		if (t == 20)
+			scene.remove({ 1, 2, 40 });
+		if (t == 30) {  // moved outside the tick
+			scene.solids[10]->set_position(vec3<T>(tr::from_int(15), tr::from_int(15), tr::from_int(3)));
+			mgr.mark_dynamic_moved();
+		}
+		scene.sim->update(dt);
+		// The trees are refit at the start of a tick; bring them up to the
+		// bodies' final positions before checking.
+		mgr.pre_update(dt);
+		scene.check();
+	}
+
+	printf("  bvh_manager dirty refit: OK\n");
+}
+
+// With the sleeping tree, bodies that come to rest leave the dynamic BVH and
+// return when woken, and queries, the pair pass and the iteration order see
+// every solid throughout: through a body knocked into the sleepers, a removed
+// sleeper, and switching the tree off.
+template <typename T>
+static void test_bvh_manager_sleeping_tree() {
+	using tr = scalar_traits<T>;
+
+	bvh_manager<T> mgr;
+	mgr.set_sleeping_tree(true);
+	mgr.set_pair_pass(true);
+	assert(mgr.get_sleeping_tree());
+	manager_scene<T> scene(mgr);
+	scene.add_floor(30);
+	for (int i = 0; i < 64; i++)  // packed close, resting on the floor
+		scene.add_ball(i, 2, tr::half());
+	const int dynamics = mgr.get_dynamic_count();
+
+	auto check = [&] {
+		assert(mgr.get_dynamic_count() + static_cast<int>(scene.removed.size()) == dynamics);
+		scene.check();
+		if (const auto * order = mgr.get_iteration_order()) {
+			std::set<solid<T> *> in_order(order->begin(), order->end());
+			assert(order->size() == in_order.size());
+			assert(in_order.size() == scene.sim->get_solids().size());
+		}
+	};
+
+	const T dt = tr::from_milli(16);
+	int most_asleep = 0;
+	for (int t = 0; t < 240; t++) {
+		if (t == 120) {  // roll one body into its neighbours
+			scene.solids[20]->set_velocity(vec3<T>(tr::from_int(4), tr::one(), T{}));
+			assert(mgr.get_sleeping_count() < most_asleep);
+		}
+		if (t == 150)
+			scene.remove({ 1, 64 });
+		scene.sim->update(dt);
+		mgr.pre_update(dt);
+		most_asleep = std::max(most_asleep, mgr.get_sleeping_count());
+		check();
+	}
+	// Resting bodies left the dynamic BVH.
+	assert(most_asleep > dynamics / 2);
+
+	mgr.set_sleeping_tree(false);
+	assert(mgr.get_sleeping_count() == 0);
+	check();
+
+	printf("  bvh_manager sleeping tree: OK\n");
+}
+
+// With the rebuild on a worker thread, queries between ticks still see every
+// moving solid, whether the tick swapped a new tree in or refit the old one,
+// and through removals that make a running rebuild stale. The swaps land on
+// fixed ticks, so two runs walk the same iteration orders.
+template <typename T>
+static void test_bvh_manager_async_rebuild() {
+	using tr = scalar_traits<T>;
+
+	auto run = [] {
+		bvh_manager<T> mgr;
+		mgr.set_async_rebuild(true);
+		mgr.set_scope_pruning(true);
+		assert(mgr.get_async_rebuild());
+		manager_scene<T> scene(mgr);
+		scene.sim->set_gravity(vec3<T>(T{}, T{}, T{}));
+		std::map<solid<T> *, int> index;
+		for (int i = 0; i < 96; i++) {
+			auto s = scene.add_ball(i, 3, tr::from_int(i % 3));
+			s->set_velocity(vec3<T>(tr::from_int(i % 5 - 2), tr::from_int(i % 3 - 1), T{}));
+			s->set_collision_scope(1 << (i % 2));
+			s->set_stay_active(true);
+			index[s.get()] = i;
+		}
+
+		std::vector<int> orders;
+		auto check = [&] {
+			scene.check(true);
+			for (auto * s : *mgr.get_iteration_order())
+				orders.push_back(index[s]);
+		};
+
+		const T dt = tr::from_milli(16);
+		for (int t = 0; t < 100; t++) {
+			if (t == 17 || t == 50)  // while a rebuild may be running
+				scene.remove({ t });
+			scene.sim->update(dt);
+			mgr.pre_update(dt);
+			check();
+		}
+		mgr.set_async_rebuild(false);
+		for (int t = 0; t < 20; t++) {
+			scene.sim->update(dt);
+			mgr.pre_update(dt);
+			check();
+		}
+		return orders;
+	};
+	assert(run() == run());
+
+	printf("  bvh_manager async rebuild: OK\n");
+}
+
+// The pair pass must hand every solid the same neighbours a tree search
+// would, whether its query fits its pair box (candidate list) or not (search).
+template <typename T>
+static void test_bvh_manager_pair_pass() {
+	using tr = scalar_traits<T>;
+
+	bvh_manager<T> mgr;
+	mgr.set_pair_pass(true);
+	manager_scene<T> scene(mgr);
+	scene.add_floor(20);
+	for (int i = 0; i < 24; i++) {  // enough pillars for the static BVH
+		T x = tr::from_int(5 * (i % 6) - 14), y = tr::from_int(7 * (i / 6) - 12);
+		scene.add_static(aa_box<T>(vec3<T>(x, y, T{}), vec3<T>(x + tr::half(), y + tr::half(), tr::from_int(2))));
+	}
+	for (int i = 0; i < 64; i++) {
+		auto s = scene.add_ball(i, 3, tr::from_int(1 + i % 5), i != 5 ? tr::from_milli(700) : T{});  // one body has no shape
+		s->set_velocity(vec3<T>(tr::from_int(i % 3 - 1), tr::from_int(i % 5 - 2), T{}));
+		s->set_mass(tr::one());
+		if (i % 2)
+			s->set_contact_mode(contact_mode::speculative);
+	}
+
+	int listed = 0;
+	for (int t = 0; t < 80; t++) {
+		if (t == 30)
+			scene.remove({ 30 });
+		scene.sim->update(tr::from_milli(16));
+		mgr.pre_update(tr::from_milli(16));  // the next tick's pairs, as a query made now would see them
+		assert(mgr.get_pair_count() > 0);
+		listed += mgr.get_pair_count();
+		solid<T> * found[128];
+		for (int grow : { 10, 4000 }) {  // inside the pair box, and far outside it
+			for (auto & sp : scene.solids) {
+				solid<T> * s = sp.get();
+				if (s->has_infinite_mass() || scene.removed.count(s))
+					continue;
+				aa_box<T> box = s->get_world_bound();
+				box.mins -= vec3<T>(tr::from_milli(grow), tr::from_milli(grow), tr::from_milli(grow));
+				box.maxs += vec3<T>(tr::from_milli(grow), tr::from_milli(grow), tr::from_milli(grow));
+				int count = mgr.find_solids_near(s, box, found, 128);
+				std::set<solid<T> *> got(found, found + count), expect;
+				got.erase(s);
+				for (auto & o : scene.solids)
+					if (o.get() != s && !scene.removed.count(o.get()) && !o->get_shapes().empty() &&
+					    test_intersection(box, o->get_world_bound()))
+						expect.insert(o.get());
+				assert(got == expect);
+			}
+		}
+	}
+	for (auto & s : scene.solids)
+		if (!s->has_infinite_mass() && !s->get_shapes().empty() && !scene.removed.count(s.get()))
+			assert(s->get_position().z > T{});
+
+	printf("  bvh_manager pair pass: %d candidates/tick OK\n", listed / 80);
+}
+
+// The wide static tree gives box queries and the simulator's segment traces
+// the same answers as the binary tree and as no manager at all, and a long
+// diagonal trace hands on fewer statics than its box holds.
+template <typename T>
+static void test_bvh_manager_wide_static() {
+	using tr = scalar_traits<T>;
+
+	bvh_manager<T> mgr;
+	manager_scene<T> scene(mgr);
+	scene.sim->set_gravity(vec3<T>(T{}, T{}, T{}));
+	scene.add_floor(20);
+	for (int i = 0; i < 48; i++) {  // pillars, below the balls
+		T x = tr::from_int(5 * (i % 8) - 19), y = tr::from_int(5 * (i / 8) - 14);
+		scene.add_static(aa_box<T>(vec3<T>(x, y, T{}), vec3<T>(x + tr::one(), y + tr::one(), tr::from_int(3))));
+	}
+	for (int i = 0; i < 32; i++)
+		scene.add_ball(i, 3, tr::from_int(5));
+
+	std::vector<segment<T>> segs(60);
+	std::uint32_t seed = 12345;
+	auto coord = [&](int lo, int hi) {
+		seed = seed * 1664525u + 1013904223u;
+		return tr::from_milli(lo + static_cast<int>((seed >> 8) % static_cast<std::uint32_t>(hi - lo)));
+	};
+	for (auto & seg : segs) {
+		vec3<T> a(coord(-19000, 19000), coord(-14000, 14000), coord(500, 6000));
+		vec3<T> b(coord(-19000, 19000), coord(-14000, 14000), coord(500, 6000));
+		seg.set_start_end(a, b);
+	}
+	auto trace_all = [&] {
+		std::vector<collision<T>> out(segs.size());
+		for (size_t i = 0; i < segs.size(); i++)
+			scene.sim->trace_segment(out[i], segs[i]);
+		return out;
+	};
+	auto same = [](const std::vector<collision<T>> & a, const std::vector<collision<T>> & b) {
+		for (size_t i = 0; i < a.size(); i++)
+			assert(a[i].time == b[i].time && a[i].collider == b[i].collider && a[i].normal == b[i].normal);
+	};
+
+	scene.sim->update(tr::from_milli(16));
+	auto binary = trace_all();
+	mgr.set_wide_static(true);
+	assert(mgr.get_wide_static());
+	auto wide = trace_all();
+	assert(!mgr.get_wide_static_tree().empty());
+	same(binary, wide);
+	std::vector<collision<T>> batch(segs.size());
+	scene.sim->trace_segments(batch.data(), segs.data(), static_cast<int>(segs.size()));
+	same(binary, batch);
+	scene.check();
+	mgr.set_scope_pruning(true);
+	scene.check(true);
+
+	int hits = 0;
+	for (auto & c : wide)
+		hits += c.time < tr::one();
+	assert(hits > 10);
+
+	// Corner to corner at pillar height: the box holds every pillar.
+	segment<T> diagonal;
+	diagonal.set_start_end(vec3<T>(-tr::from_int(19), -tr::from_int(14), tr::one()),
+	                       vec3<T>(tr::from_int(19), tr::from_int(14), tr::one()));
+	solid<T> * found[128];
+	const int on_segment = mgr.find_solids_on_segment(diagonal, T{}, found, 128);
+	aa_box<T> box(diagonal.origin, diagonal.get_end_point());
+	const int in_box = mgr.find_solids_in_aa_box(box, found, 128);
+	if (is_fixed_scalar_v<T>)
+		assert(on_segment == in_box);
+	else
+		assert(on_segment < in_box / 2);
+
+	scene.sim->set_manager(nullptr);
+	same(binary, trace_all());
+
+	printf("  bvh_manager wide static: %d of %d on the diagonal OK\n", on_segment, in_box);
+}
+
 template <typename T>
 static void test_bvh_manager_trace_segment() {
 	using tr = scalar_traits<T>;
@@ -451,6 +1357,67 @@ static void test_bvh_refit() {
 	printf("  bvh refit: OK\n");
 }
 
+// refit_leaves over the moved leaves leaves every node as a full refit does,
+// with and without masks, however few or many leaves moved.
+template <typename T>
+static void test_bvh_refit_leaves() {
+	using tr = scalar_traits<T>;
+	std::vector<std::pair<aa_box<T>, int>> entries;
+	std::vector<aa_box<T>> boxes;
+	std::vector<int> mask;
+	for (int i = 0; i < 300; i++) {
+		T x = tr::from_int((i * 37) % 90), y = tr::from_int((i * 11) % 40);
+		boxes.push_back(aa_box<T>(vec3<T>(x, y, T{}), vec3<T>(x + tr::one(), y + tr::one(), tr::one())));
+		entries.push_back({boxes.back(), i});
+		mask.push_back(1 << (i % 3));
+	}
+	bvh<T, int> partial, full;
+	auto copy = entries;
+	partial.build(copy);
+	copy = entries;
+	full.build(copy);
+	full.set_masks([&](int item) { return mask[item]; });
+
+	for (int round = 0; round < 6; round++) {
+		// Move a few items (all of them in the last round), some far, some
+		// inward, so boxes both grow and shrink.
+		std::vector<int> moved, moved_leaves;
+		for (int i = 0; i < 300; i++)
+			if (round == 5 || (i * 7 + round) % 41 == 0)
+				moved.push_back(i);
+		for (int i : moved) {
+			const T d = tr::from_int(round % 2 ? -(i % 5) : i % 7);
+			boxes[i].mins.x += d;
+			boxes[i].maxs.x += d;
+			mask[i] = 1 << ((i + round) % 3);
+		}
+		const auto & items = partial.get_items();
+		for (int k = 0; k < static_cast<int>(items.size()); k++)
+			if (std::find(moved.begin(), moved.end(), items[k]) != moved.end())
+				moved_leaves.push_back(k);
+		auto get_box = [&](int item) { return boxes[item]; };
+		auto get_mask = [&](int item) { return mask[item]; };
+		partial.refit_leaves(moved_leaves.data(), static_cast<int>(moved_leaves.size()), get_box);
+		full.refit(get_box, get_mask);
+		assert(partial.get_nodes().size() == full.get_nodes().size());
+		for (size_t n = 0; n < full.get_nodes().size(); n++)
+			assert(partial.get_nodes()[n].box == full.get_nodes()[n].box);
+
+		// The masked form on a copy of the full tree matches too.
+		std::vector<int> one(1, moved_leaves[0]);
+		bvh<T, int> masked = full;
+		masked.refit_leaves(one.data(), 1, get_box, get_mask);
+		for (int bits : {1, 2, 4}) {
+			std::set<int> a, b;
+			const aa_box<T> all(vec3<T>(-tr::from_int(50), -tr::one(), -tr::one()), vec3<T>(tr::from_int(150), tr::from_int(50), tr::two()));
+			masked.query_aabb(all, bits, [&](int item) { a.insert(item); });
+			full.query_aabb(all, bits, [&](int item) { b.insert(item); });
+			assert(a == b);
+		}
+	}
+	printf("  bvh refit_leaves: OK\n");
+}
+
 // collect_leaves should return every item exactly once. The order should be
 // spatial-cluster (left-to-right by the BVH split axes) — verify by building
 // items along +X and confirming the X-coordinates come back monotonically.
@@ -493,7 +1460,16 @@ int main() {
 	test_bvh_ray_query<float>();
 	test_bvh_ray_query_parallel_axis<float>();
 	test_bvh_refit<float>();
+	test_bvh_refit_leaves<float>();
 	test_bvh_collect_leaves<float>();
+	test_bvh_sah<float>();
+	test_bvh_pairs<float>();
+	test_bvh_layout<float>();
+	test_bvh_early_out<float>();
+	test_bvh_masks<float>();
+	test_wide_bvh<float, 4>();
+	test_wide_bvh<float, 8>();
+	test_dynamic_tree<float>();
 
 	printf("test_bvh (fixed16):\n");
 	test_bvh_empty<fixed16>();
@@ -502,12 +1478,28 @@ int main() {
 	test_bvh_ray_query<fixed16>();
 	test_bvh_ray_query_parallel_axis<fixed16>();
 	test_bvh_refit<fixed16>();
+	test_bvh_refit_leaves<fixed16>();
 	test_bvh_collect_leaves<fixed16>();
+	test_bvh_sah<fixed16>();
+	test_bvh_pairs<fixed16>();
+	test_bvh_layout<fixed16>();
+	test_bvh_early_out<fixed16>();
+	test_bvh_masks<fixed16>();
+	test_wide_bvh<fixed16, 4>();
+	test_wide_bvh<fixed16, 8>();
+	test_dynamic_tree<fixed16>();
 
 	printf("test_bvh_manager (float):\n");
 	test_bvh_manager_basic<float>();
 	test_bvh_manager_mixed<float>();
 	test_bvh_manager_remove<float>();
+	test_bvh_manager_scope_pruning<float>();
+	test_bvh_manager_incremental<float>();
+	test_bvh_manager_dirty_refit<float>();
+	test_bvh_manager_sleeping_tree<float>();
+	test_bvh_manager_async_rebuild<float>();
+	test_bvh_manager_pair_pass<float>();
+	test_bvh_manager_wide_static<float>();
 	test_bvh_manager_trace_segment<float>();
 	test_bvh_manager_trace_solid<float>();
 
@@ -515,6 +1507,13 @@ int main() {
 	test_bvh_manager_basic<fixed16>();
 	test_bvh_manager_mixed<fixed16>();
 	test_bvh_manager_remove<fixed16>();
+	test_bvh_manager_scope_pruning<fixed16>();
+	test_bvh_manager_incremental<fixed16>();
+	test_bvh_manager_dirty_refit<fixed16>();
+	test_bvh_manager_sleeping_tree<fixed16>();
+	test_bvh_manager_async_rebuild<fixed16>();
+	test_bvh_manager_pair_pass<fixed16>();
+	test_bvh_manager_wide_static<fixed16>();
 	test_bvh_manager_trace_segment<fixed16>();
 	test_bvh_manager_trace_solid<fixed16>();
 
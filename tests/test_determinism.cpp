@@ -0,0 +1,247 @@
+#include <atomic>
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <hop/hop.h>
+
+using namespace hop;
+
+// Lockstep replay depends on every parallel mode giving the same state for any
+// thread count. Each run below steps one mixed scene with all of them on and
+// folds the full body state, plus every collision event in delivery order, into
+// an FNV-1a hash; the hashes must match bit for bit across thread counts, with
+// no manager and with each spatial manager driving the broadphase.
+
+struct state_hash {
+	std::uint64_t h = 1469598103934665603ull;
+	void bytes(const void * p, size_t n) {
+		const unsigned char * c = static_cast<const unsigned char *>(p);
+		for (size_t i = 0; i < n; ++i) {
+			h ^= c[i];
+			h *= 1099511628211ull;
+		}
+	}
+	template <typename T> void scalar(const T & v) { bytes(&v, sizeof(T)); }
+	template <typename T> void vec(const vec3<T> & v) {
+		scalar(v.x);
+		scalar(v.y);
+		scalar(v.z);
+	}
+	void integer(long long v) { bytes(&v, sizeof(v)); }
+};
+
+// mgr may be null (brute-force broadphase); otherwise every solid is added to it.
+template <typename T, typename M>
+static std::uint64_t run_scene(M * mgr, int threads, int ticks, int & colored_ticks,
+                               task_scheduler * scheduler = nullptr) {
+	using tr = scalar_traits<T>;
+	auto sim = std::make_shared<simulator<T>>();
+	sim->set_gravity({ T {}, T {}, -tr::from_milli(9810) });
+	sim->set_default_contact_mode(contact_mode::speculative);
+	sim->set_parallel_pass_a(true);
+	sim->set_colored_solve(true);
+	sim->set_thread_count(threads);
+	sim->set_task_scheduler(scheduler);
+	if (mgr)
+		sim->set_manager(mgr);
+
+	std::vector<std::shared_ptr<solid<T>>> bodies;
+	auto add_box = [&](vec3<T> mins, vec3<T> maxs) {
+		auto b = std::make_shared<solid<T>>();
+		b->set_infinite_mass();
+		b->set_coefficient_of_gravity(T {});
+		b->add_shape(std::make_shared<shape<T>>(aa_box<T>(mins, maxs)));
+		sim->add_solid(b);
+		if (mgr)
+			mgr->add_solid(b.get(), true);
+		bodies.push_back(b);
+	};
+	add_box({ -tr::from_int(10), -tr::from_int(10), -tr::one() }, { tr::from_int(10), tr::from_int(10), T {} });
+	add_box({ -tr::from_int(5), -tr::from_int(5), T {} }, { -tr::from_int(4), tr::from_int(5), tr::from_int(6) });
+	add_box({ tr::from_int(4), -tr::from_int(5), T {} }, { tr::from_int(5), tr::from_int(5), tr::from_int(6) });
+	add_box({ -tr::from_int(4), -tr::from_int(5), T {} }, { tr::from_int(4), -tr::from_int(4), tr::from_int(6) });
+	add_box({ -tr::from_int(4), tr::from_int(4), T {} }, { tr::from_int(4), tr::from_int(5), tr::from_int(6) });
+
+	state_hash events;
+	auto add_ball = [&](T x, T y, T z, bool spin, bool slide) {
+		auto b = std::make_shared<solid<T>>();
+		b->set_mass(tr::one());
+		b->set_position({ x, y, z });
+		b->add_shape(std::make_shared<shape<T>>(hop::sphere<T> { vec3<T> {}, tr::half() }));
+		if (spin)
+			b->set_inertia({ tr::from_milli(100), tr::from_milli(100), tr::from_milli(100) });
+		const long long id = static_cast<long long>(bodies.size());
+		b->set_collision_callback([&events, id](const collision<T> & c) {
+			events.integer(id);
+			events.vec(c.normal);
+		});
+		sim->add_solid(b);
+		if (mgr)
+			mgr->add_solid(b.get(), false);
+		if (slide)
+			b->set_contact_mode(contact_mode::sweep_slide);
+		bodies.push_back(b);
+		return b;
+	};
+	// A jittered pile in the walled pen, large enough to be one colored island,
+	// with a few spinning and sweep_slide balls mixed in.
+	int n = 0;
+	for (int k = 0; k < 4; ++k) {
+		for (int i = 0; i < 6; ++i) {
+			for (int j = 0; j < 6; ++j, ++n) {
+				const T x = tr::from_milli(-3000 + 1000 * i + (n * 37) % 90);
+				const T y = tr::from_milli(-3000 + 1000 * j + (n * 53) % 90);
+				const T z = tr::from_milli(600 + 1100 * k);
+				add_ball(x, y, z, n % 7 == 3, n % 11 == 5);
+			}
+		}
+	}
+	// Two balls on a spring keep the constrained (serial) Pass A path busy.
+	auto a = add_ball(-tr::from_int(2), T {}, tr::from_int(8), false, false);
+	auto b = add_ball(tr::from_int(2), T {}, tr::from_int(8), false, false);
+	auto c = std::make_shared<constraint<T>>(a, b);
+	c->set_type(constraint<T>::type::spring);
+	c->set_rest_length(tr::from_int(2));
+	c->set_spring_constant(tr::from_int(4));
+	sim->add_constraint(c);
+	// A row on the floor outside the pen falls asleep (into bvh_manager's
+	// sleeping tree) until a ball dropped on it mid-run wakes it.
+	for (int i = 0; i < 5; ++i)
+		add_ball(tr::from_int(7), tr::from_int(i - 2), tr::half(), false, false);
+
+	state_hash h;
+	for (int t = 0; t < ticks; ++t) {
+		if (t == ticks / 2) {
+			add_ball(T {}, T {}, tr::from_int(9), false, false);  // wake the pile mid-run
+			add_ball(tr::from_int(7), T {}, tr::from_int(3), false, false);  // and the row
+		}
+		sim->update(tr::from_milli(16));
+		h.integer(sim->count_active_solids());
+		h.integer(sim->get_contact_count());
+		h.integer(sim->get_island_count());
+		for (int i = 0; i < sim->get_island_count(); ++i) {
+			if (sim->get_island(i).num_colors > 0) {
+				++colored_ticks;
+				break;
+			}
+		}
+	}
+	for (auto & s : bodies) {
+		h.vec(s->get_position());
+		h.vec(s->get_velocity());
+		h.vec(s->get_angular_velocity());
+		const auto & q = s->get_orientation_quat();
+		h.scalar(q.x);
+		h.scalar(q.y);
+		h.scalar(q.z);
+		h.scalar(q.w);
+		h.integer(s->active());
+	}
+	h.integer(static_cast<long long>(events.h));
+	return h.h;
+}
+
+// The pool itself: every index runs exactly once per call, over many calls in a
+// row (the per-tick pattern), a nested call runs inline, and an exception
+// thrown by a task reaches the caller.
+static void test_thread_pool() {
+	printf("  thread_pool: ");
+	thread_pool pool(4);
+	assert(pool.get_thread_count() == 4);
+	std::vector<std::atomic<int>> hits(64);
+	std::vector<int> expected(64, 0);
+	for (int round = 0; round < 2000; ++round) {
+		const int count = 1 + round % 37;
+		pool.parallel_for(count, [&](int i) { hits[i].fetch_add(1, std::memory_order_relaxed); });
+		for (int i = 0; i < count; ++i)
+			expected[i]++;
+	}
+	for (int i = 0; i < 64; ++i)
+		assert(hits[i].load() == expected[i]);
+
+	std::atomic<int> inner { 0 };
+	pool.parallel_for(8, [&](int) {
+		pool.parallel_for(8, [&](int) { inner.fetch_add(1); });
+	});
+	assert(inner.load() == 64);
+
+	// A throwing task reaches the caller once the job is over, and the pool
+	// takes the next job as usual.
+	bool caught = false;
+	try {
+		pool.parallel_for(64, [&](int i) {
+			if (i == 5)
+				throw std::runtime_error("task");
+		});
+	} catch (const std::runtime_error &) {
+		caught = true;
+	}
+	assert(caught);
+	std::atomic<int> after { 0 };
+	pool.parallel_for(16, [&](int) { after.fetch_add(1); });
+	assert(after.load() == 16);
+	printf("OK\n");
+}
+
+// Runs the scene at every thread count, each run on a fresh manager from
+// make(), and returns the hash they all share.
+template <typename T, typename Make>
+static std::uint64_t run_thread_counts(Make make, int ticks, int & colored_ticks) {
+	auto first = make();
+	const std::uint64_t reference = run_scene<T>(first.get(), 1, ticks, colored_ticks);
+	for (int threads : { 2, 3, 8, 32 }) {
+		int unused = 0;
+		auto mgr = make();
+		assert(run_scene<T>(mgr.get(), threads, ticks, unused) == reference);
+	}
+	// The built-in pool runs at most one thread per core; an explicit pool runs
+	// the parts on real workers whatever the machine, as would a host scheduler.
+	thread_pool pool(4);
+	for (int threads : { 3, 8 }) {
+		int unused = 0;
+		auto mgr = make();
+		assert(run_scene<T>(mgr.get(), threads, ticks, unused, &pool) == reference);
+	}
+	return reference;
+}
+
+template <typename T> static void test_thread_counts(const char * label) {
+	printf("  determinism[%s]: ", label);
+	const int ticks = 160;
+	int colored_ticks = 0;
+	const std::uint64_t reference =
+	    run_thread_counts<T>([] { return std::unique_ptr<bvh_manager<T>>(); }, ticks, colored_ticks);
+	assert(colored_ticks > 0);  // the pile really took the colored solve
+	printf("colored_ticks=%d hash=%016" PRIx64 "\n", colored_ticks, reference);
+
+	// The managers hand the simulator candidates in their own order, so each
+	// has its own hash; what must hold is that it does not move with threads.
+	int unused = 0;
+	run_thread_counts<T>(
+	    [] {
+		    // find_solids_near through the pair pass, plus the sleeping tree
+		    // and the fixed-tick async rebuild.
+		    auto mgr = std::make_unique<bvh_manager<T>>();
+		    mgr->set_pair_pass(true);
+		    mgr->set_sleeping_tree(true);
+		    mgr->set_async_rebuild(true);
+		    return mgr;
+	    },
+	    ticks, unused);
+	run_thread_counts<T>([] { return std::make_unique<sap_manager<T>>(); }, ticks, unused);  // partner lists
+	run_thread_counts<T>([] { return std::make_unique<grid_manager<T>>(); }, ticks, unused);
+	printf("  determinism[%s]: OK\n", label);
+}
+
+int main() {
+	printf("test_determinism:\n");
+	test_thread_pool();
+	test_thread_counts<fixed16>("fixed16");
+	test_thread_counts<fixed32>("fixed32");
+	test_thread_counts<float>("float");
+	printf("ALL PASSED\n");
+	return 0;
+}
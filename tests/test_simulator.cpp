@@ -2,9 +2,33 @@
 #include <cmath>
 #include <cstdio>
 #include <hop/hop.h>
+#include <thread>
 
 using namespace hop;
 
+// Shared fixtures, not added to any simulator. make_floor is an immovable
+// slab 40 wide whose top face is z = 0; make_ball a unit-mass ball of radius
+// 0.5.
+template <typename T> static std::shared_ptr<solid<T>> make_floor() {
+	using tr = scalar_traits<T>;
+	auto floor = std::make_shared<solid<T>>();
+	floor->set_infinite_mass();
+	floor->set_coefficient_of_gravity(T {});
+	floor->add_shape(std::make_shared<shape<T>>(
+	    aa_box<T>(vec3<T>(-tr::from_int(20), -tr::from_int(20), -tr::one()), vec3<T>(tr::from_int(20), tr::from_int(20), T {}))));
+	return floor;
+}
+
+template <typename T>
+static std::shared_ptr<solid<T>> make_ball(const vec3<T> & position, T restitution = scalar_traits<T>::half()) {
+	auto b = std::make_shared<solid<T>>();
+	b->set_mass(scalar_traits<T>::one());
+	b->set_position(position);
+	b->set_coefficient_of_restitution(restitution);
+	b->add_shape(std::make_shared<shape<T>>(hop::sphere<T> { vec3<T> {}, scalar_traits<T>::half() }));
+	return b;
+}
+
 template <typename T> static void test_gravity_drop() {
 	using tr = scalar_traits<T>;
 
@@ -1027,6 +1051,327 @@ template <typename T> static void test_angular_substep_ccd(const char * label) {
 	printf("OK\n");
 }
 
+// Split (parallel) Pass A: with set_parallel_pass_a the speculative bodies
+// integrate, then discover against the integrated state, with every effect on
+// another body deferred and merged in iteration order — so the thread count must
+// not change the result by a single bit. The scene mixes in what the split pass
+// must keep serial (a sweep_slide body and a constrained pair) and a collision
+// callback, whose events come from the per-thread buffers. Enough balls to put
+// the bvh_manager's dynamic tree in play.
+template <typename T> static void test_parallel_pass_a(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  parallel_pass_a[%s]: ", label);
+
+	struct outcome {
+		std::vector<vec3<T>> positions;
+		std::vector<vec3<T>> velocities;
+		int events = 0;
+	};
+	auto run = [&](int threads) {
+		outcome out;
+		bvh_manager<T> mgr;
+		auto sim = std::make_shared<simulator<T>>();
+		sim->set_gravity({ T {}, T {}, -tr::from_milli(9810) });
+		sim->set_default_contact_mode(contact_mode::speculative);
+		sim->set_manager(&mgr);
+		sim->set_parallel_pass_a(true);
+		sim->set_thread_count(threads);
+
+		auto floor = make_floor<T>();
+		sim->add_solid(floor);
+		mgr.add_solid(floor.get(), true);
+
+		std::vector<std::shared_ptr<solid<T>>> bodies;
+		for (int i = 0; i < 40; ++i) {
+			// A loose 4x5 footprint two layers deep, jittered so the balls collide
+			// with one another on the way down, not only with the floor.
+			auto b = make_ball<T>({ tr::from_milli(1100 * (i % 4) + 37 * (i % 3)), tr::from_milli(1100 * ((i / 4) % 5)),
+			                        tr::from_milli(1500 + 1900 * (i / 20) + 113 * (i % 7)) });
+			b->set_collision_callback([&out](const collision<T> &) { out.events++; });
+			sim->add_solid(b);
+			mgr.add_solid(b.get(), false);
+			bodies.push_back(b);
+		}
+		bodies[5]->set_contact_mode(contact_mode::sweep_slide);
+		auto c = std::make_shared<constraint<T>>(bodies[10], bodies[11]);
+		c->set_type(constraint<T>::type::spring);
+		c->set_rest_length(tr::one());
+		c->set_spring_constant(tr::from_int(20));
+		sim->add_constraint(c);
+
+		for (int i = 0; i < 150; ++i)
+			sim->update(tr::from_milli(16));
+		for (auto & b : bodies) {
+			out.positions.push_back(b->get_position());
+			out.velocities.push_back(b->get_velocity());
+		}
+		return out;
+	};
+
+	outcome one_thread = run(1);
+	outcome four_threads = run(4);
+	bool identical = one_thread.events == four_threads.events;
+	for (size_t i = 0; i < one_thread.positions.size(); ++i) {
+		identical = identical && one_thread.positions[i] == four_threads.positions[i];
+		identical = identical && one_thread.velocities[i] == four_threads.velocities[i];
+	}
+	float lowest = 1e9f, highest = -1e9f;
+	for (auto & p : one_thread.positions) {
+		float z = tr::to_float(p.z);
+		if (z < lowest) lowest = z;
+		if (z > highest) highest = z;
+	}
+	printf("events=%d z=[%.3f, %.3f] identical=%d\n", one_thread.events, lowest, highest, identical ? 1 : 0);
+	assert(identical);                 // thread count never changes the result
+	assert(one_thread.events > 0);     // the deferred callback records arrive
+	assert(lowest > 0.3f);             // nothing fell through the floor
+	assert(highest < 3.0f);            // ... and the pile came to rest on it
+	printf("  parallel_pass_a[%s]: OK\n", label);
+}
+
+// Islands: two piles on one floor are two islands — the infinite-mass floor
+// breaks the graph rather than joining it — and a constraint between them merges
+// them into one. The island solve runs across threads when set_thread_count is
+// above 1, and must give the same bits as the serial solve.
+template <typename T> static void test_islands(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  islands[%s]: ", label);
+
+	struct outcome {
+		int islands = 0;
+		int largest = 0;
+		int contacts = 0;
+		std::vector<vec3<T>> positions;
+	};
+	auto run = [&](int threads, bool link) {
+		outcome out;
+		auto sim = std::make_shared<simulator<T>>();
+		sim->set_gravity({ T {}, T {}, -tr::from_milli(9810) });
+		sim->set_default_contact_mode(contact_mode::speculative);
+		sim->set_thread_count(threads);
+
+		auto floor = make_floor<T>();
+		sim->add_solid(floor);
+
+		// Two columns of three balls, far enough apart never to touch.
+		std::vector<std::shared_ptr<solid<T>>> bodies;
+		for (int pile = 0; pile < 2; ++pile) {
+			for (int k = 0; k < 3; ++k) {
+				auto b = make_ball<T>({ tr::from_int(-5 + 10 * pile), T {}, tr::from_milli(500 + 1010 * k) });
+				sim->add_solid(b);
+				bodies.push_back(b);
+			}
+		}
+		if (link) {
+			auto c = std::make_shared<constraint<T>>(bodies[2], bodies[5]);
+			c->set_type(constraint<T>::type::spring);
+			c->set_rest_length(tr::from_int(10));
+			c->set_spring_constant(tr::one());
+			sim->add_constraint(c);
+		}
+
+		for (int i = 0; i < 30; ++i)
+			sim->update(tr::from_milli(16));
+		out.islands = sim->get_island_count();
+		out.contacts = sim->get_contact_count();
+		for (int i = 0; i < out.islands; ++i) {
+			const auto & isl = sim->get_island(i);
+			if (isl.num_solids > out.largest)
+				out.largest = isl.num_solids;
+			// Every contact in an island's range joins its members (or a member and
+			// an immovable body), never a body from another island.
+			for (int k = isl.first_contact; k < isl.first_contact + isl.num_contacts; ++k) {
+				solid<T> * a;
+				solid<T> * b;
+				vec3<T> n;
+				T impulse;
+				sim->get_contact(k, a, b, n, impulse);
+				for (solid<T> * s : { a, b }) {
+					if (s == floor.get())
+						continue;
+					bool member = false;
+					for (int m = isl.first_solid; m < isl.first_solid + isl.num_solids; ++m)
+						member = member || sim->get_island_solid(m) == s;
+					assert(member);
+				}
+			}
+		}
+		for (auto & b : bodies)
+			out.positions.push_back(b->get_position());
+		return out;
+	};
+
+	outcome apart = run(1, false);
+	outcome apart_mt = run(4, false);
+	outcome linked = run(1, true);
+	printf("apart=%d (largest %d) linked=%d (largest %d) contacts=%d\n", apart.islands, apart.largest, linked.islands,
+	       linked.largest, apart.contacts);
+	assert(apart.islands == 2 && apart.largest == 3);
+	assert(linked.islands == 1 && linked.largest == 6);
+	assert(apart.contacts >= 6);  // each pile: floor-ball and two ball-ball contacts
+	for (size_t i = 0; i < apart.positions.size(); ++i)
+		assert(apart.positions[i] == apart_mt.positions[i]);
+	printf("  islands[%s]: OK\n", label);
+}
+
+// Island sleep: a stack sleeps as one unit once every ball in it is at rest, and
+// a ball landing on top wakes the whole stack, not just the ball it hits. A
+// separate ball on the same floor is its own island and sleeps and stays asleep
+// on its own.
+template <typename T> static void test_island_sleep(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  island_sleep[%s]: ", label);
+
+	auto sim = std::make_shared<simulator<T>>();
+	sim->set_gravity({ T {}, T {}, -tr::from_milli(9810) });
+	sim->set_default_contact_mode(hop::contact_mode::speculative);
+
+	auto floor_solid = make_floor<T>();
+	sim->add_solid(floor_solid);
+	floor_solid->deactivate();
+
+	auto add_ball = [&](T x, T z) {
+		auto b = make_ball<T>({ x, T {}, z }, T {});
+		sim->add_solid(b);
+		return b;
+	};
+	std::vector<std::shared_ptr<solid<T>>> stack;
+	for (int k = 0; k < 3; ++k)
+		stack.push_back(add_ball(T {}, tr::from_milli(501 + 1001 * k)));
+	auto loner = add_ball(tr::from_int(8), tr::from_milli(501));
+
+	// The stack's members always share one state: never some asleep, some awake.
+	auto stack_uniform = [&] {
+		for (auto & b : stack)
+			if (b->active() != stack[0]->active())
+				return false;
+		return true;
+	};
+	int slept_at = -1;
+	for (int i = 0; i < 600; ++i) {
+		sim->update(tr::from_milli(16));
+		assert(stack_uniform());
+		if (slept_at < 0 && !stack[0]->active())
+			slept_at = i;
+	}
+	assert(slept_at >= 0);
+	assert(!loner->active());
+
+	// Drop a ball onto the top of the sleeping stack.
+	stack.push_back(add_ball(T {}, tr::from_int(5)));
+	int woke_at = -1;
+	for (int i = 0; i < 120 && woke_at < 0; ++i) {
+		sim->update(tr::from_milli(16));
+		if (stack[0]->active())
+			woke_at = i;
+	}
+	assert(woke_at >= 0);    // the bottom ball woke, though only the top one was hit
+	assert(stack_uniform());
+	assert(!loner->active());  // another island: undisturbed
+
+	int reslept_at = -1;
+	for (int i = 0; i < 900; ++i) {
+		sim->update(tr::from_milli(16));
+		assert(stack_uniform());
+		if (reslept_at < 0 && !stack[0]->active())
+			reslept_at = i;
+	}
+	float top = tr::to_float(stack.back()->get_position().z);
+	printf("slept_at=%d woke_at=%d reslept_at=%d top_z=%.3f\n", slept_at, woke_at, reslept_at, top);
+	assert(reslept_at >= 0);
+	assert(top > 3.3f && top < 3.7f);  // resting on the stack, four balls high
+	printf("  island_sleep[%s]: OK\n", label);
+}
+
+// A solid can outlive its simulator. The sleep ring it fell asleep in may hold
+// pooled solids freed with the simulator, so dropping the simulator must leave
+// the survivor in no ring: waking it, here or in another simulator, reaches
+// nothing else.
+template <typename T> static void test_sleep_ring_outlives_simulator(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  sleep_ring_outlives_simulator[%s]: ", label);
+
+	auto keep = std::make_shared<solid<T>>();
+	keep->set_position({ T {}, T {}, tr::half() });
+	keep->add_shape(std::make_shared<shape<T>>(
+	    aa_box<T>(-tr::half(), -tr::half(), -tr::half(), tr::half(), tr::half(), tr::half())));
+	{
+		auto sim = std::make_shared<simulator<T>>();
+		sim->set_gravity({ T {}, T {}, -tr::from_milli(9810) });
+		sim->set_default_contact_mode(hop::contact_mode::speculative);
+
+		sim->add_solid(make_floor<T>());
+		sim->add_solid(keep);
+
+		solid<T> * top = sim->get_solid(sim->create_solid());
+		top->set_position({ T {}, T {}, tr::from_milli(1500) });
+		top->add_shape(std::make_shared<shape<T>>(
+		    aa_box<T>(-tr::half(), -tr::half(), -tr::half(), tr::half(), tr::half(), tr::half())));
+		for (int i = 0; i < 600 && keep->active(); ++i)
+			sim->update(tr::from_milli(16));
+		assert(!keep->active() && !top->active());
+	}
+	keep->set_velocity({ tr::one(), T {}, T {} });
+	assert(!keep->active());  // no simulator
+
+	simulator<T> sim2;
+	sim2.add_solid(keep);
+	assert(keep->active());
+	keep->deactivate();
+	keep->activate();
+	assert(sim2.count_active_solids() == 1);
+	// Nor does it carry contacts into the second simulator: they named solids
+	// of the first.
+	assert(keep->get_touch_count() == 0);
+	sim2.update(tr::from_milli(16));
+	sim2.remove_solid(keep);
+	assert(sim2.get_solids().empty());
+	printf("OK\n");
+}
+
+// A body woken after Pass A, with no contact solved in the tick it wakes, has
+// no position correction to commit. A ring-woken partner of a struck body must
+// end that tick exactly where it slept, not moved by the correction left over
+// from its last awake tick. A weak, single-iteration position pass keeps the
+// overlapping pair correcting right up to the tick it falls asleep.
+template <typename T> static void test_woken_body_commits_no_correction(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  woken_body_commits_no_correction[%s]: ", label);
+
+	auto sim = std::make_shared<simulator<T>>();
+	sim->set_gravity({ T {}, T {}, T {} });
+	sim->set_default_contact_mode(hop::contact_mode::speculative);
+	sim->set_position_baumgarte(tr::from_milli(10));
+	sim->set_position_iterations(1);
+
+	auto add_ball = [&](T x, T y) {
+		auto b = make_ball<T>({ x, y, T {} }, T {});
+		sim->add_solid(b);
+		return b;
+	};
+	auto partner = add_ball(T {}, T {});
+	auto struck = add_ball(tr::from_milli(900), T {});  // overlapping by 0.1
+	for (int i = 0; i < 600 && partner->active(); ++i)
+		sim->update(tr::from_milli(16));
+	assert(!partner->active() && !struck->active());
+
+	auto ball = add_ball(tr::from_milli(900), -tr::from_int(3));
+	ball->set_velocity({ T {}, tr::from_int(5), T {} });
+	int woke_at = -1;
+	for (int i = 0; i < 120 && woke_at < 0; ++i) {
+		const vec3<T> slept = partner->get_position();
+		sim->update(tr::from_milli(16));
+		if (partner->active()) {
+			woke_at = i;
+			assert(struck->active());
+			assert(partner->get_position() == slept);
+		}
+	}
+	assert(woke_at >= 0);
+	printf("woke_at=%d\n", woke_at);
+	printf("  woken_body_commits_no_correction[%s]: OK\n", label);
+}
+
 template <typename T> static void test_dual_instantiation() {
 	// Just verify both can be instantiated in the same TU
 	simulator<T> sim;
@@ -1037,6 +1382,668 @@ template <typename T> static void test_dual_instantiation() {
 	printf("  dual instantiation: OK\n");
 }
 
+template <typename T> static void test_awake_list(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  awake_list[%s]: ", label);
+
+	auto sim = std::make_shared<simulator<T>>();
+	sim->set_gravity({ T {}, T {}, -tr::from_milli(9810) });
+	sim->set_default_contact_mode(hop::contact_mode::speculative);
+
+	sim->add_solid(make_floor<T>());
+
+	std::vector<std::shared_ptr<solid<T>>> balls;
+	for (int k = 0; k < 6; ++k) {
+		auto b = make_ball<T>({ tr::from_int(3 * k - 8), T {}, tr::from_milli(501 + 500 * k) }, T {});
+		sim->add_solid(b);
+		balls.push_back(b);
+	}
+
+	// The list must agree with the bodies' own flags after every change.
+	auto count_awake = [&] {
+		int n = 0;
+		for (auto & s : sim->get_solids())
+			if (s->active())
+				n++;
+		return n;
+	};
+	assert(sim->count_active_solids() == count_awake());
+	int max_awake = 0;
+	int all_asleep_at = -1;
+	for (int i = 0; i < 600; ++i) {
+		sim->update(tr::from_milli(16));
+		const int n = sim->count_active_solids();
+		assert(n == count_awake());
+		max_awake = n > max_awake ? n : max_awake;
+		if (all_asleep_at < 0 && n == 0)
+			all_asleep_at = i;
+	}
+	assert(all_asleep_at >= 0);
+
+	// A sleeping body stays exactly where it is while others tick.
+	const vec3<T> rest = balls[0]->get_position();
+	balls[5]->set_velocity({ T {}, T {}, tr::one() });
+	assert(sim->count_active_solids() == 1);
+	for (int i = 0; i < 10; ++i) {
+		sim->update(tr::from_milli(16));
+		assert(sim->count_active_solids() == count_awake());
+	}
+	assert(balls[0]->get_position() == rest);
+
+	// Removing an awake body drops it from the list; re-adding puts it back.
+	balls[3]->activate();
+	const int before = sim->count_active_solids();
+	sim->remove_solid(balls[3]);
+	assert(sim->count_active_solids() == before - 1);
+	assert(sim->count_active_solids() == count_awake());
+	sim->add_solid(balls[3]);
+	assert(sim->count_active_solids() == before);
+	for (int i = 0; i < 600; ++i)
+		sim->update(tr::from_milli(16));
+	assert(sim->count_active_solids() == count_awake());
+
+	printf("max_awake=%d all_asleep_at=%d\n", max_awake, all_asleep_at);
+	printf("  awake_list[%s]: OK\n", label);
+}
+
+template <typename T> static void test_solid_pool(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  solid_pool[%s]: ", label);
+
+	auto sim = std::make_shared<simulator<T>>();
+	sim->set_gravity({ T {}, T {}, -tr::from_milli(9810) });
+	sim->set_default_contact_mode(hop::contact_mode::speculative);
+
+	sim->add_solid(make_floor<T>());
+
+	auto spawn = [&](int k) {
+		pool_handle h = sim->create_solid();
+		solid<T> * b = sim->get_solid(h);
+		assert(b && b->get_touch_count() == 0);
+		b->set_position({ tr::from_int(k % 8 * 2 - 8), tr::from_int(k / 8 * 2 - 8), tr::from_int(2 + k % 3) });
+		b->add_shape(std::make_shared<shape<T>>(hop::sphere<T> { vec3<T> {}, tr::half() }));
+		return h;
+	};
+	std::vector<pool_handle> debris;
+	for (int k = 0; k < 64; ++k)
+		debris.push_back(spawn(k));
+	assert(sim->get_solids().size() == 65);
+	// A pooled solid works as a constraint end like any other.
+	auto c = std::make_shared<constraint<T>>(sim->get_solid_ptr(debris[0]), sim->get_solid_ptr(debris[1]));
+	sim->add_constraint(c);
+	for (int i = 0; i < 60; ++i)
+		sim->update(tr::from_milli(16));
+	sim->remove_constraint(c);
+	c->destroy();
+	// One left in place goes with the first body destroyed under it, rather than
+	// tying its surviving end to the constraint's end point.
+	auto left = std::make_shared<constraint<T>>(sim->get_solid_ptr(debris[1]), sim->get_solid_ptr(debris[0]));
+	sim->add_constraint(left);
+
+	// Despawn every other body mid-contact: its handle goes stale, and nothing
+	// left in the scene refers to it.
+	for (size_t k = 0; k < debris.size(); k += 2) {
+		solid<T> * dead = sim->get_solid(debris[k]);
+		sim->destroy_solid(debris[k]);
+		assert(!sim->get_solid(debris[k]));
+		for (auto & s : sim->get_solids()) {
+			assert(s.get() != dead);
+			for (int t = 0; t < s->get_touch_count(); ++t)
+				assert(s->get_touch(t).partner != dead);
+		}
+	}
+	assert(sim->get_solids().size() == 33);
+	assert(!left->is_active() && !left->get_start_solid() && !left->get_end_solid());
+	// reset refuses a solid still added: it keeps its shape and place in the scene.
+	solid<T> * live = sim->get_solid(debris[1]);
+	live->reset();
+	assert(live->get_shapes().size() == 1);
+	sim->destroy_solid(debris[0]);  // stale: a no-op
+	assert(sim->get_solids().size() == 33);
+
+	// Respawning reuses the freed slots under new generations: the stale handles
+	// stay stale even though their objects are live again.
+	for (int k = 0; k < 32; ++k) {
+		pool_handle h = spawn(k);
+		assert(h.index % 2 == 0);
+		assert(h != debris[h.index]);
+		assert(!sim->get_solid(debris[h.index]));
+	}
+	assert(sim->get_solids().size() == 65);
+	for (int i = 0; i < 120; ++i)
+		sim->update(tr::from_milli(16));
+	for (auto & s : sim->get_solids())
+		assert(s->get_position().z > -tr::half());
+
+	// Two boxes side by side fall asleep as one island, linked in a sleep ring.
+	// Recycling one's slot must hand out a solid with none of that state: it
+	// starts awake, stays awake through a tick, and waking it again reaches no
+	// ring its predecessor belonged to.
+	pool_handle pair[2];
+	for (int k = 0; k < 2; ++k) {
+		pair[k] = sim->create_solid();
+		solid<T> * b = sim->get_solid(pair[k]);
+		b->set_position({ tr::from_int(14 + k), tr::from_int(14), tr::half() });
+		b->add_shape(std::make_shared<shape<T>>(
+		    aa_box<T>(-tr::half(), -tr::half(), -tr::half(), tr::half(), tr::half(), tr::half())));
+	}
+	for (int i = 0; i < 600 && sim->get_solid(pair[0])->active(); ++i)
+		sim->update(tr::from_milli(16));
+	assert(!sim->get_solid(pair[0])->active() && !sim->get_solid(pair[1])->active());
+	sim->destroy_solid(pair[0]);
+	pool_handle fresh = sim->create_solid();
+	assert(fresh.index == pair[0].index);
+	solid<T> * b = sim->get_solid(fresh);
+	b->set_position({ -tr::from_int(14), tr::from_int(14), tr::from_int(3) });
+	b->add_shape(std::make_shared<shape<T>>(hop::sphere<T> { vec3<T> {}, tr::half() }));
+	assert(b->active());
+	sim->update(tr::from_milli(16));
+	assert(b->active());
+	const bool partner_awake = sim->get_solid(pair[1])->active();
+	b->deactivate();
+	b->activate();
+	assert(sim->get_solid(pair[1])->active() == partner_awake);
+	assert(sim->count_active_solids() <= static_cast<int>(sim->get_solids().size()));
+
+	printf("OK\n");
+}
+
+// Removal visits only the bodies that cache a contact with the dead one, so it
+// must still leave no cache anywhere pointing at it — in a pile where contacts
+// run in both directions, for a batch, a single remove, and a mid-callback remove.
+template <typename T> static void test_batch_remove(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  batch_remove[%s]: ", label);
+
+	bvh_manager<T> mgr;
+	auto sim = std::make_shared<simulator<T>>();
+	sim->set_gravity({ T {}, T {}, -tr::from_milli(9810) });
+	sim->set_default_contact_mode(contact_mode::speculative);
+	sim->set_manager(&mgr);
+
+	auto floor = make_floor<T>();
+	sim->add_solid(floor);
+	mgr.add_solid(floor.get(), true);
+
+	std::vector<std::shared_ptr<solid<T>>> bodies;
+	for (int i = 0; i < 48; ++i) {
+		auto b = make_ball<T>({ tr::from_milli(1000 * (i % 4) + 31 * (i % 5)), tr::from_milli(1000 * ((i / 4) % 4)),
+		                        tr::from_milli(600 + 1050 * (i / 16)) });
+		sim->add_solid(b);
+		mgr.add_solid(b.get(), false);
+		bodies.push_back(b);
+	}
+	for (int i = 0; i < 90; ++i)
+		sim->update(tr::from_milli(16));
+
+	auto check_gone = [&](const solid<T> * dead) {
+		for (auto & s : sim->get_solids()) {
+			assert(s.get() != dead);
+			for (int t = 0; t < s->get_touch_count(); ++t)
+				assert(s->get_touch(t).partner != dead);
+		}
+		solid<T> * found[64];
+		const int n = mgr.find_solids_in_aa_box(aa_box<T>(vec3<T>(-tr::from_int(30), -tr::from_int(30), -tr::from_int(30)),
+		                                                  vec3<T>(tr::from_int(30), tr::from_int(30), tr::from_int(30))),
+		                                        found, 64);
+		for (int k = 0; k < n; ++k)
+			assert(found[k] != dead);
+	};
+
+	// Every third body of the pile in one batch.
+	std::vector<solid<T> *> batch;
+	for (size_t i = 0; i < bodies.size(); i += 3)
+		batch.push_back(bodies[i].get());
+	int touching = 0;
+	for (auto * dead : batch)
+		touching += dead->get_touch_count();
+	assert(touching > 0);
+	sim->remove_solids(batch.data(), static_cast<int>(batch.size()));
+	mgr.remove_solids(batch.data(), static_cast<int>(batch.size()));
+	assert(sim->get_solids().size() == 1 + bodies.size() - batch.size());
+	assert(mgr.get_dynamic_count() == static_cast<int>(bodies.size() - batch.size()));
+	for (auto * dead : batch)
+		check_gone(dead);
+	sim->remove_solids(batch.data(), static_cast<int>(batch.size()));  // already gone: a no-op
+	assert(sim->get_solids().size() == 1 + bodies.size() - batch.size());
+
+	// The rest settle; the caches keep refreshing around the gaps.
+	for (int i = 0; i < 120; ++i)
+		sim->update(tr::from_milli(16));
+	sim->remove_solid(bodies[1]);
+	mgr.remove_solid(bodies[1].get());
+	check_gone(bodies[1].get());
+
+	// Removing a body from its own collision callback.
+	bool removed = false;
+	bodies[2]->activate();
+	bodies[2]->set_velocity({ T {}, T {}, -tr::one() });
+	bodies[2]->set_collision_callback([&](const collision<T> &) {
+		if (!removed) {
+			removed = true;
+			sim->remove_solid(bodies[2]);
+			mgr.remove_solid(bodies[2].get());
+		}
+	});
+	for (int i = 0; i < 30 && !removed; ++i)
+		sim->update(tr::from_milli(16));
+	assert(removed);
+	check_gone(bodies[2].get());
+	for (int i = 0; i < 60; ++i)
+		sim->update(tr::from_milli(16));
+	for (auto & s : sim->get_solids())
+		assert(s->get_position().z > -tr::half());
+
+	// Re-adding a removed body puts it back with a fresh cache.
+	sim->add_solid(bodies[0]);
+	mgr.add_solid(bodies[0].get(), false);
+	assert(bodies[0]->get_touch_count() == 0);
+	for (int i = 0; i < 60; ++i)
+		sim->update(tr::from_milli(16));
+	assert(sim->get_solids().size() == bodies.size() - batch.size());  // floor + rest - 2 removed + 1 back
+
+	// A batch cut out of a sleeping stack leaves the survivors in one ring:
+	// waking any of them wakes the rest.
+	std::vector<std::shared_ptr<solid<T>>> stack;
+	for (int k = 0; k < 6; ++k) {
+		auto b = std::make_shared<solid<T>>();
+		b->set_position({ T {}, tr::from_int(10), tr::from_milli(501 + 1001 * k) });
+		b->add_shape(std::make_shared<shape<T>>(
+		    aa_box<T>(-tr::half(), -tr::half(), -tr::half(), tr::half(), tr::half(), tr::half())));
+		sim->add_solid(b);
+		mgr.add_solid(b.get(), false);
+		stack.push_back(b);
+	}
+	for (int i = 0; i < 900 && stack[0]->active(); ++i)
+		sim->update(tr::from_milli(16));
+	for (auto & b : stack)
+		assert(!b->active());
+	std::vector<solid<T> *> cut;
+	for (size_t k = 0; k < stack.size(); k += 2)
+		cut.push_back(stack[k].get());
+	sim->remove_solids(cut.data(), static_cast<int>(cut.size()));
+	mgr.remove_solids(cut.data(), static_cast<int>(cut.size()));
+	stack.back()->activate();
+	for (size_t k = 1; k < stack.size(); k += 2)
+		assert(stack[k]->active());
+	for (auto * dead : cut)
+		check_gone(dead);
+
+	printf("OK\n");
+}
+
+// bvh_manager counting the broad-phase walks trace_segments asks of it.
+template <typename T> struct counted_bvh_manager : bvh_manager<T> {
+	int walks = 0;
+	bool for_each_solid_in_aa_box(const aa_box<T> & box, const std::function<bool(solid<T> *)> & fn,
+	                              int collide_with_bits = -1) override {
+		++walks;
+		return bvh_manager<T>::for_each_solid_in_aa_box(box, fn, collide_with_bits);
+	}
+};
+
+// trace_segments must report exactly what one trace_segment per segment does,
+// with no manager and with the bundled ones: a line-of-sight fan from one eye,
+// a volley of parallel shots, and scattered rays (some starting inside). With
+// bvh_manager the fan and the volley are served a group to a tree walk.
+template <typename T> static void test_trace_segments(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  trace_segments[%s]: ", label);
+
+	counted_bvh_manager<T> bvh;
+	sap_manager<T> sap;
+	grid_manager<T> grid;
+	grid.set_cell_size(tr::one());
+	manager<T> * managers[] = { nullptr, &bvh, &sap, &grid };
+	for (manager<T> * mgr : managers) {
+		auto sim = std::make_shared<simulator<T>>();
+		sim->set_manager(mgr);
+		auto add = [&](std::shared_ptr<solid<T>> s, bool is_static) {
+			sim->add_solid(s);
+			if (mgr == &bvh)
+				bvh.add_solid(s.get(), is_static);
+			else if (mgr == &sap)
+				sap.add_solid(s.get(), is_static);
+			else if (mgr == &grid)
+				grid.add_solid(s.get(), is_static);
+		};
+		add(make_floor<T>(), true);
+		for (int i = 0; i < 60; ++i) {
+			auto s = std::make_shared<solid<T>>();
+			s->set_position({ tr::from_milli(2300 * (i % 8) - 8000), tr::from_milli(2100 * (i / 8) - 8000), tr::from_milli(500 + 200 * (i % 3)) });
+			if (i % 2)
+				s->add_shape(std::make_shared<shape<T>>(hop::sphere<T> { vec3<T> {}, tr::half() }));
+			else
+				s->add_shape(std::make_shared<shape<T>>(aa_box<T>(vec3<T>(-tr::half(), -tr::half(), -tr::half()), vec3<T>(tr::half(), tr::half(), tr::half()))));
+			s->set_collision_scope(i % 5 == 0 ? 2 : 1);
+			if (i % 3 == 0)
+				s->set_infinite_mass();
+			add(s, i % 3 == 0);
+		}
+		// Two solids in the same place, so equal-time hits fold.
+		add(make_ball<T>({ -tr::from_int(8), -tr::from_int(8), tr::from_milli(500) }), false);
+		sim->update(tr::from_milli(16));
+		// A tree is refit at the start of a tick, and the twins have pushed apart
+		// since; bring it up to their bounds, or a single trace_segment misses
+		// what the batch's per-group filter, by current bounds, finds.
+		if (mgr)
+			mgr->pre_update(tr::from_milli(16));
+
+		std::vector<segment<T>> segs;
+		auto add_seg = [&](const vec3<T> & start, const vec3<T> & dir) {
+			segs.emplace_back();
+			segs.back().set_start_dir(start, dir);
+		};
+		const vec3<T> eye(T {}, T {}, tr::from_int(2));
+		for (int i = 0; i < 61; ++i) {
+			segs.emplace_back();
+			segs.back().set_start_end(eye, sim->get_solids()[i + 1]->get_position());
+		}
+		for (int i = 0; i < 40; ++i)
+			add_seg(vec3<T>(-tr::from_int(10), tr::from_milli(400 * i - 8000), tr::from_milli(600)), vec3<T>(tr::from_int(20), T {}, T {}));
+		for (int i = 0; i < 40; ++i)
+			add_seg(vec3<T>(tr::from_milli(737 * i % 16000 - 8000), tr::from_milli(1311 * i % 16000 - 8000), tr::from_milli(100 * (i % 9))),
+			        vec3<T>(tr::from_milli(450 * (i % 7) - 1300), tr::from_milli(300 * (i % 11) - 1500), -tr::from_milli(200 * (i % 4))));
+		add_seg(eye, vec3<T> {});
+
+		for (int bits : { -1, 1, 2 }) {
+			solid<T> * ignore = bits == 1 ? sim->get_solids()[3].get() : nullptr;
+			std::vector<collision<T>> batch(segs.size());
+			bvh.walks = 0;
+			sim->trace_segments(batch.data(), segs.data(), static_cast<int>(segs.size()), bits, ignore);
+			if (mgr == &bvh)
+				assert(bvh.walks > 0 && bvh.walks * 2 < static_cast<int>(segs.size()));
+			int hits = 0;
+			for (size_t i = 0; i < segs.size(); ++i) {
+				collision<T> one;
+				sim->trace_segment(one, segs[i], bits, ignore);
+				const collision<T> & b = batch[i];
+				assert(one.time == b.time && one.depth == b.depth && one.collider == b.collider &&
+				       one.trigger_scope == b.trigger_scope);
+				assert(one.point.x == b.point.x && one.point.y == b.point.y && one.point.z == b.point.z);
+				assert(one.normal.x == b.normal.x && one.normal.y == b.normal.y && one.normal.z == b.normal.z);
+				assert(sim->trace_segment_any(segs[i], bits, ignore) == (one.time < tr::one()));
+				hits += one.time < tr::one();
+			}
+			assert(hits > 40);
+		}
+	}
+
+	printf("OK\n");
+}
+
+// manager_floor whose plane also stops segment traces.
+template <typename T> class traced_floor : public manager_floor<T> {
+public:
+	void trace_segment(collision<T> & result, const segment<T> & seg, int) override {
+		using tr = scalar_traits<T>;
+		if (seg.origin.z < T {} || seg.direction.z >= T {})
+			return;
+		const T t = -seg.origin.z / seg.direction.z;
+		if (t <= tr::one() && t < result.time) {
+			result.time = t;
+			mul(result.point, seg.direction, t);
+			add(result.point, seg.origin);
+			result.normal = { T {}, T {}, tr::one() };
+		}
+	}
+};
+
+// trace_segment_any answers as trace_segment's result.time < one does, ignore
+// and scopes included, and leaves out the manager's geometry when asked to.
+template <typename T> static void test_trace_segment_any(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  trace_segment_any[%s]: ", label);
+
+	traced_floor<T> floor;
+	auto sim = std::make_shared<simulator<T>>();
+	sim->set_manager(&floor);
+	auto wall = std::make_shared<solid<T>>();
+	wall->set_infinite_mass();
+	wall->set_position({ tr::from_int(5), T {}, tr::from_int(2) });
+	wall->add_shape(std::make_shared<shape<T>>(aa_box<T>(vec3<T>(-tr::half(), -tr::from_int(2), -tr::one()), vec3<T>(tr::half(), tr::from_int(2), tr::one()))));
+	wall->set_collision_scope(2);
+	sim->add_solid(wall);
+	auto ball = std::make_shared<solid<T>>();
+	ball->set_position({ tr::from_int(5), tr::from_int(5), tr::from_int(2) });
+	ball->add_shape(std::make_shared<shape<T>>(hop::sphere<T> { vec3<T> {}, tr::one() }));
+	ball->set_collision_scope(1);
+	sim->add_solid(ball);
+	sim->update(tr::from_milli(16));
+
+	const vec3<T> eye(T {}, T {}, tr::from_int(2));
+	auto check = [&](const vec3<T> & to, int bits, solid<T> * ignore, bool expected) {
+		segment<T> seg;
+		seg.set_start_end(eye, to);
+		collision<T> one;
+		sim->trace_segment(one, seg, bits, ignore);
+		assert((one.time < tr::one()) == expected);
+		assert(sim->trace_segment_any(seg, bits, ignore) == expected);
+	};
+	const vec3<T> behind_wall(tr::from_int(10), T {}, tr::from_int(2));
+	check(behind_wall, -1, nullptr, true);
+	check(behind_wall, 1, nullptr, false);
+	check(behind_wall, 2, nullptr, true);
+	check(behind_wall, -1, wall.get(), false);
+	check(ball->get_position(), -1, nullptr, true);
+	check(ball->get_position(), 2, nullptr, false);
+	check({ T {}, tr::from_int(10), tr::from_int(2) }, -1, nullptr, false);
+
+	// Only the manager's floor lies across this one.
+	segment<T> down;
+	down.set_start_end(eye, { -tr::from_int(3), T {}, -tr::one() });
+	assert(sim->trace_segment_any(down));
+	assert(!sim->trace_segment_any(down, -1, nullptr, false));
+
+	printf("OK\n");
+}
+
+// The const, scratch-taking queries report what the others do, from several
+// threads at once, and see solids added since the last tick without touching
+// the manager.
+template <typename T> static void test_reentrant_queries(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  reentrant_queries[%s]: ", label);
+
+	auto same = [](const collision<T> & a, const collision<T> & b) {
+		return a.time == b.time && a.depth == b.depth && a.collider == b.collider && a.point.x == b.point.x &&
+		       a.point.y == b.point.y && a.point.z == b.point.z && a.normal.x == b.normal.x &&
+		       a.normal.y == b.normal.y && a.normal.z == b.normal.z;
+	};
+	for (int mode = 0; mode < 5; ++mode) {
+		bvh_manager<T> bvh;
+		bvh.set_incremental_dynamic(mode == 2);
+		sap_manager<T> sap;
+		grid_manager<T> grid;
+		grid.set_cell_size(tr::one());
+		manager<T> * managers[] = { nullptr, &bvh, &bvh, &sap, &grid };
+		manager<T> * mgr = managers[mode];
+		auto sim = std::make_shared<simulator<T>>();
+		sim->set_gravity({ T {}, T {}, -tr::from_milli(9810) });
+		sim->set_manager(mgr);
+		auto add = [&](std::shared_ptr<solid<T>> s, bool is_static) {
+			sim->add_solid(s);
+			if (mgr == &bvh)
+				bvh.add_solid(s.get(), is_static);
+			else if (mgr == &sap)
+				sap.add_solid(s.get(), is_static);
+			else if (mgr == &grid)
+				grid.add_solid(s.get(), is_static);
+		};
+		add(make_floor<T>(), true);
+		for (int i = 0; i < 60; ++i) {
+			auto s = std::make_shared<solid<T>>();
+			s->set_position({ tr::from_milli(2300 * (i % 8) - 8000), tr::from_milli(2100 * (i / 8) - 8000), tr::from_milli(600 + 300 * (i % 3)) });
+			s->set_velocity({ tr::from_milli(300 * (i % 5) - 600), T {}, T {} });
+			if (i % 2)
+				s->add_shape(std::make_shared<shape<T>>(hop::sphere<T> { vec3<T> {}, tr::half() }));
+			else
+				s->add_shape(std::make_shared<shape<T>>(aa_box<T>(vec3<T>(-tr::half(), -tr::half(), -tr::half()), vec3<T>(tr::half(), tr::half(), tr::half()))));
+			s->set_collision_scope(i % 5 == 0 ? 2 : 1);
+			if (i % 3 == 0)
+				s->set_infinite_mass();
+			add(s, i % 3 == 0);
+		}
+		for (int i = 0; i < 5; ++i)
+			sim->update(tr::from_milli(16));
+
+		std::vector<segment<T>> segs(64);
+		for (int i = 0; i < 64; ++i)
+			segs[i].set_start_end({ tr::from_milli(250 * i - 8000), -tr::from_int(9), tr::from_milli(700) },
+			                      { tr::from_milli(8000 - 250 * i), tr::from_int(9), tr::from_milli(500 + 20 * i) });
+		solid<T> * mover = sim->get_solids()[2].get();
+		std::vector<collision<T>> expected(segs.size() * 2);
+		std::vector<collision<T>> expected_scoped(segs.size() * 2);  // collide_with_bits 1
+		std::vector<char> expected_any(segs.size());
+		for (size_t i = 0; i < segs.size(); ++i) {
+			sim->trace_segment(expected[2 * i], segs[i], -1);
+			sim->trace_solid(expected[2 * i + 1], mover, segs[i]);
+			sim->trace_segment(expected_scoped[2 * i], segs[i], 1);
+			sim->trace_solid(expected_scoped[2 * i + 1], mover, segs[i], 1);
+			expected_any[i] = sim->trace_segment_any(segs[i], 1);
+		}
+		int hits = 0;
+		for (size_t i = 0; i < segs.size(); ++i)
+			hits += expected[2 * i].time < tr::one();
+		assert(hits > 10);
+
+		// Four threads, each with its own scratch, racing over every query.
+		bool ok[4] = {};
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t) {
+			threads.emplace_back([&, t] {
+				typename simulator<T>::query_scratch scratch;
+				const simulator<T> & reader = *sim;
+				bool all = true;
+				for (int round = 0; round < 4; ++round) {
+					for (size_t k = 0; k < segs.size(); ++k) {
+						const size_t i = (k + t * 16) % segs.size();
+						collision<T> c;
+						reader.trace_segment(c, segs[i], scratch, -1);
+						all = all && same(c, expected[2 * i]);
+						reader.trace_solid(c, mover, segs[i], scratch);
+						all = all && same(c, expected[2 * i + 1]);
+						reader.trace_segment(c, segs[i], scratch, 1);
+						all = all && same(c, expected_scoped[2 * i]);
+						reader.trace_solid(c, mover, segs[i], scratch, 1);
+						all = all && same(c, expected_scoped[2 * i + 1]);
+						all = all && reader.trace_segment_any(segs[i], scratch, 1) == (expected_any[i] != 0);
+					}
+				}
+				ok[t] = all;
+			});
+		}
+		for (auto & th : threads)
+			th.join();
+		for (bool b : ok)
+			assert(b);
+
+		// A solid added since the tick: found, although its tree is stale.
+		auto late = make_ball<T>({ tr::from_int(15), tr::from_int(15), tr::from_int(3) });
+		add(late, mode == 1);
+		solid<T> * found[128];
+		const aa_box<T> around(vec3<T>(tr::from_int(14), tr::from_int(14), tr::from_int(2)), vec3<T>(tr::from_int(16), tr::from_int(16), tr::from_int(4)));
+		const int n = sim->query_solids_in_aa_box(around, found, 128);
+		assert(n == 1 && found[0] == late.get());
+		typename simulator<T>::query_scratch scratch;
+		segment<T> down;
+		down.set_start_end({ tr::from_int(15), tr::from_int(15), tr::from_int(5) }, { tr::from_int(15), tr::from_int(15), tr::from_int(2) });
+		collision<T> c;
+		static_cast<const simulator<T> &>(*sim).trace_segment(c, down, scratch);
+		assert(c.collider == late.get());
+	}
+
+	printf("OK\n");
+}
+
+template <typename T> static void test_colored_solve(const char * label) {
+	using tr = scalar_traits<T>;
+	printf("  colored_solve[%s]: ", label);
+
+	struct outcome {
+		int colors = 0;
+		int colored_contacts = 0;
+		std::vector<vec3<T>> positions;
+	};
+	auto run = [&](int threads, bool colored) {
+		outcome out;
+		auto sim = std::make_shared<simulator<T>>();
+		sim->set_gravity({ T {}, T {}, -tr::from_milli(9810) });
+		sim->set_default_contact_mode(contact_mode::speculative);
+		sim->set_thread_count(threads);
+		sim->set_colored_solve(colored);
+
+		auto floor = make_floor<T>();
+		sim->add_solid(floor);
+
+		// One pile: a 10x10 layer of touching balls with a 9x9 layer nested on top,
+		// so every ball is connected to every other through contacts.
+		std::vector<std::shared_ptr<solid<T>>> bodies;
+		auto add_ball = [&](T x, T y, T z) {
+			auto b = make_ball<T>({ x, y, z }, T {});
+			sim->add_solid(b);
+			bodies.push_back(b);
+		};
+		for (int i = 0; i < 10; ++i)
+			for (int j = 0; j < 10; ++j)
+				add_ball(tr::from_int(i - 5), tr::from_int(j - 5), tr::from_milli(500));
+		for (int i = 0; i < 9; ++i)
+			for (int j = 0; j < 9; ++j)
+				add_ball(tr::from_milli(500 + 1000 * (i - 5)), tr::from_milli(500 + 1000 * (j - 5)), tr::from_milli(1210));
+
+		// Check the coloring every tick while the pile settles.
+		for (int tick = 0; tick < 60; ++tick) {
+			sim->update(tr::from_milli(16));
+			for (int i = 0; i < sim->get_island_count(); ++i) {
+				const auto & isl = sim->get_island(i);
+				if (isl.num_colors == 0)
+					continue;
+				out.colors += isl.num_colors;
+				out.colored_contacts += isl.num_contacts;
+				// No two contacts of one color share a movable body.
+				for (int c = 0; c < isl.num_colors; ++c) {
+					std::vector<solid<T> *> seen;
+					for (int k = sim->get_color_first(isl, c); k < sim->get_color_first(isl, c + 1); ++k) {
+						solid<T> * a;
+						solid<T> * b;
+						vec3<T> n;
+						T impulse;
+						sim->get_contact(k, a, b, n, impulse);
+						for (solid<T> * s : { a, b }) {
+							if (s == floor.get())
+								continue;
+							assert(std::find(seen.begin(), seen.end(), s) == seen.end());
+							seen.push_back(s);
+						}
+					}
+				}
+			}
+		}
+		for (auto & b : bodies)
+			out.positions.push_back(b->get_position());
+		return out;
+	};
+
+	outcome plain = run(1, false);
+	assert(plain.colors == 0);
+	outcome one = run(1, true);
+	outcome four = run(4, true);
+	assert(one.colors > 0 && one.colored_contacts >= simulator<T>::colored_solve_min_contacts);
+	assert(one.positions == four.positions);  // the thread count does not change results
+
+	// A different (equally valid) visit order: the pile settles to the same shape.
+	float worst = 0.f;
+	for (size_t i = 0; i < plain.positions.size(); ++i) {
+		vec3<T> d;
+		sub(d, one.positions[i], plain.positions[i]);
+		const float e = tr::to_float(length(d));
+		worst = e > worst ? e : worst;
+	}
+	printf("colors=%d contacts=%d worst_drift=%.4f\n", one.colors, one.colored_contacts, worst);
+	assert(worst < 0.05f);
+	printf("  colored_solve[%s]: OK\n", label);
+}
+
 int main() {
 	printf("test_simulator (float):\n");
 	test_gravity_drop<float>();
@@ -1058,6 +2065,18 @@ int main() {
 	test_constraint_anchor_torque<float>("float");
 	test_fast_spinner_no_tunnel<float>("float");
 	test_angular_substep_ccd<float>("float");
+	test_parallel_pass_a<float>("float");
+	test_islands<float>("float");
+	test_island_sleep<float>("float");
+	test_sleep_ring_outlives_simulator<float>("float");
+	test_woken_body_commits_no_correction<float>("float");
+	test_awake_list<float>("float");
+	test_colored_solve<float>("float");
+	test_solid_pool<float>("float");
+	test_batch_remove<float>("float");
+	test_trace_segments<float>("float");
+	test_trace_segment_any<float>("float");
+	test_reentrant_queries<float>("float");
 	test_dual_instantiation<float>();
 
 	printf("test_simulator (fixed16):\n");
@@ -1099,6 +2118,18 @@ int main() {
 	test_constraint_anchor_torque<fixed16>("fixed16");
 	test_fast_spinner_no_tunnel<fixed16>("fixed16");
 	test_angular_substep_ccd<fixed16>("fixed16");
+	test_parallel_pass_a<fixed16>("fixed16");
+	test_islands<fixed16>("fixed16");
+	test_island_sleep<fixed16>("fixed16");
+	test_sleep_ring_outlives_simulator<fixed16>("fixed16");
+	test_woken_body_commits_no_correction<fixed16>("fixed16");
+	test_awake_list<fixed16>("fixed16");
+	test_colored_solve<fixed16>("fixed16");
+	test_solid_pool<fixed16>("fixed16");
+	test_batch_remove<fixed16>("fixed16");
+	test_trace_segments<fixed16>("fixed16");
+	test_trace_segment_any<fixed16>("fixed16");
+	test_reentrant_queries<fixed16>("fixed16");
 
 	printf("ALL PASSED\n");
 	return 0;